@@ -1,9 +1,12 @@
 #include "AppLayer.h"
 #include <GLFW/glfw3.h>
 #include <engine/Application.h>
+#include <engine/FlightRecorder.h>
 #include <engine/Input.h>
 #include <engine/Log.h>
+#include <engine/Profiler.h>
 #include <engine/ecs/Components.h>
+#include <engine/ecs/RenderSystem.h>
 #include <gtc/type_ptr.hpp>
 #include <imgui.h>
 
@@ -24,11 +27,14 @@ void AppLayer::OnAttach() {
     AddDirectionalLight();
 
     // Create original entities
-    CreateCubeEntity("Cube", {0.0f, -2.0f, 0.0f}, {50.0f, 1.0f, 50.0f});
+    CreateCubeEntity("Cube", {0.0f, -2.0f, 0.0f}, {50.0f, 1.0f, 50.0f}, true);
     CreateCubeEntity("Rotating Cube", {3.0f, 0.0f, -2.0f});
     CreateSphereEntity("Sphere", {-3.0f, 0.0f, -2.0f});
     CreateCapsuleEntity("Capsule", {0.0f, 2.5f, -2.0f});
 
+    AddPointLight({-2.0f, 0.5f, 0.0f}, {1.0f, 0.3f, 0.2f});
+    AddPointLight({2.0f, 0.5f, 0.0f}, {0.2f, 0.4f, 1.0f});
+
     SE_LOG_INFO("Scene setup complete with {} entities", scene_->GetEntityCount());
 
     auto& app = se::Application::Get();
@@ -48,11 +54,17 @@ void AppLayer::LoadMaterial() {
     fs::path fragment_shader_location = assets_folder.value() / "shaders" / "basic.frag";
     fs::path vertex_shader_location = assets_folder.value() / "shaders" / "basic.vert";
 
-    std::shared_ptr<se::Shader> shader = se::MaterialManager::GetShader(
+    se::ShaderHandle shader = se::MaterialManager::GetShader(
         "DefaultShader", vertex_shader_location, fragment_shader_location);
 
     material_ = se::MaterialManager::CreateMaterial(shader);
-    material_->SetFloat("uSpecularStrength", 0.5f);
+    se::MaterialManager::Get(material_)->SetFloat("uSpecularStrength", 0.5f);
+
+    transparentMaterial_ = se::MaterialManager::CreateMaterial(shader);
+    se::Material* transparent = se::MaterialManager::Get(transparentMaterial_);
+    transparent->SetFloat("uSpecularStrength", 0.5f);
+    transparent->SetFloat("uTransparency", 0.5f);
+    transparent->SetBlendMode(se::BlendMode::AlphaBlend);
 }
 
 void AppLayer::OnDetach() {
@@ -69,6 +81,7 @@ void AppLayer::OnUpdate(float ts) {
 
     // Update scene systems
     scene_->OnUpdate(ts);
+    se::FlightRecorder::SetCounter("Entities", static_cast<double>(scene_->GetEntityCount()));
 
     // Update entity transforms
     auto view = scene_->GetAllEntitiesWith<se::TransformComponent, se::NameComponent>();
@@ -142,19 +155,36 @@ void AppLayer::OnImGuiRender() {
                 ImGui::Text("ID: %u", static_cast<uint32_t>(entity));
 
                 // Transform controls
-                ImGui::DragFloat3("Position", glm::value_ptr(transform.Position), 0.1f);
-                ImGui::DragFloat3("Rotation", glm::value_ptr(transform.Rotation), 1.0f);
-                ImGui::DragFloat3("Scale", glm::value_ptr(transform.Scale), 0.1f);
+                bool edited =
+                    ImGui::DragFloat3("Position", glm::value_ptr(transform.Position), 0.1f);
+                edited |= ImGui::DragFloat3("Rotation", glm::value_ptr(transform.Rotation), 1.0f);
+                edited |= ImGui::DragFloat3("Scale", glm::value_ptr(transform.Scale), 0.1f);
 
                 // Mesh render component controls
                 se::Entity ent(entity, scene_.get());
                 if (ent.HasComponent<se::MeshRenderComponent>()) {
                     auto& meshRender = ent.GetComponent<se::MeshRenderComponent>();
+                    const bool wasStatic = meshRender.IsStatic;
 
                     ImGui::Separator();
-                    ImGui::Checkbox("Visible", &meshRender.IsVisible);
-                    ImGui::Checkbox("Cast Shadows", &meshRender.CastShadows);
+                    edited |= ImGui::Checkbox("Visible", &meshRender.IsVisible);
+                    edited |= ImGui::Checkbox("Cast Shadows", &meshRender.CastShadows);
                     ImGui::Checkbox("Receive Shadows", &meshRender.ReceiveShadows);
+                    edited |= ImGui::Checkbox("Static", &meshRender.IsStatic);
+
+                    // Static shadows are cached, tell the scene when one changes
+                    if (edited && (wasStatic || meshRender.IsStatic))
+                        scene_->MarkStaticChanged();
+                }
+                if (ent.HasComponent<se::PointLightComponent>()) {
+                    auto& light = ent.GetComponent<se::PointLightComponent>();
+
+                    ImGui::Separator();
+                    ImGui::Text("Point Light");
+                    ImGui::Checkbox("Enabled##Point", &light.Enabled);
+                    ImGui::DragFloat("Intensity##Point", &light.Intensity, 0.05f, 0.0f, 50.0f);
+                    ImGui::DragFloat("Range", &light.Range, 0.1f, 0.1f, 100.0f);
+                    ImGui::ColorEdit3("Color##Point", glm::value_ptr(light.Color));
                 }
                 if (ent.HasComponent<se::DirectionalLightComponent>()) {
                     auto& light = ent.GetComponent<se::DirectionalLightComponent>();
@@ -180,8 +210,126 @@ void AppLayer::OnImGuiRender() {
     // Render stats
     auto stats = se::Application::Get().GetRenderer().GetStats();
     if (ImGui::CollapsingHeader("Render Stats")) {
-        ImGui::Text("Draw Calls: %u", stats.DrawCalls);
+        ImGui::Text("Draw Calls: %u (%u meshes via multi-draw)", stats.DrawCalls,
+                    stats.IndirectCommands);
+        ImGui::Text("Object Uploads: %u", stats.ObjectUploads);
+        ImGui::Text("Command Packets: %u", stats.CommandPackets);
         ImGui::Text("Triangles: %u", stats.TriangleCount);
+        ImGui::Text("Shadow Draw Calls: %u", stats.ShadowDrawCalls);
+        ImGui::Text("Static Shadow Rebuilds: %u", stats.StaticShadowRebuilds);
+        ImGui::Text("Local Lights: %u (%u cluster assignments)", stats.LocalLights,
+                    stats.LightClusterAssignments);
+        ImGui::Text("Overdraw: %.2f (pre-pass %s, %u draws)", stats.Overdraw,
+                    stats.DepthPrepassActive ? "on" : "off", stats.DepthPrepassDrawCalls);
+        ImGui::Text("Render Passes: %u (%u culled), %u transient targets in %u textures",
+                    stats.RenderGraph.Passes, stats.RenderGraph.CulledPasses,
+                    stats.RenderGraph.TransientTextures, stats.RenderGraph.PooledTextures);
+
+        const char* prepassModes[] = {"Off", "On", "Auto"};
+        int prepassMode = static_cast<int>(se::SceneRenderer::GetDepthPrepassMode());
+        if (ImGui::Combo("Depth Pre-pass", &prepassMode, prepassModes,
+                         IM_ARRAYSIZE(prepassModes))) {
+            se::SceneRenderer::SetDepthPrepassMode(static_cast<se::DepthPrepassMode>(prepassMode));
+        }
+
+        ImGui::Text("Culled Objects: %u (%s)", stats.CulledObjects,
+                    stats.GpuCullingActive ? "GPU" : "CPU");
+        auto culling = se::SceneRenderer::GetCullingSettings();
+        bool cullingChanged = ImGui::Checkbox("Frustum Culling", &culling.FrustumCulling);
+        cullingChanged |= ImGui::Checkbox("GPU Culling", &culling.GpuCulling);
+        cullingChanged |= ImGui::Checkbox("Validate GPU Culling", &culling.ValidateGpuCulling);
+        cullingChanged |= ImGui::Checkbox("Occlusion Queries", &culling.OcclusionQueries);
+        if (cullingChanged)
+            se::SceneRenderer::SetCullingSettings(culling);
+
+        ImGui::Text("Occlusion Queries: %u (%u conditional draws, %u results pending)",
+                    stats.OcclusionQueries, stats.ConditionalDraws,
+                    stats.OcclusionResultsPending);
+
+        const auto occlusion = se::RenderSystem::GetOcclusionStats();
+        ImGui::Text("Occluded: %u of %u (%u occluders, %u triangles)", occlusion.OccludedObjects,
+                    occlusion.TestedObjects, occlusion.Occluders, occlusion.OccluderTriangles);
+        bool occlusionCulling = se::RenderSystem::IsOcclusionCullingEnabled();
+        if (ImGui::Checkbox("Occlusion Culling", &occlusionCulling))
+            se::RenderSystem::SetOcclusionCulling(occlusionCulling);
+
+        const auto lod = se::RenderSystem::GetLodStats();
+        ImGui::Text("LOD Triangles: %u of %u (%u switches)", lod.Triangles,
+                    lod.FullDetailTriangles, lod.Switches);
+        float lodBias = se::RenderSystem::GetLodBias();
+        if (ImGui::SliderFloat("LOD Bias", &lodBias, -2.0f, 2.0f))
+            se::RenderSystem::SetLodBias(lodBias);
+    }
+
+    // Frame times and GPU passes live in the engine's performance panel
+    auto& performancePanel = se::Application::Get().GetPerformancePanel();
+    bool showPerformance = performancePanel.IsOpen();
+    if (ImGui::Checkbox("Performance Panel", &showPerformance))
+        performancePanel.SetOpen(showPerformance);
+
+    if (ImGui::CollapsingHeader("Flight Recorder")) {
+        auto recorder = se::FlightRecorder::GetSettings();
+        bool changed = ImGui::Checkbox("Dump Hitches", &recorder.Enabled);
+        changed |= ImGui::SliderFloat("Hitch Threshold (ms)", &recorder.HitchThresholdMs, 5.0f,
+                                      200.0f);
+        if (changed)
+            se::FlightRecorder::SetSettings(recorder);
+        if (ImGui::Button("Dump Last Frames"))
+            se::FlightRecorder::RequestDump();
+        ImGui::SameLine();
+        ImGui::Text("%u dumps in '%s'", se::FlightRecorder::GetDumpCount(),
+                    recorder.Directory.c_str());
+    }
+
+    // CPU zones, written as Chrome trace JSON for Perfetto
+    if (ImGui::CollapsingHeader("CPU Profiler")) {
+        if (!se::Profiler::IsCapturing()) {
+            if (ImGui::Button("Start Capture"))
+                se::Profiler::BeginCapture();
+        } else if (ImGui::Button("Stop and Save")) {
+            se::Profiler::EndCapture("cpu_trace.json");
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("cpu_trace.json");
+    }
+
+    ImGui::Separator();
+
+    // Shadow settings
+    if (ImGui::CollapsingHeader("Shadows")) {
+        auto shadowSettings = se::SceneRenderer::GetShadowSettings();
+        bool changed = false;
+
+        const char* filterModes[] = {"HW PCF (1 tap)", "PCF (4 taps)", "Poisson (8 taps)",
+                                     "Poisson (16 taps)"};
+        int filterMode = static_cast<int>(shadowSettings.FilterMode);
+        if (ImGui::Combo("Filter", &filterMode, filterModes, IM_ARRAYSIZE(filterModes))) {
+            shadowSettings.FilterMode = static_cast<se::ShadowFilterMode>(filterMode);
+            changed = true;
+        }
+
+        const char* resolutions[] = {"512", "1024", "2048", "4096"};
+        int resolutionIndex = 0;
+        while (resolutionIndex < 3 && (512u << resolutionIndex) < shadowSettings.Resolution) {
+            resolutionIndex++;
+        }
+        if (ImGui::Combo("Resolution", &resolutionIndex, resolutions,
+                         IM_ARRAYSIZE(resolutions))) {
+            shadowSettings.Resolution = 512u << resolutionIndex;
+            changed = true;
+        }
+
+        const char* depthFormats[] = {"Depth16", "Depth24", "Depth32F"};
+        int depthFormat = static_cast<int>(shadowSettings.DepthFormat);
+        if (ImGui::Combo("Depth Format", &depthFormat, depthFormats,
+                         IM_ARRAYSIZE(depthFormats))) {
+            shadowSettings.DepthFormat = static_cast<se::ShadowDepthFormat>(depthFormat);
+            changed = true;
+        }
+
+        if (changed) {
+            se::SceneRenderer::SetShadowSettings(shadowSettings);
+        }
     }
 
     ImGui::Separator();
@@ -204,10 +352,32 @@ void AppLayer::OnImGuiRender() {
             CreateSphereEntity("Sphere_" + std::to_string(sphereCount++), {x, y, -5.0f});
         }
 
+        ImGui::SameLine();
+
+        if (ImGui::Button("Add Transparent Sphere")) {
+            static int glassCount = 0;
+            float x = (rand() % 10 - 5) * 0.5f;
+            float y = (rand() % 10 - 5) * 0.5f;
+            CreateSphereEntity("Glass_" + std::to_string(glassCount++), {x, y, -3.0f},
+                               transparentMaterial_);
+        }
+
         if (ImGui::Button("Add DirectionalLight")) {
             AddDirectionalLight();
         }
 
+        ImGui::SameLine();
+
+        if (ImGui::Button("Add 100 Point Lights")) {
+            for (int i = 0; i < 100; ++i) {
+                float x = (rand() % 200 - 100) * 0.2f;
+                float z = (rand() % 200 - 100) * 0.2f;
+                glm::vec3 color = {(rand() % 100) / 100.0f, (rand() % 100) / 100.0f,
+                                   (rand() % 100) / 100.0f};
+                AddPointLight({x, -1.0f, z}, color);
+            }
+        }
+
         if (ImGui::Button("Clear Scene")) {
             scene_->Clear();
             SE_LOG_INFO("Scene cleared");
@@ -234,12 +404,12 @@ void AppLayer::HandleInput(float deltaTime) {
 // ==================== Entity Creation Helpers ====================
 
 void AppLayer::CreateCubeEntity(const std::string& name, const glm::vec3& position,
-                                const glm::vec3& scale) {
+                                const glm::vec3& scale, bool isStatic) {
     SE_LOG_INFO("Creating cube entity: {}", name);
 
     auto entity = scene_->CreateEntity(name);
 
-    auto mesh = se::MeshManager::GetPrimitive(se::PrimitiveMeshType::Cube);
+    se::MeshHandle mesh = se::MeshManager::GetPrimitive(se::PrimitiveMeshType::Cube);
 
     if (!mesh) {
         SE_LOG_ERROR("Failed to get cube mesh!");
@@ -247,7 +417,8 @@ void AppLayer::CreateCubeEntity(const std::string& name, const glm::vec3& positi
     }
 
     // Add mesh render component - Engine handles everything!
-    entity.AddComponent<se::MeshRenderComponent>(mesh, material_);
+    auto& meshRender = entity.AddComponent<se::MeshRenderComponent>(mesh, material_);
+    meshRender.IsStatic = isStatic;
 
     // Set position
     auto& transform = entity.GetComponent<se::TransformComponent>();
@@ -267,20 +438,34 @@ void AppLayer::AddDirectionalLight() {
     auto mesh = se::MeshManager::GetPrimitive(se::PrimitiveMeshType::Cube);
 
     auto& sunMesh = sunEntity.AddComponent<se::MeshRenderComponent>(mesh, material_);
+    sunMesh.IsStatic = true;
 
     auto& sunLight = sunEntity.AddComponent<se::DirectionalLightComponent>();
     sunLight.Color = {1.0f, 0.98f, 0.9f};
     sunLight.Intensity = 1.5f;
 }
 
-void AppLayer::CreateSphereEntity(const std::string& name, const glm::vec3& position) {
+void AppLayer::AddPointLight(const glm::vec3& position, const glm::vec3& color) {
+    static int pointLightCount = 0;
+    auto lightEntity = scene_->CreateEntity("Point Light " + std::to_string(pointLightCount++));
+    lightEntity.GetComponent<se::TransformComponent>().SetPosition(position);
+
+    auto& light = lightEntity.AddComponent<se::PointLightComponent>();
+    light.Color = color;
+    light.Intensity = 4.0f;
+    light.Range = 4.0f;
+}
+
+void AppLayer::CreateSphereEntity(const std::string& name, const glm::vec3& position,
+                                  se::MaterialHandle material) {
     SE_LOG_INFO("Creating sphere entity: {}", name);
 
     auto entity = scene_->CreateEntity(name);
 
     // Add mesh render component
     entity.AddComponent<se::MeshRenderComponent>(
-        se::MeshManager::GetPrimitive(se::PrimitiveMeshType::Sphere), material_);
+        se::MeshManager::GetPrimitive(se::PrimitiveMeshType::Sphere),
+        material ? material : material_);
 
     // Set position
     auto& transform = entity.GetComponent<se::TransformComponent>();
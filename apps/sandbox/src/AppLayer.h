@@ -36,10 +36,13 @@ class AppLayer : public se::Layer {
     // Helper methods for creating entities
     void AddDirectionalLight();
 
+    void AddPointLight(const glm::vec3& position, const glm::vec3& color);
+
     void CreateCubeEntity(const std::string& name, const glm::vec3& position,
-                          const glm::vec3& scale = glm::vec3(1.0f));
+                          const glm::vec3& scale = glm::vec3(1.0f), bool isStatic = false);
 
-    void CreateSphereEntity(const std::string& name, const glm::vec3& position);
+    void CreateSphereEntity(const std::string& name, const glm::vec3& position,
+                            se::MaterialHandle material = {});
 
     void CreateCapsuleEntity(const std::string& name, const glm::vec3& position);
 
@@ -48,7 +51,8 @@ class AppLayer : public se::Layer {
     std::unique_ptr<se::Scene> scene_;
 
     // Material
-    std::shared_ptr<se::Material> material_;
+    se::MaterialHandle material_;
+    se::MaterialHandle transparentMaterial_;
 
     // Camera and input
     Camera camera_;
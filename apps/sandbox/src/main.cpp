@@ -1,14 +1,21 @@
 #include "AppLayer.h"
 #include <engine/Application.h>
 #include <engine/Log.h>
+#include <string>
 
 using namespace std;
 
-int main() {
+int main(int argc, char** argv) {
     se::ApplicationSpec appSpec;
     appSpec.Name = "Simple engine";
     appSpec.WindowWidth = 1920;
     appSpec.WindowHeight = 1080;
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--render-thread")
+            appSpec.UseRenderThread = true;
+        else if (string(argv[i]) == "--metrics-port" && i + 1 < argc)
+            appSpec.MetricsPort = static_cast<uint16_t>(stoi(argv[++i]));
+    }
 
     se::LogInit(true);
 
@@ -7,14 +7,38 @@ in vec3 v_Normal;
 in vec3 v_FragPos;
 in vec4 v_LightSpacePos;
 in float f_SpecularStrenght;
+in float v_ViewDepth;
 
 uniform vec3 uLightDirection;
 uniform vec3 uLightColor;
 uniform float uLightIntensity;
 uniform float uAmbientStrength;
-uniform sampler2D uShadowMap;
+uniform sampler2DShadow uShadowMap;
+uniform int uShadowFilterMode; // 0 = 1-tap HW PCF, 1 = 4-tap, 2 = Poisson 8, 3 = Poisson 16
 uniform float uReceiveShadows;
 uniform float uShadowsEnabled;
+uniform float uTransparency; // 0 = opaque, only used by blended materials
+
+// Clustered local lights (see LightClusterer)
+uniform samplerBuffer uLightData;      // 4 texels per light
+uniform usamplerBuffer uLightClusters; // (offset, count) per cluster
+uniform usamplerBuffer uLightIndices;
+uniform int uLocalLightCount;
+uniform ivec3 uClusterGrid;
+uniform vec2 uViewportSize;
+uniform float uClusterZScale;
+uniform float uClusterZBias;
+
+const vec2 kPoissonDisk[16] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870), vec2(0.34495938, 0.29387760),
+    vec2(-0.91588581, 0.45771432), vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543, 0.27676845), vec2(0.97484398, 0.75648379),
+    vec2(0.44323325, -0.97511554), vec2(0.53742981, -0.47373420),
+    vec2(-0.26496911, -0.41893023), vec2(0.79197514, 0.19090188),
+    vec2(-0.24188840, 0.99706507), vec2(-0.81409955, 0.91437590),
+    vec2(0.19984126, 0.78641367), vec2(0.14383161, -0.14100790)
+);
 
 vec3 Saturate(vec3 value){
  return vec3(clamp(value.x,0.0,1.0),clamp(value.y,0.0,1.0),clamp(value.z,0.0,1.0));
@@ -32,18 +56,73 @@ float CalculateShadow(vec4 lightSpacePos, vec3 normal, vec3 lightDir) {
 
     float ndotl = max(dot(normal, lightDir), 0.0);
     float bias = max(0.0025, 0.05 * (1.0 - ndotl));
-    float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(uShadowMap, 0);
-    for (int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            float pcfDepth = texture(uShadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += projCoords.z - bias > pcfDepth ? 1.0 : 0.0;
+    float depth = projCoords.z - bias;
+    vec2 texelSize = 1.0 / vec2(textureSize(uShadowMap, 0));
+
+    // Each fetch returns the hardware-filtered fraction of lit texels
+    float lit = 0.0;
+    if (uShadowFilterMode == 0) {
+        lit = texture(uShadowMap, vec3(projCoords.xy, depth));
+    } else if (uShadowFilterMode == 1) {
+        lit += texture(uShadowMap, vec3(projCoords.xy + vec2(-0.5, -0.5) * texelSize, depth));
+        lit += texture(uShadowMap, vec3(projCoords.xy + vec2(0.5, -0.5) * texelSize, depth));
+        lit += texture(uShadowMap, vec3(projCoords.xy + vec2(-0.5, 0.5) * texelSize, depth));
+        lit += texture(uShadowMap, vec3(projCoords.xy + vec2(0.5, 0.5) * texelSize, depth));
+        lit *= 0.25;
+    } else {
+        int taps = uShadowFilterMode == 2 ? 8 : 16;
+        for (int i = 0; i < taps; ++i) {
+            vec2 offset = kPoissonDisk[i] * 1.5 * texelSize;
+            lit += texture(uShadowMap, vec3(projCoords.xy + offset, depth));
         }
+        lit /= float(taps);
     }
-    shadow /= 9.0;
+
+    float shadow = 1.0 - lit;
     return shadow;
 }
 
+vec3 CalculateLocalLights(vec3 normal, vec3 viewDir) {
+    if (uLocalLightCount == 0)
+    return vec3(0.0);
+
+    ivec2 tile = ivec2(gl_FragCoord.xy / uViewportSize * vec2(uClusterGrid.xy));
+    tile = clamp(tile, ivec2(0), uClusterGrid.xy - 1);
+    int slice = int(floor(log(max(v_ViewDepth, 1e-4)) * uClusterZScale + uClusterZBias));
+    slice = clamp(slice, 0, uClusterGrid.z - 1);
+    int cluster = tile.x + tile.y * uClusterGrid.x + slice * uClusterGrid.x * uClusterGrid.y;
+
+    uvec2 range = texelFetch(uLightClusters, cluster).xy;
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; ++i) {
+        int lightIndex = int(texelFetch(uLightIndices, int(range.x + i)).r);
+        vec4 positionRange = texelFetch(uLightData, lightIndex * 4);
+        vec4 colorType = texelFetch(uLightData, lightIndex * 4 + 1);
+        vec4 directionOuter = texelFetch(uLightData, lightIndex * 4 + 2);
+        float innerCos = texelFetch(uLightData, lightIndex * 4 + 3).x;
+
+        vec3 toLight = positionRange.xyz - v_FragPos;
+        float dist = length(toLight);
+        if (dist >= positionRange.w)
+        continue;
+
+        vec3 L = toLight / max(dist, 1e-4);
+        float falloff = clamp(1.0 - pow(dist / positionRange.w, 4.0), 0.0, 1.0);
+        float attenuation = falloff * falloff / (dist * dist + 1.0);
+
+        if (colorType.w > 0.5) {
+            float cosAngle = dot(-L, directionOuter.xyz);
+            attenuation *= smoothstep(directionOuter.w, innerCos, cosAngle);
+        }
+
+        float diff = max(dot(normal, L), 0.0);
+        vec3 halfway = normalize(L + viewDir);
+        float spec = f_SpecularStrenght * pow(max(dot(normal, halfway), 0.0), 64.0);
+        result += colorType.rgb * attenuation * (diff + spec);
+    }
+    return result;
+}
+
 void main() {
     vec3 normal = normalize(v_Normal);
     vec3 lightDir = normalize(uLightDirection);
@@ -70,6 +149,7 @@ void main() {
 
     // final light result
     vec3 result = (Saturate(ambient + diffuse) + specular) * objectColor * (1.0 - shadow);
+    result += CalculateLocalLights(normal, viewDir) * objectColor;
 
-    color = vec4(result, 1.0);
+    color = vec4(result, 1.0 - clamp(uTransparency, 0.0, 1.0));
 }
\ No newline at end of file
@@ -2,10 +2,12 @@
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec3 a_Color;
 layout(location = 2) in vec3 a_Normal;
+layout(location = 3) in int a_ObjectIndex; // slot in the GPU scene buffer, see GpuScene
 
 uniform mat4 uView;
-uniform mat4 uProj;
-uniform mat4 uModel;
+uniform mat4 uViewProjection;
+uniform vec3 uViewPos;
+uniform samplerBuffer uObjectData; // 8 texels per object
 uniform mat4 uLightSpaceMatrix;
 uniform float uSpecularStrength;
 
@@ -16,17 +18,29 @@ out vec3 v_Normal;
 out vec3 v_FragPos;
 out vec4 v_LightSpacePos;
 out float f_SpecularStrenght;
+out float v_ViewDepth;
+
+// Must match the depth pre-pass shader bit for bit (GL_EQUAL depth test)
+invariant gl_Position;
 
 void main() {
-    vec4 world_position = uModel * vec4(a_Position, 1.0);
+    int base = a_ObjectIndex * 8;
+    mat4 model = mat4(texelFetch(uObjectData, base), texelFetch(uObjectData, base + 1),
+                      texelFetch(uObjectData, base + 2), texelFetch(uObjectData, base + 3));
+    mat3 normalMatrix = mat3(texelFetch(uObjectData, base + 4).xyz,
+                             texelFetch(uObjectData, base + 5).xyz,
+                             texelFetch(uObjectData, base + 6).xyz);
+
+    vec4 world_position = model * vec4(a_Position, 1.0);
     v_FragPos = world_position.xyz;
 
     f_SpecularStrenght = uSpecularStrength;
 
-    v_Normal = mat3(transpose(inverse(uModel))) * a_Normal;
-    v_ViewPos = inverse(uView)[3].xyz;
+    v_Normal = normalMatrix * a_Normal;
+    v_ViewPos = uViewPos;
     v_Color = a_Color;
     v_LightSpacePos = uLightSpaceMatrix * world_position;
+    v_ViewDepth = -(uView * world_position).z;
 
-    gl_Position = uProj * uView * world_position;
+    gl_Position = uViewProjection * world_position;
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace se {
+
+struct AllocationCounts {
+    uint64_t Allocations = 0;
+    uint64_t Frees = 0;
+    uint64_t Bytes = 0; // allocated; frees don't report a size
+};
+
+struct ThreadAllocationCounts {
+    std::string ThreadName;
+    AllocationCounts LastFrame;
+    AllocationCounts Total;
+};
+
+// What an allocation inside a SE_NO_ALLOC_SCOPE does
+enum class NoAllocMode {
+    Off,
+    Report, // logged once per distinct call stack at the next MarkFrame
+    Abort   // call stack printed to stderr, then abort()
+};
+
+// Counts every global operator new/delete per thread by replacing them, when the engine is
+// built with SIMPLEENGINE_TRACK_ALLOCATIONS. Counting is a few relaxed atomic adds per call.
+// Otherwise every count reads zero and no-alloc scopes compile away.
+//
+// Threads get a slot on their first allocation and keep it for the life of the process; past
+// kMaxThreads they share the last one.
+class AllocationTracker {
+  public:
+    static constexpr uint32_t kMaxThreads = 64;
+
+    static bool IsEnabled();
+
+    // Main thread, once per frame: closes the frame, reports no-alloc violations and returns
+    // the allocations made by all threads since the previous call
+    static AllocationCounts MarkFrame();
+    static AllocationCounts GetLastFrameCounts();
+    static AllocationCounts GetTotalCounts();
+    // Threads that allocated at least once
+    static std::vector<ThreadAllocationCounts> GetThreadCounts();
+
+    // Also set by Profiler::SetThreadName
+    static void SetThreadName(const char* name);
+
+    static void SetNoAllocMode(NoAllocMode mode);
+    static NoAllocMode GetNoAllocMode();
+    static uint64_t GetNoAllocViolationCount();
+
+    // Prefer SE_NO_ALLOC_SCOPE; name needs static storage
+    static void BeginNoAllocScope(const char* name);
+    static void EndNoAllocScope();
+
+  private:
+    AllocationTracker() = delete;
+};
+
+class NoAllocScope {
+  public:
+    explicit NoAllocScope(const char* name) {
+        AllocationTracker::BeginNoAllocScope(name);
+    }
+    ~NoAllocScope() {
+        AllocationTracker::EndNoAllocScope();
+    }
+
+    NoAllocScope(const NoAllocScope&) = delete;
+    NoAllocScope& operator=(const NoAllocScope&) = delete;
+};
+
+} // namespace se
+
+#ifdef SE_ALLOCATION_TRACKING
+#    define SE_NO_ALLOC_CONCAT_INNER(a, b) a##b
+#    define SE_NO_ALLOC_CONCAT(a, b) SE_NO_ALLOC_CONCAT_INNER(a, b)
+#    define SE_NO_ALLOC_SCOPE(name)                                                           \
+        ::se::NoAllocScope SE_NO_ALLOC_CONCAT(seNoAllocScope, __LINE__)(name)
+#else
+#    define SE_NO_ALLOC_SCOPE(name) ((void)0)
+#endif
@@ -2,6 +2,7 @@
 
 #include "engine/ImGuiLayer.h"
 #include "engine/Layer.h"
+#include "engine/PerformancePanel.h"
 #include "engine/Renderer.h"
 #include "engine/Window.h"
 #include <memory>
@@ -33,6 +34,9 @@ class Application {
     Renderer& GetRenderer() {
         return *renderer_;
     }
+    PerformancePanel& GetPerformancePanel() {
+        return performancePanel_;
+    }
 
     static Application& Get();
 
@@ -42,9 +46,11 @@ class Application {
     std::unique_ptr<Window> window_;
     std::unique_ptr<Renderer> renderer_;
     std::shared_ptr<ImGuiLayer> imguiLayer_;
+    PerformancePanel performancePanel_;
 
     std::vector<std::unique_ptr<Layer>> layer_stack_;
     bool running_ = false;
+    bool useRenderThread_ = false;
 
     static Application* s_Instance;
 };
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "engine/PerformancePanel.h"
+#include <cstdint>
+#include <string>
+
+namespace se {
+
+struct FlightRecorderSettings {
+    bool Enabled = true;
+    // A frame slower than this triggers a dump
+    float HitchThresholdMs = 50.0f;
+    // Window written around the trigger frame
+    uint32_t FramesBefore = 120;
+    uint32_t FramesAfter = 30;
+    // Hitches within this long after a dump are not dumped again
+    float CooldownSeconds = 10.0f;
+    std::string Directory = "traces";
+};
+
+// Keeps the last kHistoryFrames frames of timings and counters. When a frame exceeds the hitch
+// threshold it waits for FramesAfter more frames, then writes the window as a Chrome trace: a
+// frame track, one counter track per value and the CPU zones the Profiler still holds for it.
+// RequestDump writes the window once the current frame closes. Collecting the zones and
+// writing the file happen on a background thread.
+//
+// Everything but GetSettings is main thread only.
+class FlightRecorder {
+  public:
+    static constexpr uint32_t kHistoryFrames = 300;
+    static constexpr uint32_t kMaxCounters = 24;
+
+    static void Init(const FlightRecorderSettings& settings = {});
+    // Finishes the dumps already queued
+    static void Shutdown();
+
+    static void SetSettings(const FlightRecorderSettings& settings);
+    static FlightRecorderSettings GetSettings();
+
+    // Value of a per-frame counter, recorded with the current frame; name needs static storage
+    static void SetCounter(const char* name, double value);
+    // Closes a frame. Adds the render stats published by the SceneRenderer as counters.
+    static void RecordFrame(const FrameTimings& timings);
+
+    static void RequestDump();
+    static uint32_t GetDumpCount();
+
+  private:
+    FlightRecorder() = delete;
+};
+
+} // namespace se
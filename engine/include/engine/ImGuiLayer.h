@@ -21,9 +21,13 @@ class ImGuiLayer : public Layer {
     void End();   // Render ImGui draw data
 
     void SetWindow(GLFWwindow* window);
+    // Platform windows render with their own contexts on the main thread, so they are only
+    // available without a render thread. Set before OnAttach.
+    void SetViewportsEnabled(bool enabled);
 
   private:
     GLFWwindow* window_ = nullptr;
+    bool viewportsEnabled_ = true;
 };
 
 } // namespace se
\ No newline at end of file
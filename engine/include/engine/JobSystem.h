@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace se {
+
+// Minimal fork/join worker pool. ParallelFor splits [0, count) into batches that are
+// executed by the workers and the calling thread, and returns once all of them finished.
+class JobSystem {
+  public:
+    // workerCount = 0 picks hardware_concurrency - 1
+    static void Init(uint32_t workerCount = 0);
+    static void Shutdown();
+
+    static uint32_t GetWorkerCount();
+
+    // Called as job(begin, end) for every batch; nested calls from a job run inline. The job
+    // is only borrowed for the duration of the call, so capturing does not allocate.
+    template <typename Job>
+    static void ParallelFor(uint32_t count, uint32_t batchSize, Job&& job) {
+        using Callable = std::remove_reference_t<Job>;
+        RunParallelFor(count, batchSize, std::addressof(job),
+                       [](const void* data, uint32_t begin, uint32_t end) {
+                           (*static_cast<const Callable*>(data))(begin, end);
+                       });
+    }
+
+  private:
+    using JobThunk = void (*)(const void* job, uint32_t begin, uint32_t end);
+
+    static void RunParallelFor(uint32_t count, uint32_t batchSize, const void* job,
+                               JobThunk thunk);
+
+    JobSystem() = delete;
+};
+
+} // namespace se
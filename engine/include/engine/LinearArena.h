@@ -0,0 +1,75 @@
+#pragma once
+
+#include "engine/MemoryTracker.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace se {
+
+// Bump allocator for memory that dies all at once. Allocation is a compare-and-swap on the
+// current block, safe from any thread; deallocate does nothing and Reset frees everything.
+// When a frame needs more than one block, Reset replaces them with a single block big enough
+// for the whole frame, so steady state runs out of one block without touching the heap.
+//
+// As a std::pmr::memory_resource it backs pmr containers directly:
+//     std::pmr::vector<uint32_t> indices(&arena);
+// Destructors of the objects in it still have to run before Reset if they own anything.
+class LinearArena : public std::pmr::memory_resource {
+  public:
+    explicit LinearArena(size_t blockSize = 256 * 1024, MemoryTag tag = MemoryTag::Renderer);
+    ~LinearArena() override;
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // No allocation may be in progress or follow on another thread until it returns
+    void Reset();
+
+    size_t GetUsedBytes() const;
+    size_t GetCapacity() const {
+        return capacity_.load(std::memory_order_relaxed);
+    }
+    // Most bytes used between two resets
+    size_t GetPeakBytes() const {
+        return peakBytes_;
+    }
+
+  protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+  private:
+    struct Block {
+        std::unique_ptr<std::byte[]> Data;
+        size_t Size = 0;
+        std::atomic<size_t> Used{0};
+    };
+
+    Block* AddBlock(size_t minimumSize);
+
+    size_t blockSize_;
+    MemoryAllocation memory_;
+    // Guards blocks_; the current block is read without it
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Block>> blocks_;
+    std::atomic<Block*> current_{nullptr};
+    std::atomic<size_t> capacity_{0};
+    size_t peakBytes_ = 0;
+};
+
+} // namespace se
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace se {
+
+// Subsystem an allocation is charged to
+enum class MemoryTag : uint8_t {
+    Untagged,
+    Meshes,        // vertex/index buffers, geometry arenas
+    Shaders,       // linked programs
+    RenderTargets, // render graph texture pool
+    Shadows,       // cached shadow maps
+    Renderer,      // GPU scene, light clusters, indirect draw buffers
+    Scene,         // entity registries
+    Profiling,     // profiler rings, flight recorder history
+    Count
+};
+
+enum class MemoryDomain : uint8_t { Cpu, Gpu, Count };
+
+struct MemoryUsage {
+    uint64_t Bytes = 0;
+    uint64_t PeakBytes = 0;
+    uint64_t Allocations = 0; // live
+    uint64_t BudgetBytes = 0; // 0 when unbudgeted
+};
+
+// Byte counts per tag and domain. GPU sizes are what was requested from the driver, not what it
+// actually reserves. Counters are relaxed atomics usable from any thread, including during
+// static initialization.
+class MemoryTracker {
+  public:
+    static void Allocate(MemoryTag tag, MemoryDomain domain, uint64_t bytes);
+    static void Free(MemoryTag tag, MemoryDomain domain, uint64_t bytes);
+    // Grows or shrinks a live allocation
+    static void Resize(MemoryTag tag, MemoryDomain domain, uint64_t oldBytes, uint64_t newBytes);
+
+    static MemoryUsage GetUsage(MemoryTag tag, MemoryDomain domain);
+    static uint64_t GetTotalBytes(MemoryDomain domain);
+    // Peaks restart from the current usage
+    static void ResetPeaks();
+
+    // Crossing the budget logs a warning, once until usage drops below it again; 0 removes it
+    static void SetBudget(MemoryTag tag, MemoryDomain domain, uint64_t bytes);
+    static bool IsOverBudget(MemoryTag tag, MemoryDomain domain);
+
+    static const char* GetTagName(MemoryTag tag);
+    static const char* GetDomainName(MemoryDomain domain);
+
+    // Size of a 2D texture without mips, from its GL internal format
+    static uint64_t TextureBytes(uint32_t internalFormat, uint32_t width, uint32_t height);
+
+    // Adds se_memory_bytes, se_memory_peak_bytes and se_memory_budget_bytes to the metrics
+    static void RegisterMetrics();
+
+  private:
+    MemoryTracker() = delete;
+};
+
+// Bytes charged to a tag for as long as the object lives, for resources whose size is known
+// when they are created or resized (GL buffers and textures)
+class MemoryAllocation {
+  public:
+    MemoryAllocation() = default;
+    MemoryAllocation(MemoryTag tag, MemoryDomain domain, uint64_t bytes = 0);
+    ~MemoryAllocation();
+
+    MemoryAllocation(MemoryAllocation&& other) noexcept;
+    MemoryAllocation& operator=(MemoryAllocation&& other) noexcept;
+    MemoryAllocation(const MemoryAllocation&) = delete;
+    MemoryAllocation& operator=(const MemoryAllocation&) = delete;
+
+    void Resize(uint64_t bytes);
+    void Reset() {
+        Resize(0);
+    }
+
+    uint64_t GetBytes() const {
+        return bytes_;
+    }
+
+  private:
+    MemoryTag tag_ = MemoryTag::Untagged;
+    MemoryDomain domain_ = MemoryDomain::Cpu;
+    uint64_t bytes_ = 0;
+};
+
+// Standard allocator counting its CPU memory under Tag
+template <typename T, MemoryTag Tag>
+class TrackedAllocator {
+  public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TrackedAllocator<U, Tag>;
+    };
+
+    TrackedAllocator() noexcept = default;
+    template <typename U>
+    TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t count) {
+        T* memory = std::allocator<T>().allocate(count);
+        MemoryTracker::Allocate(Tag, MemoryDomain::Cpu, count * sizeof(T));
+        return memory;
+    }
+
+    void deallocate(T* memory, size_t count) noexcept {
+        std::allocator<T>().deallocate(memory, count);
+        MemoryTracker::Free(Tag, MemoryDomain::Cpu, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const TrackedAllocator<U, Tag>&) const noexcept {
+        return true;
+    }
+};
+
+} // namespace se
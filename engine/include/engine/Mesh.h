@@ -1,5 +1,6 @@
 #pragma once
 
+#include "engine/MemoryTracker.h"
 #include <glad/glad.h>
 #include <vector>
 
@@ -53,4 +54,5 @@ class Mesh {
     GLuint vao_ = 0;
     GLuint vbo_ = 0;
     GLuint ebo_ = 0;
+    se::MemoryAllocation gpuMemory_;
 };
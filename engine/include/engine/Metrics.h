@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace se {
+
+// Metric objects are created once by the registry and live until the process exits, so call
+// sites keep a reference, typically in a function-local static. Updates are relaxed atomics.
+class MetricCounter {
+  public:
+    void Add(double value = 1.0) {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+    double Get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<double> value_{0.0};
+};
+
+class MetricGauge {
+  public:
+    void Set(double value) {
+        value_.store(value, std::memory_order_relaxed);
+    }
+    void Add(double value) {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+    double Get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<double> value_{0.0};
+};
+
+class MetricHistogram {
+  public:
+    // Upper bounds in ascending order; a +Inf bucket is implied
+    explicit MetricHistogram(std::vector<double> bounds);
+
+    void Observe(double value);
+
+    const std::vector<double>& GetBounds() const {
+        return bounds_;
+    }
+    // Per bucket, not cumulative; the last one is +Inf
+    uint64_t GetBucketCount(size_t bucket) const {
+        return buckets_[bucket].load(std::memory_order_relaxed);
+    }
+    uint64_t GetCount() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+    double GetSum() const {
+        return sum_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<double> sum_{0.0};
+};
+
+struct MetricsExporterSettings {
+    // Rewritten every interval; empty disables the file
+    std::string SnapshotPath = "metrics.prom";
+    float SnapshotIntervalSeconds = 15.0f;
+    // Serves GET /metrics on 127.0.0.1; 0 disables the endpoint
+    uint16_t HttpPort = 0;
+};
+
+// Process-wide registry of counters, gauges and histograms, exported in the Prometheus text
+// format. Registration takes a lock; updating a registered metric doesn't.
+//
+// labels is the inside of the braces, e.g. "cache=\"shader\"". Metrics sharing a name must have
+// the same type; registering a name with another type throws.
+class Metrics {
+  public:
+    static MetricCounter& Counter(const std::string& name, const std::string& help,
+                                  const std::string& labels = "");
+    static MetricGauge& Gauge(const std::string& name, const std::string& help,
+                              const std::string& labels = "");
+    static MetricHistogram& Histogram(const std::string& name, const std::string& help,
+                                      std::vector<double> bounds, const std::string& labels = "");
+
+    // Runs before every snapshot, for values that are cheaper to sample than to track
+    static void AddCollector(std::function<void()> collector);
+
+    static std::string Snapshot();
+
+    // Background thread writing the snapshot file and serving the HTTP endpoint
+    static void StartExporter(const MetricsExporterSettings& settings);
+    // Writes a last snapshot and joins
+    static void StopExporter();
+
+  private:
+    Metrics() = delete;
+};
+
+} // namespace se
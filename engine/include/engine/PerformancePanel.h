@@ -0,0 +1,117 @@
+#pragma once
+
+#include "engine/Profiler.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace se {
+
+// CPU time of one main loop iteration, split by phase
+struct FrameTimings {
+    uint64_t Index = 0;
+    uint64_t StartNs = 0; // Profiler::Now() clock
+    float FrameMs = 0.0f;
+    float EventsMs = 0.0f;
+    float UpdateMs = 0.0f;
+    float RenderMs = 0.0f;
+    float ImGuiMs = 0.0f;
+    // Buffer swap, or waiting for the render thread when it runs
+    float SwapMs = 0.0f;
+    // Heap allocations made by all threads, see AllocationTracker
+    uint64_t Allocations = 0;
+    uint64_t AllocatedBytes = 0;
+};
+
+// Frame time history with percentiles, a histogram, hitch markers and the GPU pass times.
+// Recording a frame only copies it into a ring; the summary is rebuilt a few times per second
+// and only while the panel is open, so it can stay on in release builds.
+//
+// Pausing freezes the displayed history. Clicking a frame pauses and lists the CPU zones the
+// profiler still holds for it.
+class PerformancePanel {
+  public:
+    static constexpr uint32_t kHistoryFrames = 512;
+    static constexpr uint32_t kHistogramBins = 40;
+
+    void RecordFrame(const FrameTimings& frame);
+    // Between ImGuiLayer::Begin and End
+    void Draw();
+
+    void SetOpen(bool open) {
+        open_ = open;
+    }
+    bool IsOpen() const {
+        return open_;
+    }
+
+    // A hitch takes more than factor x the median frame and at least kMinHitchMs longer
+    void SetHitchFactor(float factor) {
+        hitchFactor_ = factor;
+    }
+    float GetHitchThresholdMs() const {
+        return summary_.HitchThresholdMs;
+    }
+
+  private:
+    static constexpr float kMinHitchMs = 4.0f;
+    static constexpr uint64_t kSummaryIntervalNs = 250'000'000;
+
+    struct History {
+        std::array<FrameTimings, kHistoryFrames> Frames{};
+        uint32_t Count = 0;
+        uint32_t Next = 0;
+
+        // i = 0 is the oldest frame
+        const FrameTimings& At(uint32_t i) const {
+            return Frames[(Next + kHistoryFrames - Count + i) % kHistoryFrames];
+        }
+    };
+
+    struct Summary {
+        float AverageMs = 0.0f;
+        float P50Ms = 0.0f;
+        float P95Ms = 0.0f;
+        float P99Ms = 0.0f;
+        float MaxMs = 0.0f;
+        float HitchThresholdMs = 0.0f;
+        uint32_t Hitches = 0;
+        // Average of each phase, in FrameTimings order
+        std::array<float, 5> PhaseMs{};
+        float Allocations = 0.0f;
+        float AllocatedBytes = 0.0f;
+        uint64_t MaxAllocations = 0;
+        std::array<float, kHistogramBins> Histogram{};
+        float HistogramMaxMs = 0.0f;
+    };
+
+    const History& Displayed() const {
+        return paused_ ? frozen_ : live_;
+    }
+
+    void SetPaused(bool paused);
+    void RefreshSummary();
+    void DrawSummary();
+    void DrawFrameGraph();
+    void DrawSelectedFrame();
+    void DrawGpuPasses();
+    void DrawMemory();
+    void SelectFrame(const FrameTimings& frame);
+
+    History live_;
+    History frozen_;
+    Summary summary_;
+    uint64_t lastSummaryNs_ = 0;
+
+    bool open_ = true;
+    bool paused_ = false;
+    float hitchFactor_ = 2.0f;
+    // The GpuProfiler itself lives on the render thread
+    bool profileGpu_ = true;
+
+    bool hasSelection_ = false;
+    FrameTimings selected_;
+    std::vector<ProfileThreadZones> selectedZones_;
+};
+
+} // namespace se
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace se {
+
+struct ProfileZone {
+    // Static storage only: string literals or __func__
+    const char* Name = nullptr;
+    uint64_t StartNs = 0;
+    uint64_t EndNs = 0;
+    uint32_t Depth = 0;
+};
+
+// A value plotted as a counter track in Chrome traces
+struct ProfileCounterSample {
+    const char* Name = nullptr; // static storage, like zone names
+    uint64_t TimeNs = 0;
+    double Value = 0.0;
+};
+
+struct ProfileThreadZones {
+    uint32_t ThreadId = 0;
+    std::string ThreadName;
+    std::vector<ProfileZone> Zones;
+};
+
+// Hierarchical CPU zones. Every thread records into its own fixed ring of the last
+// kZonesPerThread zones without locking, so recording is always on and cheap; readers copy
+// time windows out of the rings. A capture is such a window, exported as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev).
+//
+// Use the SE_PROFILE_* macros; they compile to nothing without SE_PROFILING_ENABLED.
+class Profiler {
+  public:
+    static constexpr uint32_t kZonesPerThread = 1u << 15;
+    static constexpr uint32_t kFrameHistory = 512;
+
+    // Nanoseconds on the steady clock since the first call
+    static uint64_t Now();
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    // Name shown for the calling thread in traces and allocation counts
+    static void SetThreadName(const std::string& name);
+
+    // Called once per main loop iteration, before anything else in the frame
+    static void MarkFrame();
+    static uint64_t GetFrameIndex();
+    // Start times of the last frames, oldest first; the last one is still running
+    static std::vector<uint64_t> GetFrameStarts(uint32_t count = kFrameHistory);
+
+    // Zones of every thread that ended in [beginNs, endNs) and are still in the rings
+    static std::vector<ProfileThreadZones> CollectZones(uint64_t beginNs, uint64_t endNs);
+
+    static void BeginCapture();
+    // Writes everything recorded since BeginCapture; false if no capture runs or on IO errors
+    static bool EndCapture(const std::string& path);
+    static bool IsCapturing();
+
+    static bool WriteChromeTrace(const std::string& path,
+                                 const std::vector<ProfileThreadZones>& threads,
+                                 const std::vector<ProfileCounterSample>& counters = {});
+
+    static uint32_t BeginZone();
+    static void EndZone(const char* name, uint64_t startNs, uint32_t depth);
+
+  private:
+    Profiler() = delete;
+};
+
+class ProfileZoneScope {
+  public:
+    explicit ProfileZoneScope(const char* name)
+        : name_(name), depth_(Profiler::BeginZone()), start_(Profiler::Now()) {}
+    ~ProfileZoneScope() {
+        Profiler::EndZone(name_, start_, depth_);
+    }
+
+    ProfileZoneScope(const ProfileZoneScope&) = delete;
+    ProfileZoneScope& operator=(const ProfileZoneScope&) = delete;
+
+  private:
+    const char* name_;
+    uint32_t depth_;
+    uint64_t start_;
+};
+
+} // namespace se
+
+#ifdef SE_PROFILING_ENABLED
+#    define SE_PROFILE_CONCAT_INNER(a, b) a##b
+#    define SE_PROFILE_CONCAT(a, b) SE_PROFILE_CONCAT_INNER(a, b)
+#    define SE_PROFILE_SCOPE(name)                                                            \
+        ::se::ProfileZoneScope SE_PROFILE_CONCAT(seProfileZone, __LINE__)(name)
+#    define SE_PROFILE_FUNCTION() SE_PROFILE_SCOPE(__func__)
+#    define SE_PROFILE_FRAME() ::se::Profiler::MarkFrame()
+#    define SE_PROFILE_THREAD(name) ::se::Profiler::SetThreadName(name)
+#else
+#    define SE_PROFILE_SCOPE(name) ((void)0)
+#    define SE_PROFILE_FUNCTION() ((void)0)
+#    define SE_PROFILE_FRAME() ((void)0)
+#    define SE_PROFILE_THREAD(name) ((void)0)
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace se {
+
+class GraphicsContext;
+class LinearArena;
+
+// Optional thread that owns the GL context. The main thread records frame N + 1 (events,
+// simulation, scene extraction, ImGui) while the render thread executes frame N, so
+// simulation time and driver time overlap instead of adding up.
+//
+// Ownership while it runs:
+// - Main thread: the Window (events, input, size, close requests) and everything a layer
+//   touches in OnUpdate, OnRender and OnImGuiRender. It must not call GL directly.
+// - Render thread: the GraphicsContext, which is current only there, and every GL object.
+//   GL work reaches it through Submit; SceneRenderer, ImGuiLayer and Application already do.
+// - GL objects are created and destroyed on the render thread, or while it is stopped: layers
+//   are attached before Start and detached after Stop, with the context current on the main
+//   thread.
+class RenderThread {
+  public:
+    // Frames the main thread may run ahead before EndFrame blocks
+    static constexpr uint32_t kMaxFramesInFlight = 2;
+
+    static void Start(GraphicsContext& context);
+    // Executes every frame handed off so far, joins, and makes the context current again on
+    // the calling thread
+    static void Stop();
+
+    static bool IsRunning();
+    static bool IsRenderThread();
+
+    // Called first by resource entry points that issue GL themselves. While the render thread
+    // runs, the context is current only there, so any other caller is logged and aborts
+    // instead of failing somewhere inside the driver.
+    static void RequireContext(const char* caller);
+
+    // Appends the command to the frame being recorded. Runs it right away when the render
+    // thread isn't running or when called from the render thread itself.
+    static void Submit(std::function<void()> command);
+
+    // Hands the recorded frame to the render thread
+    static void EndFrame();
+
+    // Arena for data that lives only as long as one frame: on the render thread the frame it
+    // is executing, anywhere else the frame being recorded. It is reset kMaxFramesInFlight + 1
+    // EndFrames later, once no frame that could still point into it is in flight.
+    static LinearArena& GetFrameArena();
+
+    // Main thread: keeps the object alive until every frame recorded so far has executed, then
+    // destroys it on the render thread. Stop destroys whatever is still pending.
+    static void DeferRelease(std::shared_ptr<const void> object);
+
+  private:
+    RenderThread() = delete;
+};
+
+} // namespace se
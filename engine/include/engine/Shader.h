@@ -1,5 +1,6 @@
 #pragma once
 #include "se_pch.h"
+#include <engine/MemoryTracker.h>
 #include <engine/utils/FilesHandler.h>
 
 #include <glm.hpp>
@@ -29,6 +30,8 @@ class Shader {
     // Minimal uniform helper (float)
     void setFloat(const char* name, float value) const;
     void setInt(const char* name, int value) const;
+    void setIVec3(const char* name, const glm::ivec3& value) const;
+    void setVec2(const char* name, const glm::vec2& value) const;
     void setVec3(const char* name, const glm::vec3& value) const;
     void setVec4(const char* name, const glm::vec4& value) const;
     void setMat4(const char* name, const glm::mat4& value) const;
@@ -39,11 +42,13 @@ class Shader {
     unsigned int release() {
         unsigned int id = program_;
         program_ = 0;
+        memory_.Reset();
         return id;
     }
 
   private:
     unsigned int program_ = 0;
+    MemoryAllocation memory_{MemoryTag::Shaders, MemoryDomain::Gpu};
 
     static unsigned int compileStage(unsigned int type, const char* src);
     static void checkCompile(unsigned int id, bool isProgram);
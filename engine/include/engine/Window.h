@@ -15,6 +15,12 @@ struct ApplicationSpec {
     uint32_t WindowWidth = 1280;
     uint32_t WindowHeight = 720;
     bool VSync = true;
+    // Run GL on a dedicated render thread, pipelined one frame behind the main thread
+    bool UseRenderThread = false;
+    // Prometheus text snapshot, rewritten periodically; empty disables it
+    std::string MetricsSnapshotPath = "metrics.prom";
+    // Serves the metrics on 127.0.0.1; 0 disables the endpoint
+    uint16_t MetricsPort = 0;
 };
 
 class Window {
@@ -55,6 +61,10 @@ class Window {
 
     void SwapBuffers();
 
+    GraphicsContext& GetContext() {
+        return *context_;
+    }
+
   private:
     void Init(uint32_t width, uint32_t height, const std::string& title);
     void Shutdown();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "engine/resources/ResourceHandle.h"
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtx/quaternion.hpp>
@@ -8,8 +9,7 @@
 
 namespace se {
 // Forward declarations
-class Material;
-class VertexArray;
+struct OccluderMesh;
 
 // ==================== Transform Component ====================
 // Similar to Unity's Transform component
@@ -98,18 +98,24 @@ struct NameComponent {
 // ==================== Mesh Render Component ====================
 // Handles mesh rendering for an entity
 struct MeshRenderComponent {
-    std::shared_ptr<VertexArray> VertexArray;
-    std::shared_ptr<Material> Material;
+    // See MeshManager and MaterialManager
+    MeshHandle Mesh;
+    MaterialHandle Material;
     bool IsVisible = true;
     bool CastShadows = true;
     bool ReceiveShadows = true;
+    // Static entities never move; their shadows are cached between frames (report changes
+    // with Scene::MarkStaticChanged)
+    bool IsStatic = false;
+    // Level of detail picked last frame (runtime state, see VertexArray::SelectLod)
+    uint32_t CurrentLod = 0;
 
     MeshRenderComponent() = default;
 
     MeshRenderComponent(const MeshRenderComponent&) = default;
 
-    MeshRenderComponent(std::shared_ptr<se::VertexArray> va, std::shared_ptr<se::Material> mat)
-        : VertexArray(va), Material(mat) {}
+    MeshRenderComponent(MeshHandle mesh, MaterialHandle material)
+        : Mesh(mesh), Material(material) {}
 };
 
 struct DirectionalLightComponent {
@@ -122,4 +128,45 @@ struct DirectionalLightComponent {
 
     DirectionalLightComponent(const DirectionalLightComponent&) = default;
 };
+
+// ==================== Local Light Components ====================
+// Point and spot lights are clustered, so scenes can have hundreds of them
+struct PointLightComponent {
+    glm::vec3 Color{1.0f, 1.0f, 1.0f};
+    float Intensity = 1.0f;
+    float Range = 5.0f;
+    bool Enabled = true;
+
+    PointLightComponent() = default;
+
+    PointLightComponent(const PointLightComponent&) = default;
+};
+
+// Shines along the entity's forward vector
+struct SpotLightComponent {
+    glm::vec3 Color{1.0f, 1.0f, 1.0f};
+    float Intensity = 1.0f;
+    float Range = 10.0f;
+    float InnerConeAngle = 20.0f; // degrees
+    float OuterConeAngle = 30.0f; // degrees
+    bool Enabled = true;
+
+    SpotLightComponent() = default;
+
+    SpotLightComponent(const SpotLightComponent&) = default;
+};
+
+// ==================== Occluder Component ====================
+// Rasterized by the CPU occlusion culler to hide the meshes behind it. Keep the mesh simple
+// and inside the rendered geometry (e.g. a box inside a wall).
+struct OccluderComponent {
+    std::shared_ptr<const OccluderMesh> Mesh;
+    bool Enabled = true;
+
+    OccluderComponent() = default;
+
+    OccluderComponent(const OccluderComponent&) = default;
+
+    OccluderComponent(std::shared_ptr<const OccluderMesh> mesh) : Mesh(std::move(mesh)) {}
+};
 } // namespace se
@@ -3,11 +3,26 @@
 
 #include "engine/Camera.h"
 #include <glm.hpp>
+#include <memory>
 
 namespace se {
 
 // Forward declarations
 class Scene;
+class OcclusionCuller;
+
+struct OcclusionStats {
+    uint32_t Occluders = 0;
+    uint32_t OccluderTriangles = 0;
+    uint32_t TestedObjects = 0;
+    uint32_t OccludedObjects = 0;
+};
+
+struct LodStats {
+    uint32_t Triangles = 0;           // submitted at the selected levels
+    uint32_t FullDetailTriangles = 0; // had every object used level 0
+    uint32_t Switches = 0;            // objects that changed level this frame
+};
 
 class RenderSystem {
   public:
@@ -17,9 +32,30 @@ class RenderSystem {
     // Render all entities with MeshRenderComponent in the scene
     static void Render(Scene& scene, const Camera& camera, float aspectRatio);
 
+    // Skips meshes hidden behind OccluderComponent entities before they are submitted
+    static void SetOcclusionCulling(bool enabled);
+    static bool IsOcclusionCullingEnabled();
+    static OcclusionStats GetOcclusionStats();
+
+    // Positive bias picks coarser levels of detail (each step halves the apparent size),
+    // negative finer ones. Hysteresis is the relative band around each switch threshold.
+    static void SetLodBias(float bias);
+    static float GetLodBias();
+    static void SetLodHysteresis(float hysteresis);
+    static float GetLodHysteresis();
+    static LodStats GetLodStats();
+
   private:
     RenderSystem() = delete;
     static bool initialized_;
+    static bool occlusionCulling_;
+    static std::unique_ptr<OcclusionCuller> occlusionCuller_;
+    static OcclusionStats occlusionStats_;
+    static float lodBias_;
+    static float lodHysteresis_;
+    static LodStats lodStats_;
+    static uint64_t staticGeneration_;
+    static uint32_t missingResources_;
 };
 
 } // namespace se
\ No newline at end of file
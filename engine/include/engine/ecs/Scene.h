@@ -3,12 +3,15 @@
 
 #include "engine/Camera.h"
 #include "engine/Log.h"
+#include "engine/MemoryTracker.h"
 #include "engine/ecs/Entity.h"
 #include <entt.hpp>
 #include <string>
 
 namespace se {
 
+class MetricGauge;
+
 class Scene {
   public:
     Scene(const std::string& name = "Untitled Scene");
@@ -43,14 +46,28 @@ class Scene {
     // Clear all entities
     void Clear();
 
+    // Changes whenever the set of static shadow casters may have changed, so their cached
+    // shadows are only re-rendered then. Adding or removing a MeshRenderComponent bumps it
+    // automatically; moving a static entity or changing its mesh, material or flags has to be
+    // reported with MarkStaticChanged.
+    uint64_t GetStaticGeneration() const {
+        return staticGeneration_;
+    }
+    void MarkStaticChanged();
+
     // Get entity count (number of alive entities)
     size_t GetEntityCount() const {
         return registry_.storage<entt::entity>()->size();
     }
 
   private:
+    using Registry =
+        entt::basic_registry<entt::entity, TrackedAllocator<entt::entity, MemoryTag::Scene>>;
+
     std::string name_;
-    entt::registry registry_;
+    Registry registry_;
+    MetricGauge& entityGauge_;
+    uint64_t staticGeneration_ = 0;
 
     friend class Entity;
     friend class RenderSystem;
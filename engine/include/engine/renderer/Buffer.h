@@ -1,6 +1,8 @@
 #pragma once
 
+#include "engine/MemoryTracker.h"
 #include <cstdint>
+#include <string>
 #include <vector>
 
 namespace se {
@@ -18,9 +20,25 @@ enum class ShaderDataType {
     Int2,
     Int3,
     Int4,
-    Bool
+    Bool,
+    // Packed formats, read as float vectors by the shader (set Normalized for [0,1]/[-1,1])
+    Half2,
+    Half4,
+    Byte4,
+    UByte4,
+    Short2,           // e.g. octahedral normals, see PackOctahedral
+    Int2_10_10_10_Rev // xyz 10 bits, w 2 bits, signed
 };
 
+enum class IndexType { UInt16, UInt32 };
+
+inline uint32_t IndexTypeSize(IndexType type) {
+    return type == IndexType::UInt16 ? 2 : 4;
+}
+
+// GL_UNSIGNED_SHORT / GL_UNSIGNED_INT
+uint32_t IndexTypeToOpenGL(IndexType type);
+
 struct BufferElement {
     std::string Name;
     ShaderDataType Type;
@@ -70,8 +88,8 @@ class BufferLayout {
 // Vertex Buffer
 class VertexBuffer {
   public:
-    VertexBuffer(const void* vertices, uint32_t size);
-    VertexBuffer(uint32_t size); // Dynamic buffer
+    VertexBuffer(const void* vertices, uint32_t size, MemoryTag tag = MemoryTag::Meshes);
+    VertexBuffer(uint32_t size, MemoryTag tag = MemoryTag::Meshes); // Dynamic buffer
     ~VertexBuffer();
 
     void Bind() const;
@@ -79,6 +97,10 @@ class VertexBuffer {
 
     void SetData(const void* data, uint32_t size);
 
+    uint32_t GetRendererId() const {
+        return rendererId_;
+    }
+
     const BufferLayout& GetLayout() const {
         return layout_;
     }
@@ -89,12 +111,17 @@ class VertexBuffer {
   private:
     uint32_t rendererId_;
     BufferLayout layout_;
+    MemoryAllocation memory_;
 };
 
 // Index Buffer
 class IndexBuffer {
   public:
     IndexBuffer(const uint32_t* indices, uint32_t count);
+    IndexBuffer(const uint16_t* indices, uint32_t count);
+    // indices may be null to allocate storage for count indices of the given type
+    IndexBuffer(const void* indices, uint32_t count, IndexType type,
+                MemoryTag tag = MemoryTag::Meshes);
     ~IndexBuffer();
 
     void Bind() const;
@@ -103,10 +130,50 @@ class IndexBuffer {
     uint32_t GetCount() const {
         return count_;
     }
+    uint32_t GetRendererId() const {
+        return rendererId_;
+    }
+    IndexType GetIndexType() const {
+        return type_;
+    }
 
   private:
     uint32_t rendererId_;
     uint32_t count_;
+    IndexType type_;
+    MemoryAllocation memory_;
+};
+
+// Texture Buffer
+// Buffer object exposed to shaders as a samplerBuffer/usamplerBuffer (GL 3.1+)
+class TextureBuffer {
+  public:
+    TextureBuffer(uint32_t internalFormat, MemoryTag tag = MemoryTag::Renderer);
+    ~TextureBuffer();
+
+    TextureBuffer(const TextureBuffer&) = delete;
+    TextureBuffer& operator=(const TextureBuffer&) = delete;
+
+    // Replaces the whole contents; storage grows as needed and is orphaned every call
+    void SetData(const void* data, uint32_t size);
+
+    // For persistent contents: Reserve reallocates (discarding data) only when growing,
+    // SetSubData then updates a byte range in place
+    void Reserve(uint32_t size);
+    void SetSubData(const void* data, uint32_t size, uint32_t offset);
+
+    void BindTexture(uint32_t slot) const;
+
+    uint32_t GetCapacity() const {
+        return capacity_;
+    }
+
+  private:
+    uint32_t bufferId_ = 0;
+    uint32_t textureId_ = 0;
+    uint32_t internalFormat_ = 0;
+    uint32_t capacity_ = 0;
+    MemoryAllocation memory_;
 };
 
 } // namespace se
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "engine/renderer/Buffer.h"
+#include "engine/renderer/RenderCommand.h"
+#include <cstdint>
+#include <vector>
+
+namespace se {
+
+class Material;
+class VertexArray;
+
+enum class CommandType : uint8_t { BindPipeline, BindVertexArray, SetDrawData, DrawIndexed };
+
+// One recorded command. Packets only hold engine objects and plain values; what they turn
+// into is up to the backend replaying them.
+struct CommandPacket {
+    struct PipelineData {
+        const Material* Material;
+        BlendMode Blend;
+    };
+
+    struct VertexArrayData {
+        const VertexArray* VertexArray;
+    };
+
+    struct DrawData {
+        uint32_t ObjectIndex;
+        uint32_t ObjectId;
+        uint32_t OcclusionQuery; // wrapped around the next draw when not 0
+        bool ReceiveShadows;
+    };
+
+    struct IndexedData {
+        uint32_t IndexCount;
+        uint32_t FirstIndex;
+        int32_t BaseVertex;
+        IndexType Type;
+    };
+
+    CommandType Type;
+    union {
+        PipelineData Pipeline;
+        VertexArrayData Vertices;
+        DrawData Draw;
+        IndexedData Indexed;
+    };
+};
+
+// Packets recorded by one thread. A buffer skips binds that repeat its own previous state,
+// so every buffer is self-contained and buffers recorded in parallel replay in any grouping.
+class CommandBuffer {
+  public:
+    void Clear();
+
+    void BindPipeline(const Material* material, BlendMode blend);
+    void BindVertexArray(const VertexArray* vertexArray);
+    void SetDrawData(uint32_t objectIndex, uint32_t objectId, uint32_t occlusionQuery,
+                     bool receiveShadows);
+    void DrawIndexed(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex,
+                     IndexType type);
+    // Binds the vertex array and draws all of its indices
+    void Draw(const VertexArray* vertexArray);
+
+    const std::vector<CommandPacket>& GetPackets() const {
+        return packets_;
+    }
+
+  private:
+    std::vector<CommandPacket> packets_;
+    const Material* material_ = nullptr;
+    BlendMode blend_ = BlendMode::Opaque;
+    const void* vertexBinding_ = nullptr;
+};
+
+} // namespace se
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glm.hpp>
+
+namespace se {
+
+struct AABB {
+    glm::vec3 Min{1e30f};
+    glm::vec3 Max{-1e30f};
+
+    bool IsValid() const {
+        return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z;
+    }
+
+    glm::vec3 GetCenter() const {
+        return (Min + Max) * 0.5f;
+    }
+    glm::vec3 GetExtents() const {
+        return (Max - Min) * 0.5f;
+    }
+
+    void Expand(const glm::vec3& point) {
+        Min = glm::min(Min, point);
+        Max = glm::max(Max, point);
+    }
+
+    // Bounds of the transformed box (not the tightest bounds of the transformed mesh)
+    AABB Transformed(const glm::mat4& transform) const;
+};
+
+// Six inward-facing planes (ax + by + cz + d >= 0 inside), extracted from a view-projection
+// matrix: left, right, bottom, top, near, far
+struct Frustum {
+    glm::vec4 Planes[6];
+
+    static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+    // Conservative: boxes crossing a frustum corner may pass. The GPU culling shader uses the
+    // same center/extents test, keep them in sync.
+    bool Intersects(const glm::vec3& center, const glm::vec3& extents) const;
+    bool Intersects(const AABB& box) const {
+        return Intersects(box.GetCenter(), box.GetExtents());
+    }
+};
+
+} // namespace se
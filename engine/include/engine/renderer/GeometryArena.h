@@ -0,0 +1,126 @@
+#pragma once
+
+#include "engine/renderer/Buffer.h"
+#include "engine/renderer/VertexArray.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace se {
+
+// First-fit free-list allocator over [0, capacity). Adjacent free blocks are merged on Free.
+class RangeAllocator {
+  public:
+    static constexpr uint32_t kInvalidOffset = ~0u;
+
+    explicit RangeAllocator(uint32_t capacity = 0);
+
+    // Returns kInvalidOffset when no free block is large enough
+    uint32_t Allocate(uint32_t size);
+    void Free(uint32_t offset, uint32_t size);
+
+    // Adds [oldCapacity, newCapacity) as free space
+    void Grow(uint32_t newCapacity);
+    // Marks [0, usedSize) as allocated and everything after it as free
+    void Reset(uint32_t usedSize);
+
+    uint32_t GetCapacity() const {
+        return capacity_;
+    }
+    uint32_t GetFreeSize() const {
+        return freeSize_;
+    }
+    uint32_t GetLargestFreeBlock() const;
+
+  private:
+    struct Block {
+        uint32_t Offset;
+        uint32_t Size;
+    };
+
+    std::vector<Block> freeBlocks_; // sorted by offset
+    uint32_t capacity_ = 0;
+    uint32_t freeSize_ = 0;
+};
+
+// Shared vertex and index storage for every mesh with the same vertex layout, so they can be
+// drawn from one VAO with glDrawElementsBaseVertex or a single multi-draw call.
+class GeometryArena {
+  public:
+    using AllocationId = uint32_t;
+    static constexpr AllocationId kInvalidAllocation = ~0u;
+
+    struct Range {
+        int32_t BaseVertex = 0;
+        uint32_t FirstIndex = 0;
+        uint32_t VertexCount = 0;
+        uint32_t IndexCount = 0;
+    };
+
+    // 16-bit arenas hold meshes of up to 65536 vertices each (indices are relative to the
+    // allocation, so the arena itself may be larger)
+    GeometryArena(const BufferLayout& layout, uint32_t vertexCapacity, uint32_t indexCapacity,
+                  IndexType indexType = IndexType::UInt32);
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // Indices are relative to the allocation's first vertex; they are narrowed to the arena's
+    // index type, kInvalidAllocation if they don't fit
+    AllocationId Allocate(const void* vertices, uint32_t vertexCount, const uint32_t* indices,
+                          uint32_t indexCount);
+    void Free(AllocationId allocation);
+
+    const Range& GetRange(AllocationId allocation) const {
+        return allocations_[allocation].Extent;
+    }
+
+    // Packs all live allocations at the start of the buffers. Allocation ids stay valid.
+    void Defragment();
+
+    // 0 when all free space is one block, approaching 1 as it gets split up
+    float GetFragmentation() const;
+
+    void Bind() const;
+
+    const BufferLayout& GetLayout() const {
+        return layout_;
+    }
+    IndexType GetIndexType() const {
+        return indexType_;
+    }
+    uint32_t GetVertexCapacity() const {
+        return vertexAllocator_.GetCapacity();
+    }
+    uint32_t GetIndexCapacity() const {
+        return indexAllocator_.GetCapacity();
+    }
+
+  private:
+    struct Allocation {
+        Range Extent;
+        bool Live = false;
+    };
+
+    // Moves the contents into new buffers; compact packs live allocations at the start
+    void Reallocate(uint32_t vertexCapacity, uint32_t indexCapacity, bool compact);
+
+  private:
+    BufferLayout layout_;
+    IndexType indexType_;
+    std::unique_ptr<VertexArray> vertexArray_;
+    std::shared_ptr<VertexBuffer> vertexBuffer_;
+    std::shared_ptr<IndexBuffer> indexBuffer_;
+
+    RangeAllocator vertexAllocator_;
+    RangeAllocator indexAllocator_;
+
+    std::vector<Allocation> allocations_;
+    std::vector<AllocationId> freeIds_;
+
+    // Size of the current GL buffers, reported to the metrics
+    uint64_t bufferBytes_ = 0;
+};
+
+} // namespace se
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "engine/renderer/Frustum.h"
+#include <cstdint>
+
+namespace se {
+
+class GpuScene;
+class IndirectDrawList;
+
+// Frustum culls indirect draw commands in a compute shader (assets/shaders/cull.comp). Each
+// command is tested against its object's world bounds from the GpuScene and the survivors are
+// written to the list's culled command buffer, packed per batch with atomic counters when the
+// draw count can be read from a buffer (see IndirectDrawList::SupportsDrawCount).
+//
+// The CPU cost is one dispatch per command range, independent of the number of objects.
+class GpuCuller {
+  public:
+    // Needs GL 4.3 compute shaders and storage buffers
+    static bool IsSupported();
+
+    GpuCuller();
+    ~GpuCuller();
+
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    // False when the shader failed to load or compile
+    bool IsValid() const {
+        return program_ != 0;
+    }
+
+    // Culls commands [firstCommand, firstCommand + commandCount) of an uploaded list. Expects
+    // the GpuScene textures to be bound.
+    void Cull(const IndirectDrawList& list, uint32_t firstCommand, uint32_t commandCount,
+              const Frustum& frustum) const;
+
+    // Makes the culled commands visible to indirect draws, call once after all Cull calls
+    void Finish() const;
+
+    // Reads the culled commands back (stalls) and compares them with Frustum::Intersects on the
+    // CPU copy of the bounds. Returns the number of commands the GPU culled; mismatches are
+    // logged. Debug aid, not meant to run every frame.
+    uint32_t Validate(const IndirectDrawList& list, uint32_t firstCommand, uint32_t commandCount,
+                      const Frustum& frustum, const GpuScene& objects) const;
+
+  private:
+    uint32_t program_ = 0;
+    int planesLocation_ = -1;
+    int firstCommandLocation_ = -1;
+    int commandCountLocation_ = -1;
+    int compactLocation_ = -1;
+    int boundsLocation_ = -1;
+};
+
+} // namespace se
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace se {
+
+struct GpuPassStats {
+    // Owned by the profiler, valid until GpuProfiler::Shutdown
+    const char* Name = nullptr;
+    // GPU time over the last GpuProfiler::kHistoryFrames frames the pass ran in
+    float AverageMs = 0.0f;
+    float P50Ms = 0.0f;
+    float P95Ms = 0.0f;
+    float P99Ms = 0.0f;
+    // Averages per frame. Samples stay 0 for passes that run their own occlusion queries.
+    uint64_t Primitives = 0;
+    uint64_t Samples = 0;
+};
+
+// Per-pass GPU time, primitive and sample counts from GL queries. Each frame's queries go into
+// one of kFrameLatency slots and are read back when the slot comes around again, so results are
+// a few frames late and never stall. A frame whose slot is still in flight isn't measured.
+//
+// Scopes can't nest: GL allows one active query per target. All calls need the GL context.
+class GpuProfiler {
+  public:
+    static constexpr uint32_t kFrameLatency = 4;
+    static constexpr uint32_t kHistoryFrames = 120;
+
+    static void Init();
+    static void Shutdown();
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    // Closes the previous frame and reads back every finished one
+    static void BeginFrame();
+
+    // countSamples = false for passes that use occlusion queries themselves, the targets
+    // exclude each other. The name is copied the first time it is seen.
+    static void BeginScope(const char* name, bool countSamples = true);
+    static void EndScope();
+
+    // Fills passes in place, reusing its capacity
+    static void GetPassStats(std::vector<GpuPassStats>& passes);
+    // Frames not measured because their query slot was still in flight
+    static uint64_t GetSkippedFrames();
+
+  private:
+    GpuProfiler() = delete;
+};
+
+class GpuProfileScope {
+  public:
+    explicit GpuProfileScope(const char* name, bool countSamples = true) {
+        GpuProfiler::BeginScope(name, countSamples);
+    }
+    ~GpuProfileScope() {
+        GpuProfiler::EndScope();
+    }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+};
+
+} // namespace se
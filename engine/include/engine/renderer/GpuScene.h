@@ -0,0 +1,99 @@
+#pragma once
+
+#include "engine/renderer/Buffer.h"
+#include "engine/renderer/Frustum.h"
+#include <glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace se {
+
+class Shader;
+
+// Persistent per-object data on the GPU (world matrix, normal matrix, material index) in an
+// RGBA32F texture buffer. Objects keep their slot while they are submitted every frame and
+// only entries whose transform or material changed are re-uploaded.
+//
+// Shaders read an object with texelFetch(uObjectData, a_ObjectIndex * 8 + n):
+//   n = 0..3 world matrix columns, 4..6 normal matrix columns, 7.x material index
+// World-space bounds live in a second buffer for culling, 2 texels per object:
+//   center, extents (extents.w < 0 for objects without bounds)
+class GpuScene {
+  public:
+    static constexpr uint32_t kTexelsPerObject = 8;
+    static constexpr uint32_t kObjectDataSlot = 4;
+    static constexpr uint32_t kObjectBoundsSlot = 5;
+    // Vertex attribute carrying the object index (instanced for multi-draw, constant otherwise)
+    static constexpr uint32_t kObjectIndexAttributeLocation = 3;
+
+    GpuScene();
+
+    void BeginFrame();
+
+    // Returns the object's slot, marking it dirty only if its data changed
+    uint32_t UpdateObject(uint64_t key, const glm::mat4& world, uint32_t materialIndex,
+                          const AABB& localBounds = AABB());
+
+    // Frees the slots of objects that were not updated this frame and uploads dirty ranges
+    void Flush();
+
+    void BindTexture() const;
+    void SetUniforms(const Shader& shader) const;
+
+    // Sets the object index for non-instanced draws through the constant attribute value
+    static void SetObjectIndex(uint32_t index);
+
+    // CPU copy of what the GPU sees, for CPU culling and for checking GPU culling results
+    const AABB& GetWorldBounds(uint32_t slot) const {
+        return slotStates_[slot].WorldBounds;
+    }
+
+    uint32_t GetObjectCount() const {
+        return static_cast<uint32_t>(slots_.size());
+    }
+    uint32_t GetUploadedObjectCount() const {
+        return uploadedObjects_;
+    }
+
+  private:
+    struct ObjectData {
+        glm::mat4 World{1.0f};
+        glm::vec4 NormalMatrix[3];
+        glm::vec4 Misc{0.0f}; // x = material index
+    };
+
+    struct ObjectBounds {
+        glm::vec4 Center{0.0f};
+        glm::vec4 Extents{0.0f, 0.0f, 0.0f, -1.0f};
+    };
+
+    struct SlotState {
+        uint64_t Key = 0;
+        AABB LocalBounds;
+        AABB WorldBounds;
+        uint64_t LastFrame = 0;
+        bool Live = false;
+    };
+
+    void MarkDirty(uint32_t slot);
+
+  private:
+    std::vector<ObjectData> objects_; // CPU mirror of the GPU buffer
+    std::vector<ObjectBounds> bounds_;
+    std::vector<SlotState> slotStates_;
+    std::unordered_map<uint64_t, uint32_t> slots_;
+    std::vector<uint32_t> freeSlots_;
+
+    std::vector<uint32_t> dirtySlots_;
+    std::vector<bool> dirtyFlags_;
+    bool fullUpload_ = true;
+
+    uint64_t frame_ = 0;
+    uint32_t uploadedObjects_ = 0;
+
+    std::unique_ptr<TextureBuffer> buffer_;
+    std::unique_ptr<TextureBuffer> boundsBuffer_;
+};
+
+} // namespace se
@@ -11,6 +11,12 @@ class GraphicsContext {
 
     void Init();
     void SwapBuffers();
+
+    // The context is current on one thread at a time: the main thread, or the render thread
+    // while one runs (see RenderThread)
+    void MakeCurrent();
+    void ReleaseCurrent();
+
     GLFWwindow* GetContext() {
         return windowHandle_;
     }
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "engine/MemoryTracker.h"
+#include <cstdint>
+#include <vector>
+
+namespace se {
+
+class GeometryArena;
+class VertexArray;
+
+// Matches the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+    uint32_t Count = 0;
+    uint32_t InstanceCount = 1;
+    uint32_t FirstIndex = 0;
+    int32_t BaseVertex = 0;
+    uint32_t BaseInstance = 0;
+};
+
+// Per-frame list of indirect draw commands plus one GpuScene object index per command. Each
+// command's base instance points at its object index, which the vertex shader reads through
+// an instanced integer attribute, so a whole batch of meshes goes out as one multi-draw call.
+//
+// Commands are grouped in batches (one multi-draw each). GpuCuller can write a culled copy of
+// the commands, which DrawCulled then consumes without the CPU knowing what survived.
+class IndirectDrawList {
+  public:
+    // Per-command data shared by the vertex shader (object index) and the culling shader
+    struct CommandInfo {
+        int32_t ObjectIndex = 0;
+        uint32_t Batch = 0;
+        uint32_t BatchFirstCommand = 0;
+        uint32_t Padding = 0;
+    };
+
+    // Needs GL 4.3 (multi-draw indirect with base instance), the context may be older
+    static bool IsSupported();
+
+    // GL 4.6 draws a GPU-written command count; without it culled commands stay in place and
+    // are skipped with a zero instance count
+    static bool SupportsDrawCount();
+
+    IndirectDrawList();
+    ~IndirectDrawList();
+
+    IndirectDrawList(const IndirectDrawList&) = delete;
+    IndirectDrawList& operator=(const IndirectDrawList&) = delete;
+
+    void Clear();
+
+    // Starts a new batch for the following Add calls and returns its id
+    uint32_t BeginBatch();
+
+    // Returns the command index; the vertex array must live in a geometry arena
+    uint32_t Add(const VertexArray& vertexArray, uint32_t objectIndex);
+
+    // Uploads the commands and resets the culled command counters
+    void Upload();
+
+    // Draws commands [first, first + count), all of which must come from the given arena
+    void Draw(const GeometryArena& arena, uint32_t first, uint32_t count) const;
+
+    // Draws the batch's commands that survived the last GpuCuller pass
+    void DrawCulled(const GeometryArena& arena, uint32_t batch) const;
+
+    uint32_t GetCommandCount() const {
+        return static_cast<uint32_t>(commands_.size());
+    }
+    const DrawElementsIndirectCommand& GetCommand(uint32_t index) const {
+        return commands_[index];
+    }
+    const CommandInfo& GetCommandInfo(uint32_t index) const {
+        return infos_[index];
+    }
+    uint32_t GetBatchCount() const {
+        return static_cast<uint32_t>(batches_.size());
+    }
+
+    uint32_t GetCommandBufferId() const {
+        return commandBufferId_;
+    }
+    uint32_t GetInfoBufferId() const {
+        return infoBufferId_;
+    }
+    uint32_t GetCulledBufferId() const {
+        return culledBufferId_;
+    }
+    uint32_t GetCounterBufferId() const {
+        return counterBufferId_;
+    }
+
+  private:
+    struct BatchRange {
+        uint32_t FirstCommand = 0;
+        uint32_t CommandCount = 0;
+    };
+
+    void BindObjectIndexStream() const;
+
+  private:
+    std::vector<DrawElementsIndirectCommand> commands_;
+    std::vector<CommandInfo> infos_;
+    std::vector<BatchRange> batches_;
+    std::vector<uint32_t> batchCounters_; // uploaded zeroed, counted up by the culling shader
+
+    uint32_t commandBufferId_ = 0;
+    uint32_t infoBufferId_ = 0;
+    uint32_t culledBufferId_ = 0;
+    uint32_t counterBufferId_ = 0;
+    uint32_t commandCapacity_ = 0;
+    uint32_t infoCapacity_ = 0;
+    uint32_t culledCapacity_ = 0;
+    uint32_t counterCapacity_ = 0;
+    MemoryAllocation memory_{MemoryTag::Renderer, MemoryDomain::Gpu};
+};
+
+} // namespace se
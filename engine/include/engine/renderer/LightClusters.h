@@ -0,0 +1,102 @@
+#pragma once
+
+#include "engine/renderer/Buffer.h"
+#include <glm.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace se {
+
+class Shader;
+
+enum class LocalLightType : uint32_t { Point = 0, Spot = 1 };
+
+struct LocalLightData {
+    LocalLightType Type = LocalLightType::Point;
+    glm::vec3 Position{0.0f, 0.0f, 0.0f};
+    glm::vec3 Direction{0.0f, -1.0f, 0.0f};
+    glm::vec3 Color{1.0f, 1.0f, 1.0f};
+    float Intensity = 1.0f;
+    float Range = 10.0f;
+    float InnerConeCos = 0.95f; // spot lights only
+    float OuterConeCos = 0.85f;
+};
+
+// Assigns local lights to a view-space froxel grid (exponential depth slices) on the CPU
+// and uploads the result as texture buffers, so the fragment shader only iterates over the
+// lights that touch its cluster.
+class LightClusterer {
+  public:
+    static constexpr uint32_t kGridX = 16;
+    static constexpr uint32_t kGridY = 9;
+    static constexpr uint32_t kGridZ = 24;
+    static constexpr uint32_t kClusterCount = kGridX * kGridY * kGridZ;
+    static constexpr uint32_t kMaxLightsPerCluster = 128;
+
+    // Texture units used by the light data, cluster ranges and light index list
+    static constexpr uint32_t kLightDataSlot = 1;
+    static constexpr uint32_t kClusterSlot = 2;
+    static constexpr uint32_t kIndexSlot = 3;
+
+    LightClusterer();
+
+    void Build(std::span<const LocalLightData> lights, const glm::mat4& view,
+               const glm::mat4& projection);
+    void Upload();
+
+    void BindTextures() const;
+    void SetUniforms(const Shader& shader, const glm::vec2& viewportSize) const;
+
+    uint32_t GetLightCount() const {
+        return lightCount_;
+    }
+    uint32_t GetAssignmentCount() const {
+        return static_cast<uint32_t>(lightIndices_.size());
+    }
+
+  private:
+    struct ClusterBounds {
+        glm::vec3 Min;
+        glm::vec3 Max;
+    };
+
+    // Structure-of-arrays view-space light spheres, padded to a multiple of 4
+    struct LightSpheres {
+        std::vector<float> X, Y, Z, Radius;
+        std::vector<uint32_t> Index;
+
+        void Clear();
+        void Reserve(uint32_t count);
+        void Push(const glm::vec3& center, float radius, uint32_t index);
+        void Pad();
+        uint32_t Size() const {
+            return static_cast<uint32_t>(Index.size());
+        }
+    };
+
+    void UpdateClusterBounds(const glm::mat4& projection);
+    void AssignSlice(uint32_t slice);
+
+  private:
+    glm::mat4 cachedProjection_{0.0f};
+    float near_ = 0.1f;
+    float far_ = 100.0f;
+    std::vector<ClusterBounds> clusterBounds_;
+
+    LightSpheres lightSpheres_;
+    std::vector<LightSpheres> sliceLights_;
+    uint32_t sliceCapacity_ = 0;
+    std::vector<std::vector<uint32_t>> sliceIndices_;
+
+    std::vector<glm::vec4> lightData_;
+    std::vector<glm::uvec2> clusterRanges_;
+    std::vector<uint32_t> lightIndices_;
+    uint32_t lightCount_ = 0;
+
+    std::unique_ptr<TextureBuffer> lightDataBuffer_;
+    std::unique_ptr<TextureBuffer> clusterBuffer_;
+    std::unique_ptr<TextureBuffer> indexBuffer_;
+};
+
+} // namespace se
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/Shader.h"
+#include "engine/renderer/RenderCommand.h"
 #include <glm.hpp>
 #include <memory>
 #include <string>
@@ -21,12 +22,30 @@ class Material {
     void SetVector4(const std::string& name, const glm::vec4& value);
     void SetMatrix4(const std::string& name, const glm::mat4& value);
 
-    std::shared_ptr<Shader> GetShader() const {
+    const std::shared_ptr<Shader>& GetShader() const {
         return shader_;
     }
 
+    // Unique per material, stored in the GPU object buffer as the material index
+    uint32_t GetId() const {
+        return id_;
+    }
+
+    // Non-opaque materials are drawn in the transparent queue, sorted back-to-front
+    void SetBlendMode(BlendMode mode) {
+        blendMode_ = mode;
+    }
+    BlendMode GetBlendMode() const {
+        return blendMode_;
+    }
+    bool IsTransparent() const {
+        return blendMode_ != BlendMode::Opaque;
+    }
+
   private:
     std::shared_ptr<Shader> shader_;
+    uint32_t id_ = 0;
+    BlendMode blendMode_ = BlendMode::Opaque;
     std::unordered_map<std::string, float> floatUniforms_;
     std::unordered_map<std::string, int> intUniforms_;
     std::unordered_map<std::string, glm::vec3> vec3Uniforms_;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "engine/renderer/Frustum.h"
+#include <glm.hpp>
+#include <vector>
+
+class Mesh;
+
+namespace se {
+
+// Simplified, CPU-side geometry rasterized by the OcclusionCuller. It should be smaller than
+// (inside of) the visible mesh, otherwise objects that peek out behind it get culled.
+struct OccluderMesh {
+    std::vector<glm::vec3> Positions;
+    std::vector<uint32_t> Indices;
+
+    static OccluderMesh CreateBox(const glm::vec3& min, const glm::vec3& max);
+    // Positions are read from the engine's interleaved position/color/normal layout
+    static OccluderMesh FromMesh(const Mesh& mesh);
+};
+
+// Software occlusion culling on the CPU. A few occluders are rasterized into a small depth
+// buffer (binned into tiles that are rasterized in parallel, four pixels at a time with SSE),
+// which is reduced into a max-depth hierarchy. Occludees are tested by comparing the nearest
+// depth of their projected bounds against the coarsest level that covers them.
+//
+// Depth is z/w mapped to [0, 1], cleared to 1. No GPU state is touched.
+class OcclusionCuller {
+  public:
+    static constexpr uint32_t kTileWidth = 32;
+    static constexpr uint32_t kTileHeight = 32;
+
+    // Rounded up to whole tiles
+    explicit OcclusionCuller(uint32_t width = 320, uint32_t height = 192);
+
+    void Resize(uint32_t width, uint32_t height);
+
+    // Clears the depth buffer and drops last frame's occluders
+    void BeginFrame(const glm::mat4& viewProjection);
+
+    // Triangles crossing the near plane are skipped (they only occlude less)
+    void AddOccluder(const OccluderMesh& mesh, const glm::mat4& transform);
+
+    // Bins, rasterizes and builds the depth hierarchy; call before IsVisible
+    void RasterizeOccluders();
+
+    // False only when the box is certainly hidden behind the rasterized occluders
+    bool IsVisible(const AABB& worldBounds) const;
+
+    uint32_t GetWidth() const {
+        return width_;
+    }
+    uint32_t GetHeight() const {
+        return height_;
+    }
+    // Row-major, bottom row first
+    const std::vector<float>& GetDepthBuffer() const {
+        return depth_;
+    }
+    uint32_t GetOccluderTriangleCount() const {
+        return static_cast<uint32_t>(triangles_.size());
+    }
+
+  private:
+    // Screen-space triangle: edge functions A*x + B*y + C >= 0 inside, depth plane
+    struct Triangle {
+        glm::vec3 EdgeA;
+        glm::vec3 EdgeB;
+        glm::vec3 EdgeC;
+        float Depth0 = 0.0f; // depth at the origin
+        float DepthDx = 0.0f;
+        float DepthDy = 0.0f;
+        glm::ivec2 Min;
+        glm::ivec2 Max; // inclusive pixel bounds
+    };
+
+    void SetupTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2);
+    void RasterizeTile(uint32_t tile);
+    void BuildHierarchy();
+
+  private:
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    uint32_t tilesX_ = 0;
+    uint32_t tilesY_ = 0;
+    glm::mat4 viewProjection_{1.0f};
+
+    std::vector<float> depth_;
+    // Max-depth levels, level 0 is half the resolution of depth_
+    std::vector<std::vector<float>> hierarchy_;
+    std::vector<glm::uvec2> hierarchySizes_;
+
+    std::vector<Triangle> triangles_;
+    std::vector<std::vector<uint32_t>> tileBins_;
+    // Clip-space positions of the occluder being added, reused across occluders
+    std::vector<glm::vec4> clip_;
+};
+
+} // namespace se
@@ -5,6 +5,11 @@
 namespace se {
 
 class VertexArray;
+enum class IndexType;
+
+enum class BlendMode { Opaque, AlphaBlend, Additive };
+
+enum class DepthFunc { Less, LessEqual, Equal };
 
 class RenderCommand {
   public:
@@ -14,10 +19,17 @@ class RenderCommand {
     static void Clear();
 
     static void DrawIndexed(const VertexArray* vertexArray, uint32_t indexCount = 0);
+    // From the bound vertex array
+    static void DrawIndexed(uint32_t indexCount, IndexType indexType, uint32_t firstIndex,
+                            int32_t baseVertex);
     static void DrawArrays(const VertexArray* vertexArray, uint32_t vertexCount);
 
     static void SetDepthTest(bool enabled);
     static void SetBlend(bool enabled);
+    static void SetBlendMode(BlendMode mode);
+    static void SetDepthWrite(bool enabled);
+    static void SetDepthFunc(DepthFunc func);
+    static void SetColorWrite(bool enabled);
     static void SetCullFace(bool enabled);
     static void SetWireframe(bool enabled);
 
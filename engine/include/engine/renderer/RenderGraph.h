@@ -0,0 +1,235 @@
+#pragma once
+
+#include "engine/MemoryTracker.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace se {
+
+struct RenderGraphTextureDesc {
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t Format = 0;       // GL internal format
+    bool DepthCompare = false; // sampled through sampler2DShadow
+    MemoryTag Tag = MemoryTag::RenderTargets;
+
+    bool operator==(const RenderGraphTextureDesc& other) const {
+        return Width == other.Width && Height == other.Height && Format == other.Format &&
+               DepthCompare == other.DepthCompare && Tag == other.Tag;
+    }
+};
+
+// How a pass touches a resource; decides the memory barriers between passes
+enum class RenderGraphAccess { RenderTarget, Sampled, Storage, Copy };
+
+// A version of a texture. Every Write returns a new version, so reads name exactly the
+// contents they depend on and the graph can derive the pass order from them.
+using RenderGraphResource = uint32_t;
+constexpr RenderGraphResource kInvalidRenderGraphResource = ~0u;
+
+struct RenderGraphStats {
+    uint32_t Passes = 0;
+    uint32_t CulledPasses = 0;
+    uint32_t TransientTextures = 0; // requested by passes this frame
+    uint32_t PooledTextures = 0;    // actually allocated, shared by non-overlapping lifetimes
+    uint32_t Barriers = 0;
+};
+
+// Per-frame graph of render passes. Passes declare what they read and write; Compile culls
+// passes whose output nobody reads, orders the rest by their dependencies and assigns pooled
+// textures to transient resources, reusing a texture as soon as its previous user is done.
+// Execute binds each pass's render targets and issues the barriers storage writes need.
+//
+// The pool outlives the frame; textures it hasn't handed out for a while are deleted, so
+// memory follows what recent frames needed instead of growing with every pass ever added.
+// Everything else (passes, resources, callbacks) lives in the frame arena and is rebuilt
+// without touching the heap. Pass and texture names must be string literals.
+class RenderGraph {
+  public:
+    class Builder {
+      public:
+        RenderGraphResource Create(const char* name, const RenderGraphTextureDesc& desc);
+        RenderGraphResource Read(RenderGraphResource resource,
+                                 RenderGraphAccess access = RenderGraphAccess::Sampled);
+        // resource must be the latest version; returns the new one
+        RenderGraphResource Write(RenderGraphResource resource,
+                                  RenderGraphAccess access = RenderGraphAccess::RenderTarget);
+        // The pass has effects outside the graph and is never culled
+        void SideEffect();
+        // The pass issues occlusion queries, so the profiler can't count its samples
+        void UsesOcclusionQueries();
+
+      private:
+        friend class RenderGraph;
+        Builder(RenderGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+
+        RenderGraph& graph_;
+        uint32_t pass_;
+    };
+
+    class Context {
+      public:
+        // GL texture name, 0 for the backbuffer
+        uint32_t GetTexture(RenderGraphResource resource) const;
+        // Framebuffer with only this texture attached (e.g. as a blit source)
+        uint32_t GetFramebuffer(RenderGraphResource resource) const;
+        const RenderGraphTextureDesc& GetDesc(RenderGraphResource resource) const;
+
+      private:
+        friend class RenderGraph;
+        explicit Context(RenderGraph& graph) : graph_(graph) {}
+
+        RenderGraph& graph_;
+    };
+
+    RenderGraph() = default;
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // Starts a new frame in the current frame arena, dropping last frame's passes and
+    // resources; pooled textures are kept. Call it before adding anything.
+    void Reset();
+
+    // setup declares the pass's resources right away. execute is copied into the frame arena,
+    // which never runs destructors, so it may only capture trivially destructible values.
+    template <typename SetupFn, typename ExecuteFn>
+    void AddPass(const char* name, SetupFn&& setup, ExecuteFn&& execute) {
+        using Callback = std::decay_t<ExecuteFn>;
+        static_assert(std::is_trivially_destructible_v<Callback>,
+                      "Render pass callbacks live in the frame arena and are never destroyed");
+        const Callback* callback = new (AllocateCallback(sizeof(Callback), alignof(Callback)))
+            Callback(std::forward<ExecuteFn>(execute));
+        Builder builder(*this, BeginPass(name, callback,
+                                         [](const void* data, const Context& context) {
+                                             (*static_cast<const Callback*>(data))(context);
+                                         }));
+        setup(builder);
+    }
+
+    // Textures owned elsewhere (persistent across frames); passes writing them are kept.
+    // framebuffer, if the owner has one with only this texture attached, is used instead of
+    // creating one every frame.
+    RenderGraphResource ImportTexture(const char* name, uint32_t texture,
+                                      const RenderGraphTextureDesc& desc,
+                                      uint32_t framebuffer = 0);
+    RenderGraphResource ImportBackbuffer();
+
+    void Compile();
+    void Execute();
+
+    // Deletes every pooled texture and framebuffer
+    void ReleasePool();
+
+    const RenderGraphStats& GetStats() const {
+        return stats_;
+    }
+
+  private:
+    using ExecuteThunk = void (*)(const void* callback, const Context& context);
+
+    struct TextureNode {
+        const char* Name = nullptr;
+        RenderGraphTextureDesc Desc;
+        uint32_t Texture = 0;
+        uint32_t Framebuffer = 0; // imported
+        bool Imported = false;
+        bool Backbuffer = false;
+        uint32_t FirstUse = ~0u; // positions in the execution order
+        uint32_t LastUse = 0;
+        uint32_t LatestVersion = 0;
+    };
+
+    struct ResourceVersion {
+        explicit ResourceVersion(std::pmr::memory_resource* memory) : Readers(memory) {}
+
+        uint32_t TextureNode = 0;
+        uint32_t Producer = ~0u;
+        RenderGraphAccess ProducerAccess = RenderGraphAccess::RenderTarget;
+        std::pmr::vector<uint32_t> Readers;
+        uint32_t ReaderCount = 0; // readers not culled
+    };
+
+    struct Access {
+        RenderGraphResource Resource;
+        RenderGraphAccess Type;
+    };
+
+    struct Pass {
+        explicit Pass(std::pmr::memory_resource* memory) : Reads(memory), Writes(memory) {}
+
+        const char* Name = nullptr;
+        const void* Callback = nullptr;
+        ExecuteThunk Execute = nullptr;
+        std::pmr::vector<Access> Reads;
+        std::pmr::vector<Access> Writes;
+        bool SideEffect = false;
+        bool OcclusionQueries = false;
+        bool Culled = false;
+        uint32_t RefCount = 0;
+    };
+
+    struct PooledTexture {
+        RenderGraphTextureDesc Desc;
+        uint32_t Texture = 0;
+        uint64_t LastUsedFrame = 0;
+        bool InUse = false;
+        MemoryAllocation Memory;
+    };
+
+    struct CachedFramebuffer {
+        std::vector<uint32_t> Attachments;
+        uint32_t Framebuffer = 0;
+        // Imported textures may be deleted and their names reused, so framebuffers that
+        // reference them only live for one frame
+        bool FrameOnly = false;
+    };
+
+    // One frame's graph, allocated in the frame arena along with everything it points to.
+    // Never destroyed: the arena reclaims it all at once.
+    struct FrameGraph {
+        explicit FrameGraph(std::pmr::memory_resource* memory)
+            : Memory(memory), Passes(memory), Textures(memory), Versions(memory), Order(memory) {}
+
+        std::pmr::memory_resource* Memory;
+        std::pmr::vector<Pass> Passes;
+        std::pmr::vector<TextureNode> Textures;
+        std::pmr::vector<ResourceVersion> Versions;
+        std::pmr::vector<uint32_t> Order;
+    };
+
+    uint32_t BeginPass(const char* name, const void* callback, ExecuteThunk execute);
+    void* AllocateCallback(size_t size, size_t alignment);
+    RenderGraphResource AddVersion(uint32_t textureNode, uint32_t producer,
+                                   RenderGraphAccess access);
+    void CullPasses();
+    void SortPasses();
+    void ComputeLifetimes();
+
+    uint32_t AcquireTexture(const RenderGraphTextureDesc& desc);
+    void ReleaseTexture(uint32_t texture);
+    void PurgePool();
+    // Attachment order: colors in declaration order, a depth texture anywhere
+    uint32_t GetFramebuffer(std::span<const uint32_t> textureNodes);
+    void DeleteFramebuffersUsing(uint32_t texture);
+    void BindRenderTargets(const Pass& pass, uint32_t backbuffer, const int* backbufferViewport);
+    void IssueBarriers(const Pass& pass);
+
+    FrameGraph* current_ = nullptr;
+    bool compiled_ = false;
+
+    std::vector<PooledTexture> pool_;
+    std::vector<CachedFramebuffer> framebuffers_;
+    uint64_t frame_ = 0;
+
+    RenderGraphStats stats_;
+};
+
+} // namespace se
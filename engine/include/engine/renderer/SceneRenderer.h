@@ -1,23 +1,90 @@
 #pragma once
 
 #include "engine/Camera.h"
+#include "engine/renderer/CommandBuffer.h"
+#include "engine/renderer/GpuCuller.h"
+#include "engine/renderer/GpuProfiler.h"
+#include "engine/renderer/GpuScene.h"
+#include "engine/renderer/IndirectDraw.h"
+#include "engine/renderer/LightClusters.h"
 #include "engine/renderer/Material.h"
+#include "engine/renderer/RenderGraph.h"
 #include "engine/renderer/VertexArray.h"
+#include "engine/resources/ResourceHandle.h"
+#include <array>
 #include <glm.hpp>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 namespace se {
 struct RenderStats {
     uint32_t DrawCalls = 0;
     uint32_t TriangleCount = 0;
+    uint32_t ShadowDrawCalls = 0;
+    uint32_t StaticShadowRebuilds = 0;
+    uint32_t LocalLights = 0;
+    uint32_t LightClusterAssignments = 0;
+    uint32_t DepthPrepassDrawCalls = 0;
+    // Meshes drawn through multi-draw indirect batches (each batch counts as one draw call)
+    uint32_t IndirectCommands = 0;
+    // Objects whose GPU data was (re)written this frame
+    uint32_t ObjectUploads = 0;
+    // Objects outside the camera frustum. GPU culling results only show up here when validated.
+    uint32_t CulledObjects = 0;
+    bool GpuCullingActive = false;
+    // Hardware occlusion queries: issued this frame, objects drawn under conditional rendering
+    // (hidden last frame), and results not ready when polled (each would have stalled the CPU)
+    uint32_t OcclusionQueries = 0;
+    uint32_t ConditionalDraws = 0;
+    uint32_t OcclusionResultsPending = 0;
+    bool DepthPrepassActive = false;
+    // Shaded opaque fragments per visible pixel, averaged over the last frames
+    float Overdraw = 0.0f;
+    // Per-draw command packets recorded by the workers for the queued draws
+    uint32_t CommandPackets = 0;
+    RenderGraphStats RenderGraph;
+    // Rolling GPU timings per pass, a few frames old
+    std::vector<GpuPassStats> GpuPasses;
 
     void Reset() {
         DrawCalls = 0;
         TriangleCount = 0;
+        ShadowDrawCalls = 0;
+        StaticShadowRebuilds = 0;
+        LocalLights = 0;
+        LightClusterAssignments = 0;
+        DepthPrepassDrawCalls = 0;
+        IndirectCommands = 0;
+        ObjectUploads = 0;
+        CulledObjects = 0;
+        GpuCullingActive = false;
+        OcclusionQueries = 0;
+        ConditionalDraws = 0;
+        OcclusionResultsPending = 0;
+        DepthPrepassActive = false;
+        Overdraw = 0.0f;
+        CommandPackets = 0;
+        RenderGraph = RenderGraphStats();
+        GpuPasses.clear();
     }
 };
 
+// Shadow map filtering, from cheapest to smoothest
+enum class ShadowFilterMode { Hardware1Tap = 0, PCF4Tap, Poisson8, Poisson16 };
+
+enum class ShadowDepthFormat { Depth16, Depth24, Depth32F };
+
+// Auto turns the pre-pass on when measured overdraw makes shading the hidden fragments
+// more expensive than drawing the opaque geometry twice
+enum class DepthPrepassMode { Off, On, Auto };
+
+// BeginScene, Submit and the setters only record; EndScene hands the recorded frame to
+// RenderThread::Submit, which draws it right away or on the render thread. Settings take
+// effect with the next frame drawn.
 class SceneRenderer {
   public:
     static void Init();
@@ -28,10 +95,23 @@ class SceneRenderer {
 
     static void EndScene();
 
-    static void Submit(const std::shared_ptr<VertexArray>& vertexArray,
-                       const std::shared_ptr<Material>& material,
+    static constexpr uint32_t kTransientObjectId = ~0u;
+
+    // objectId keeps the object's slot in the GPU scene buffer stable across frames (e.g. the
+    // entity id), so its data is only re-uploaded when it changes. Without a material the mesh
+    // is only drawn into the shadow maps (e.g. occluded from the camera). lod picks one of the
+    // mesh's levels of detail, 0 being the mesh itself. Stale handles drop the draw.
+    static void Submit(MeshHandle mesh, MaterialHandle material,
                        const glm::mat4& transform = glm::mat4(1.0f), bool castsShadows = true,
-                       bool receiveShadows = true);
+                       bool receiveShadows = true, bool isStatic = false,
+                       uint32_t objectId = kTransientObjectId, uint32_t lod = 0);
+
+    // Same, for callers that already resolved the handles: vertexArray is the level of detail
+    // to draw. Both must come from MeshManager and MaterialManager, whose deferred release
+    // keeps them alive while the frame is in flight.
+    static void Submit(const VertexArray& vertexArray, const Material* material,
+                       const glm::mat4& transform, bool castsShadows, bool receiveShadows,
+                       bool isStatic, uint32_t objectId);
 
     struct DirectionalLightData {
         glm::vec3 Direction{0.0f, -1.0f, 0.0f};
@@ -48,48 +128,256 @@ class SceneRenderer {
 
     static DirectionalLightData GetDirectionalLight();
 
-    static RenderStats GetStats() {
-        return stats_;
-    }
+    // Point and spot lights, cleared by BeginScene
+    static void SubmitLocalLight(const LocalLightData& light);
 
-    static void ResetStats() {
-        stats_.Reset();
-    }
+    struct ShadowSettings {
+        uint32_t Resolution = 1024;
+        ShadowDepthFormat DepthFormat = ShadowDepthFormat::Depth24;
+        ShadowFilterMode FilterMode = ShadowFilterMode::PCF4Tap;
+    };
+
+    // Changing resolution or depth format recreates the shadow maps
+    static void SetShadowSettings(const ShadowSettings& settings);
+
+    static ShadowSettings GetShadowSettings();
+
+    // Forces the cached static shadow map to be rebuilt on the next frame. Static submissions
+    // are not compared between frames, so this has to be called whenever they change.
+    static void InvalidateStaticShadows();
+
+    static void SetDepthPrepassMode(DepthPrepassMode mode);
+
+    static DepthPrepassMode GetDepthPrepassMode();
+
+    struct CullingSettings {
+        bool FrustumCulling = true;
+        // Cull multi-draw batches in a compute shader, falls back to the CPU when unsupported
+        bool GpuCulling = true;
+        // Read GPU culling results back and compare them with the CPU test (slow)
+        bool ValidateGpuCulling = false;
+        // Occlusion queries on opaque meshes with at least this many triangles. Results are
+        // used a frame late; hidden meshes are drawn last under conditional rendering.
+        bool OcclusionQueries = false;
+        uint32_t OcclusionQueryMinTriangles = 500;
+    };
+
+    static void SetCullingSettings(const CullingSettings& settings);
+
+    static CullingSettings GetCullingSettings();
+
+    // Stats of the last frame drawn
+    static RenderStats GetStats();
+
+    static void ResetStats();
 
   private:
+    // Pointers are resolved from handles while recording; pooled resources outlive the
+    // frames in flight
     struct Submission {
-        std::shared_ptr<VertexArray> VertexArray;
-        std::shared_ptr<Material> Material;
+        const VertexArray* VertexArray = nullptr;
+        const Material* Material = nullptr;
         glm::mat4 Transform{1.0f};
         bool CastsShadows = true;
         bool ReceiveShadows = true;
+        bool IsStatic = false;
+        uint32_t ObjectId = kTransientObjectId;
+        uint32_t ObjectIndex = 0; // slot in the GPU scene buffer, assigned in EndScene
+        unsigned int OcclusionQuery = 0; // wrapped around the lit draw when set
+    };
+
+    // Per-object occlusion query history, keyed by object id
+    struct OcclusionState {
+        unsigned int Query = 0;
+        uint64_t LastFrame = 0;
+        bool Visible = true;
+        bool Pending = false;
+    };
+
+    struct QueueEntry {
+        uint32_t SubmissionIndex = 0;
+        float DistanceSq = 0.0f;
+    };
+
+    // Where a submission goes, decided in parallel before the queues are built
+    enum class QueueClass : uint8_t { Skipped, Culled, Opaque, Transparent, Tracked };
+
+    // Indirect commands sharing an arena (and material, for the lit pass) drawn by one
+    // multi-draw call. Submissions outside any arena get a batch without commands.
+    struct DrawBatch {
+        GeometryArena* Arena = nullptr;
+        uint32_t SubmissionIndex = 0; // first member, provides material and per-draw flags
+        uint32_t ListBatch = 0;       // batch id in the indirect draw list
+        uint32_t FirstCommand = 0;
+        uint32_t CommandCount = 0;
+        uint32_t IndexCount = 0;
+    };
+
+    // Samples-passed queries for one frame, read back a few frames later without stalling
+    struct OverdrawQuery {
+        unsigned int ShadedQuery = 0;  // first depth-tested opaque pass
+        unsigned int VisibleQuery = 0; // main pass after a pre-pass (one sample per pixel)
+        uint64_t ViewportSamples = 0;
+        bool UsedPrepass = false;
+        bool Pending = false;
+    };
+
+    struct FrameSettings {
+        ShadowSettings Shadows;
+        DepthPrepassMode PrepassMode = DepthPrepassMode::Auto;
+        CullingSettings Culling;
+        bool InvalidateStaticShadows = false;
     };
 
+    // Everything the recording thread produces for one frame. The recording copy keeps its
+    // capacity on the heap; what EndScene hands off lives in the frame arena.
+    struct FrameInputs {
+        FrameInputs() = default;
+        explicit FrameInputs(std::pmr::memory_resource* memory)
+            : Submissions(memory), LocalLights(memory) {}
+
+        glm::mat4 ViewMatrix{1.0f};
+        glm::mat4 ProjectionMatrix{1.0f};
+        glm::vec3 CameraPosition{0.0f};
+        DirectionalLightData DirectionalLight;
+        std::pmr::vector<Submission> Submissions;
+        std::pmr::vector<LocalLightData> LocalLights;
+        FrameSettings Settings;
+    };
+
+    // Only Recording is touched by the recording thread, the rest only while drawing
     struct SceneData {
+        FrameInputs Recording;
         glm::mat4 ViewMatrix;
         glm::mat4 ProjectionMatrix;
         glm::mat4 ViewProjectionMatrix;
         DirectionalLightData DirectionalLight;
         glm::mat4 LightSpaceMatrix{1.0f};
         glm::ivec2 ShadowMapSize{1024, 1024};
-        unsigned int ShadowFramebuffer = 0;
-        unsigned int ShadowDepthTexture = 0;
+        ShadowSettings Shadows;
+        // Static casters are rendered once into this map and reused until they change. Frames
+        // with moving casters composite them into a transient copy from the render graph.
+        unsigned int StaticShadowFramebuffer = 0;
+        unsigned int StaticShadowDepthTexture = 0;
+        MemoryAllocation StaticShadowMemory;
+        // Light the static map was rendered from; InvalidateStaticShadows covers the casters
+        glm::mat4 StaticShadowLightSpace{1.0f};
+        bool StaticShadowValid = false;
+        // Texture sampled by the scene pass this frame (static cache or composited map)
+        unsigned int ActiveShadowTexture = 0;
         std::shared_ptr<Shader> ShadowShader;
         float ShadowDistance = 100.0f;
         float ShadowOrthoSize = 10.0f;
         float AmbientStrength = 0.2f;
         bool ShadowsEnabled = true;
-        std::vector<Submission> Submissions;
+        glm::vec3 CameraPosition{0.0f};
+        std::span<Submission> Submissions; // frame being drawn, in the frame arena
+        std::vector<QueueEntry> OpaqueQueue;      // front-to-back, blending off
+        std::vector<QueueEntry> TransparentQueue; // back-to-front, blending on
+        std::vector<QueueEntry> OccludedQueue;    // hidden last frame, drawn conditionally
+        std::vector<QueueClass> QueueClasses;     // per submission
+        std::vector<QueueEntry> QueueEntries;     // per submission
+        // Queue draws recorded in chunks, one buffer per chunk, replayed in order
+        std::vector<CommandBuffer> OpaqueCommands; // unused with multi-draw indirect
+        std::vector<CommandBuffer> TransparentCommands;
+        std::span<const LocalLightData> LocalLights;
+        std::unique_ptr<LightClusterer> LightClusters;
+        std::unique_ptr<GpuScene> Objects;
+        glm::vec2 ViewportSize{1.0f, 1.0f};
+        DepthPrepassMode PrepassMode = DepthPrepassMode::Auto;
+        bool AutoPrepassEnabled = false;
+        uint32_t FramesSincePrepassProbe = 0;
+        std::array<OverdrawQuery, 3> OverdrawQueries;
+        uint32_t OverdrawQueryIndex = 0;
+        float Overdraw = 1.0f;
+        float Coverage = 1.0f; // visible fraction of the viewport, refreshed by pre-pass frames
+        bool MultiDrawIndirect = false;
+        std::unique_ptr<IndirectDrawList> IndirectDraws;
+        std::vector<DrawBatch> OpaqueBatches;
+        std::vector<DrawBatch> PrepassBatches;
+        std::vector<DrawBatch> StaticShadowBatches;
+        std::vector<DrawBatch> DynamicShadowBatches;
+        // Indirect command ranges: [0, opaque) lit pass, [opaque, camera) pre-pass, rest shadows
+        uint32_t OpaqueCommandCount = 0;
+        uint32_t CameraCommandCount = 0;
+        CullingSettings Culling;
+        std::unique_ptr<GpuCuller> Culler;
+        bool GpuCullingActive = false;
+        Frustum CameraFrustum;
+        Frustum LightFrustum;
+        uint64_t FrameIndex = 0;
+        std::unordered_map<uint32_t, OcclusionState> OcclusionStates;
+        unsigned int OcclusionQueryTarget = 0;
+        std::shared_ptr<Shader> BoundingBoxShader;
+        std::shared_ptr<VertexArray> BoundingBoxMesh; // unit cube
+        std::unique_ptr<RenderGraph> Graph;
     };
 
     static SceneData* sceneData_;
     static RenderStats stats_;
+    static RenderStats publishedStats_;
+    static std::mutex statsMutex_;
+
+    static void RenderFrame(FrameInputs& frame);
+
+    static void ApplyFrameSettings(const FrameSettings& settings);
+
+    static void PrepareLighting();
 
     static void InitializeShadowResources();
 
     static void DestroyShadowResources();
 
-    static void RenderShadowPass();
+    // Returns the shadow map the scene pass should sample
+    static RenderGraphResource AddShadowPasses(RenderGraph& graph);
+
+    static void RenderShadowCasters(bool staticCasters);
+
+    static void DrawShadowCasters(bool staticCasters);
+
+    static void UpdateGpuScene();
+
+    static void BuildRenderQueues();
+
+    static void BuildDrawBatches();
+
+    static void RecordDrawCommands();
+
+    // bindPipelines = false draws depth only, with whatever shader is bound
+    static void ExecuteCommands(const std::vector<CommandBuffer>& buffers, bool bindPipelines,
+                                uint32_t& drawCalls);
+
+    static void AppendDrawBatches(std::span<const uint32_t> submissionIndices,
+                                  bool splitByMaterial, const Frustum& frustum,
+                                  std::vector<DrawBatch>& batches);
+
+    static bool IsVisible(const Submission& submission, const Frustum& frustum);
+
+    static bool UseCpuCulling();
+
+    static void CullDrawCommands();
+
+    static void DrawIndirectBatch(const DrawBatch& batch);
+
+    static bool TracksOcclusion(const Submission& submission);
+
+    static OcclusionState& PollOcclusionState(uint32_t objectId);
+
+    static void RenderOccludedQueue();
+
+    static void DrawDepthBatches(const std::vector<DrawBatch>& batches, uint32_t& drawCalls);
+
+    static void ApplySceneUniforms(const Shader& shader);
+
+    static void DrawSubmission(const Submission& submission);
+
+    static void DrawLitBatch(const DrawBatch& batch);
+
+    static void ResolveOverdrawQueries();
+
+    static bool ShouldUseDepthPrepass();
+
+    static void RenderDepthPrepass();
 
     static void RenderScenePass();
 };
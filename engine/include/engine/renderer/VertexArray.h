@@ -1,16 +1,24 @@
 #pragma once
 
 #include "engine/renderer/Buffer.h"
+#include "engine/renderer/Frustum.h"
 #include <memory>
 #include <vector>
 
 namespace se {
 
+class GeometryArena;
+
 class VertexArray {
   public:
     VertexArray();
+    // View into a shared geometry arena; frees the allocation on destruction
+    VertexArray(const std::shared_ptr<GeometryArena>& arena, uint32_t allocation);
     ~VertexArray();
 
+    VertexArray(const VertexArray&) = delete;
+    VertexArray& operator=(const VertexArray&) = delete;
+
     void Bind() const;
     void Unbind() const;
 
@@ -24,11 +32,50 @@ class VertexArray {
         return indexBuffer_;
     }
 
+    uint32_t GetIndexCount() const;
+    IndexType GetIndexType() const;
+    // Offsets into the bound buffers, non-zero only for arena views
+    int32_t GetBaseVertex() const;
+    uint32_t GetFirstIndex() const;
+
+    GeometryArena* GetArena() const {
+        return arena_.get();
+    }
+
+    // Object-space bounds used for culling; invalid bounds are never culled
+    void SetBounds(const AABB& bounds) {
+        bounds_ = bounds;
+    }
+    const AABB& GetBounds() const {
+        return bounds_;
+    }
+
+    // Coarser versions of this mesh. Each one is used once the projected size (fraction of
+    // the screen height) drops below its ScreenSize; levels are ordered fine to coarse.
+    struct Lod {
+        std::shared_ptr<VertexArray> Mesh;
+        float ScreenSize = 0.0f;
+    };
+
+    void SetLods(std::vector<Lod> lods) {
+        lods_ = std::move(lods);
+    }
+    const std::vector<Lod>& GetLods() const {
+        return lods_;
+    }
+    // 0 is this mesh, i is GetLods()[i - 1]. Within the hysteresis band around a threshold the
+    // current level is kept, so objects sitting at a boundary don't flicker between levels.
+    uint32_t SelectLod(float screenSize, uint32_t current, float hysteresis) const;
+
   private:
-    uint32_t rendererId_;
+    uint32_t rendererId_ = 0;
+    std::shared_ptr<GeometryArena> arena_;
+    uint32_t allocation_ = 0;
     uint32_t vertexBufferIndex_ = 0;
     std::vector<std::shared_ptr<VertexBuffer>> vertexBuffers_;
     std::shared_ptr<IndexBuffer> indexBuffer_;
+    AABB bounds_;
+    std::vector<Lod> lods_;
 };
 
 } // namespace se
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <glm.hpp>
+#include <gtc/packing.hpp>
+
+namespace se {
+
+// CPU side of the packed ShaderDataTypes in Buffer.h
+
+// Half4 position; w is 1
+inline void PackHalf4(const glm::vec3& value, uint16_t out[4]) {
+    const glm::uvec2 packed = glm::uvec2(glm::packHalf2x16(glm::vec2(value.x, value.y)),
+                                         glm::packHalf2x16(glm::vec2(value.z, 1.0f)));
+    out[0] = static_cast<uint16_t>(packed.x & 0xffff);
+    out[1] = static_cast<uint16_t>(packed.x >> 16);
+    out[2] = static_cast<uint16_t>(packed.y & 0xffff);
+    out[3] = static_cast<uint16_t>(packed.y >> 16);
+}
+
+// Normalized UByte4 color, alpha 1
+inline uint32_t PackColor(const glm::vec3& color) {
+    return glm::packUnorm4x8(glm::vec4(glm::clamp(color, 0.0f, 1.0f), 1.0f));
+}
+
+// Normalized Int2_10_10_10_Rev, w 0
+inline uint32_t PackNormal(const glm::vec3& normal) {
+    const float length = glm::length(normal);
+    const glm::vec3 unit = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    return glm::packSnorm3x10_1x2(glm::vec4(unit, 0.0f));
+}
+
+// Octahedral encoding: the unit sphere folded onto a square, two normalized Short2 components.
+// Better precision per bit than Int2_10_10_10_Rev, but the shader has to decode it:
+//   vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+//   if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+//   n = normalize(n);
+inline glm::vec2 EncodeOctahedral(const glm::vec3& normal) {
+    const float sum = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+    if (sum <= 0.0f)
+        return glm::vec2(0.0f);
+    const glm::vec3 n = normal / sum;
+    if (n.z < 0.0f) {
+        const glm::vec2 sign(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+        return (1.0f - glm::abs(glm::vec2(n.y, n.x))) * sign;
+    }
+    return glm::vec2(n.x, n.y);
+}
+
+inline glm::vec3 DecodeOctahedral(const glm::vec2& encoded) {
+    glm::vec3 n(encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y));
+    if (n.z < 0.0f) {
+        const glm::vec2 sign(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+        const glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * sign;
+        n.x = folded.x;
+        n.y = folded.y;
+    }
+    return glm::normalize(n);
+}
+
+inline uint32_t PackOctahedral(const glm::vec3& normal) {
+    return glm::packSnorm2x16(EncodeOctahedral(normal));
+}
+
+} // namespace se
@@ -2,6 +2,7 @@
 
 #include "engine/Shader.h"
 #include "engine/renderer/Material.h"
+#include "engine/resources/ResourcePool.h"
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -14,15 +15,32 @@ class MaterialManager {
     static void Shutdown();
 
     // Get default material with basic shader
-    static std::shared_ptr<Material> GetDefaultMaterial();
+    static MaterialHandle GetDefaultMaterial();
 
-    // Create a material with custom shader
-    static std::shared_ptr<Material> CreateMaterial(std::shared_ptr<Shader> shader);
+    // Create a material with custom shader. Makes no GL calls; the shader was compiled by
+    // GetShader.
+    static MaterialHandle CreateMaterial(ShaderHandle shader);
 
-    // Get or load a shader (cached)
-    static std::shared_ptr<Shader> GetShader(const std::string& name,
-                                             const std::filesystem::path& vertPath,
-                                             const std::filesystem::path& fragPath);
+    // Get or load a shader (cached). Loading one needs the GL context, see
+    // RenderThread::RequireContext.
+    static ShaderHandle GetShader(const std::string& name, const std::filesystem::path& vertPath,
+                                 const std::filesystem::path& fragPath);
+
+    static MaterialHandle AddMaterial(std::shared_ptr<Material> material);
+    static ShaderHandle AddShader(std::shared_ptr<Shader> shader);
+
+    // Null for stale handles
+    static Material* Get(MaterialHandle material) {
+        return materials_.Get(material);
+    }
+    static Shader* Get(ShaderHandle shader) {
+        return shaders_.Get(shader);
+    }
+
+    // Destroyed once the frames in flight are done with them. Materials keep their shader
+    // alive on their own.
+    static void Release(MaterialHandle material);
+    static void Release(ShaderHandle shader);
 
     // Clear all cached resources
     static void ClearCache();
@@ -32,9 +50,11 @@ class MaterialManager {
 
     static void CreateDefaultShader();
 
-    static std::shared_ptr<Material> defaultMaterial_;
-    static std::shared_ptr<Shader> defaultShader_;
-    static std::unordered_map<std::string, std::shared_ptr<Shader>> shaderCache_;
+    static ResourcePool<Material> materials_;
+    static ResourcePool<Shader> shaders_;
+    static MaterialHandle defaultMaterial_;
+    static ShaderHandle defaultShader_;
+    static std::unordered_map<std::string, ShaderHandle> shaderCache_;
     static bool initialized_;
 };
 
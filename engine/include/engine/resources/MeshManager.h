@@ -1,7 +1,9 @@
 #pragma once
 
 #include "engine/Mesh.h"
+#include "engine/renderer/GeometryArena.h"
 #include "engine/renderer/VertexArray.h"
+#include "engine/resources/ResourcePool.h"
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -17,19 +19,58 @@ class MeshManager {
 
     static void Shutdown();
 
-    // Create a vertex array from a Mesh object
-    static std::shared_ptr<VertexArray> CreateVertexArrayFromMesh(const Mesh& mesh);
+    // Create a vertex array from a Mesh object. generateLods builds a chain of simplified
+    // versions (see VertexArray::GetLods) for meshes that are large enough.
+    static std::shared_ptr<VertexArray> CreateVertexArrayFromMesh(const Mesh& mesh,
+                                                                  bool generateLods = true);
 
-    // Get or create primitive mesh (cached)
-    static std::shared_ptr<VertexArray> GetPrimitive(PrimitiveMeshType type);
+    // Same, owned by the mesh pool
+    static MeshHandle CreateMesh(const Mesh& mesh, bool generateLods = true);
+    static MeshHandle AddMesh(std::shared_ptr<VertexArray> vertexArray);
+    // Null for stale handles
+    static VertexArray* Get(MeshHandle mesh) {
+        return meshes_.Get(mesh);
+    }
+    // Destroyed once the frames in flight are done with it
+    static void Release(MeshHandle mesh);
 
-    // Clear all cached meshes
+    // Get or create primitive mesh (cached). Creating one needs the GL context, see
+    // RenderThread::RequireContext; cache hits are fine from any thread.
+    static MeshHandle GetPrimitive(PrimitiveMeshType type);
+
+    // Clear all cached meshes. Safe while the render thread runs: the meshes go through
+    // RenderThread::DeferRelease.
     static void ClearCache();
 
+    // Shared vertex/index storage for all meshes with this layout and index type
+    static std::shared_ptr<GeometryArena> GetArena(const BufferLayout& layout,
+                                                   IndexType indexType = IndexType::UInt32);
+
+    // Compacts arenas whose free space is badly fragmented; needs the GL context
+    static void DefragmentArenas(float fragmentationThreshold = 0.5f);
+
+    // Reorders indices and vertices for vertex cache reuse, overdraw and fetch locality before
+    // upload (see MeshOptimizer). On by default; affects meshes created afterwards.
+    static void SetMeshOptimization(bool enabled);
+    static bool IsMeshOptimizationEnabled();
+
+    // Uploads meshes with half float positions, 8-bit colors and 10:10:10:2 normals instead
+    // of 9 floats. Meshes of up to 65536 vertices use 16-bit indices either way.
+    static void SetVertexCompression(bool enabled);
+    static bool IsVertexCompressionEnabled();
+
   private:
     static std::shared_ptr<VertexArray> CreatePrimitive(PrimitiveMeshType type);
+    static std::shared_ptr<VertexArray> CreateVertexArray(std::vector<float> vertices,
+                                                          std::vector<uint32_t> indices);
+    static std::vector<VertexArray::Lod> GenerateLods(const std::vector<float>& vertices,
+                                                      const std::vector<uint32_t>& indices);
 
-    static std::unordered_map<PrimitiveMeshType, std::shared_ptr<VertexArray>> primitiveCache_;
+    static ResourcePool<VertexArray> meshes_;
+    static std::unordered_map<PrimitiveMeshType, MeshHandle> primitiveCache_;
+    static std::unordered_map<std::string, std::shared_ptr<GeometryArena>> arenas_;
     static bool initialized_;
+    static bool optimizeMeshes_;
+    static bool compressVertices_;
 };
 } // namespace se
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace se {
+
+// Quadric error metric (Garland-Heckbert) edge collapse on interleaved float vertices whose
+// first three floats are the position. Topology is welded by position, so hard edges and
+// other attribute seams don't tear open; when a seam vertex collapses, each copy moves to the
+// copy of the target with the closest normal.
+class MeshSimplifier {
+  public:
+    MeshSimplifier() = delete;
+
+    struct Result {
+        std::vector<uint32_t> Indices; // into the unchanged vertex array
+        float Error = 0.0f;            // largest collapse error, relative to the mesh extent
+    };
+
+    // Collapses edges until at most targetIndexCount indices remain or the next collapse
+    // would exceed maxError (relative to the mesh extent). normalOffset < 0: no normals.
+    static Result Simplify(const std::vector<float>& vertices, uint32_t floatsPerVertex,
+                           const std::vector<uint32_t>& indices, uint32_t targetIndexCount,
+                           float maxError, int normalOffset = -1);
+
+    // Removes vertices no index refers to and rewrites the indices accordingly
+    static void CompactVertices(std::vector<float>& vertices, uint32_t floatsPerVertex,
+                                std::vector<uint32_t>& indices);
+};
+
+} // namespace se
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace se {
+
+class Material;
+class Shader;
+class VertexArray;
+
+// 32-bit reference to a resource in a ResourcePool: slot index in the low 20 bits, slot
+// generation in the high 12. Releasing a resource bumps the generation of its slot, so old
+// handles go stale instead of resolving to whatever reuses the slot. Generations start at 1,
+// which keeps the null handle (0) from ever matching a slot.
+template <typename T>
+class Handle {
+  public:
+    static constexpr uint32_t kIndexBits = 20;
+    static constexpr uint32_t kMaxIndex = (1u << kIndexBits) - 1;
+    static constexpr uint32_t kMaxGeneration = (1u << (32 - kIndexBits)) - 1;
+
+    constexpr Handle() = default;
+    constexpr Handle(uint32_t index, uint32_t generation)
+        : value_((generation << kIndexBits) | (index & kMaxIndex)) {}
+
+    constexpr uint32_t GetIndex() const {
+        return value_ & kMaxIndex;
+    }
+    constexpr uint32_t GetGeneration() const {
+        return value_ >> kIndexBits;
+    }
+    constexpr uint32_t GetValue() const {
+        return value_;
+    }
+
+    // Non-null; only the pool knows whether it is still live
+    constexpr explicit operator bool() const {
+        return value_ != 0;
+    }
+    constexpr bool operator==(const Handle&) const = default;
+
+  private:
+    uint32_t value_ = 0;
+};
+
+using MeshHandle = Handle<VertexArray>;
+using MaterialHandle = Handle<Material>;
+using ShaderHandle = Handle<Shader>;
+
+} // namespace se
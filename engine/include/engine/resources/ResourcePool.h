@@ -0,0 +1,112 @@
+#pragma once
+
+#include "engine/RenderThread.h"
+#include "engine/resources/ResourceHandle.h"
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace se {
+
+// Owns resources addressed by generational handles. A lookup is a bounds check and a
+// generation compare, without touching reference counts.
+//
+// Main thread only. Work recorded for the render thread carries raw pointers resolved while
+// recording; Release hands the resource to RenderThread::DeferRelease, so those pointers stay
+// valid until the frames that may use them have executed.
+template <typename T>
+class ResourcePool {
+  public:
+    using HandleType = Handle<T>;
+
+    HandleType Add(std::shared_ptr<T> resource) {
+        if (!resource)
+            return {};
+
+        uint32_t index;
+        if (!freeSlots_.empty()) {
+            index = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            if (slots_.size() > HandleType::kMaxIndex)
+                throw std::runtime_error("ResourcePool is out of handles");
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+
+        Slot& slot = slots_[index];
+        slot.Resource = std::move(resource);
+        count_++;
+        return HandleType(index, slot.Generation);
+    }
+
+    // Null and stale handles are ignored
+    void Release(HandleType handle) {
+        Slot* slot = Find(handle);
+        if (!slot)
+            return;
+
+        RenderThread::DeferRelease(std::move(slot->Resource));
+        Retire(*slot, handle.GetIndex());
+    }
+
+    // Null when the handle is null or stale
+    T* Get(HandleType handle) const {
+        const Slot* slot = Find(handle);
+        return slot ? slot->Resource.get() : nullptr;
+    }
+
+    // For code that keeps the resource beyond the handle's lifetime
+    std::shared_ptr<T> GetShared(HandleType handle) const {
+        const Slot* slot = Find(handle);
+        return slot ? slot->Resource : nullptr;
+    }
+
+    bool IsValid(HandleType handle) const {
+        return Find(handle) != nullptr;
+    }
+
+    uint32_t GetCount() const {
+        return count_;
+    }
+
+    // Destroys every resource right away; only once no frame is in flight (e.g. at shutdown).
+    // Outstanding handles go stale.
+    void Clear() {
+        for (uint32_t index = 0; index < static_cast<uint32_t>(slots_.size()); ++index) {
+            if (slots_[index].Resource) {
+                slots_[index].Resource.reset();
+                Retire(slots_[index], index);
+            }
+        }
+    }
+
+  private:
+    struct Slot {
+        std::shared_ptr<T> Resource;
+        uint32_t Generation = 1;
+    };
+
+    const Slot* Find(HandleType handle) const {
+        const uint32_t index = handle.GetIndex();
+        if (index >= slots_.size() || slots_[index].Generation != handle.GetGeneration())
+            return nullptr;
+        return &slots_[index];
+    }
+    Slot* Find(HandleType handle) {
+        return const_cast<Slot*>(std::as_const(*this).Find(handle));
+    }
+
+    void Retire(Slot& slot, uint32_t index) {
+        slot.Generation = slot.Generation == HandleType::kMaxGeneration ? 1 : slot.Generation + 1;
+        freeSlots_.push_back(index);
+        count_--;
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+    uint32_t count_ = 0;
+};
+
+} // namespace se
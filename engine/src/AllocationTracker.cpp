@@ -0,0 +1,421 @@
+#include "engine/AllocationTracker.h"
+#include "engine/Log.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#    include <execinfo.h>
+#elif defined(_WIN32)
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <malloc.h>
+#    include <windows.h>
+#endif
+
+namespace se {
+
+namespace {
+constexpr uint32_t kMaxStackFrames = 16;
+constexpr uint32_t kMaxPendingViolations = 64;
+
+struct ThreadSlot {
+    std::atomic<uint64_t> Allocations{0};
+    std::atomic<uint64_t> Frees{0};
+    std::atomic<uint64_t> Bytes{0};
+    std::atomic<bool> Used{false};
+    char Name[32]{}; // guarded by s_Mutex
+
+    // Main thread only
+    AllocationCounts LastSeen;
+    AllocationCounts LastFrame;
+};
+
+struct Violation {
+    const char* Scope = nullptr;
+    uint64_t Size = 0;
+    uint32_t Thread = 0;
+    void* Frames[kMaxStackFrames]{};
+    int FrameCount = 0;
+};
+
+// Everything here is constant initialized and trivially destructible: operator new runs before
+// main, after exit and during thread teardown
+ThreadSlot s_Slots[AllocationTracker::kMaxThreads];
+std::atomic<uint32_t> s_SlotCount{0};
+std::atomic<NoAllocMode> s_Mode{NoAllocMode::Off};
+std::atomic<uint64_t> s_ViolationCount{0};
+
+std::mutex s_Mutex;
+Violation s_Pending[kMaxPendingViolations];
+uint32_t s_PendingCount = 0;
+
+AllocationCounts s_LastFrame; // main thread only
+
+thread_local ThreadSlot* t_Slot = nullptr;
+thread_local const char* t_NoAllocScope = nullptr;
+thread_local uint32_t t_NoAllocDepth = 0;
+// Set while a violation is being recorded, whose own allocations don't count as violations
+thread_local bool t_InViolation = false;
+
+ThreadSlot& GetThreadSlot() {
+    if (!t_Slot) {
+        const uint32_t index = std::min(s_SlotCount.fetch_add(1, std::memory_order_relaxed),
+                                        AllocationTracker::kMaxThreads - 1);
+        t_Slot = &s_Slots[index];
+        t_Slot->Used.store(true, std::memory_order_release);
+    }
+    return *t_Slot;
+}
+
+int CaptureStack(void** frames) {
+#if defined(__GLIBC__) || defined(__APPLE__)
+    return backtrace(frames, static_cast<int>(kMaxStackFrames));
+#elif defined(_WIN32)
+    return RtlCaptureStackBackTrace(0, kMaxStackFrames, frames, nullptr);
+#else
+    (void)frames;
+    return 0;
+#endif
+}
+
+// Symbol names where the platform has them, addresses otherwise
+std::string DescribeStack(void* const* frames, int count) {
+    std::string out;
+#if defined(__GLIBC__) || defined(__APPLE__)
+    char** symbols = backtrace_symbols(frames, count);
+    for (int i = 0; i < count; ++i) {
+        out += "\n    ";
+        out += symbols ? symbols[i] : "?";
+    }
+    std::free(symbols);
+#else
+    char address[32];
+    for (int i = 0; i < count; ++i) {
+        std::snprintf(address, sizeof(address), "\n    %p", frames[i]);
+        out += address;
+    }
+#endif
+    return out;
+}
+
+void RecordViolation(ThreadSlot& slot, uint64_t size) {
+    const NoAllocMode mode = s_Mode.load(std::memory_order_relaxed);
+    if (mode == NoAllocMode::Off)
+        return;
+
+    t_InViolation = true;
+    Violation violation;
+    violation.Scope = t_NoAllocScope;
+    violation.Size = size;
+    violation.Thread = static_cast<uint32_t>(&slot - s_Slots);
+    violation.FrameCount = CaptureStack(violation.Frames);
+    s_ViolationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (mode == NoAllocMode::Abort) {
+        // The logger may be the one allocating, so go straight to stderr
+        std::fprintf(stderr, "Allocation of %llu bytes inside no-alloc scope '%s':%s\n",
+                     static_cast<unsigned long long>(size), violation.Scope,
+                     DescribeStack(violation.Frames, violation.FrameCount).c_str());
+        std::abort();
+    }
+
+    {
+        std::lock_guard lock(s_Mutex);
+        if (s_PendingCount < kMaxPendingViolations)
+            s_Pending[s_PendingCount++] = violation;
+    }
+    t_InViolation = false;
+}
+
+void OnAllocate(std::size_t size) {
+    ThreadSlot& slot = GetThreadSlot();
+    slot.Allocations.fetch_add(1, std::memory_order_relaxed);
+    slot.Bytes.fetch_add(size, std::memory_order_relaxed);
+    if (t_NoAllocDepth != 0 && !t_InViolation)
+        RecordViolation(slot, size);
+}
+
+void OnFree(void* memory) {
+    if (memory)
+        GetThreadSlot().Frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t SlotCount() {
+    return std::min(s_SlotCount.load(std::memory_order_acquire), AllocationTracker::kMaxThreads);
+}
+
+std::string SlotName(uint32_t index) {
+    if (index == AllocationTracker::kMaxThreads - 1 &&
+        s_SlotCount.load(std::memory_order_relaxed) > AllocationTracker::kMaxThreads)
+        return "Other threads";
+    std::lock_guard lock(s_Mutex);
+    return s_Slots[index].Name[0] ? s_Slots[index].Name : "Thread " + std::to_string(index);
+}
+
+void ReportViolations() {
+    Violation pending[kMaxPendingViolations];
+    uint32_t count = 0;
+    {
+        std::lock_guard lock(s_Mutex);
+        count = s_PendingCount;
+        std::copy(s_Pending, s_Pending + count, pending);
+        s_PendingCount = 0;
+    }
+
+    // Each call stack is reported once, the frame loop would repeat it every frame
+    static std::unordered_set<uint64_t> reported;
+    for (uint32_t i = 0; i < count; ++i) {
+        const Violation& violation = pending[i];
+        uint64_t hash = 14695981039346656037ull;
+        for (int frame = 0; frame < violation.FrameCount; ++frame) {
+            hash ^= reinterpret_cast<uintptr_t>(violation.Frames[frame]);
+            hash *= 1099511628211ull;
+        }
+        if (!reported.insert(hash).second)
+            continue;
+
+        SE_LOG_WARN("Allocation of {} bytes on '{}' inside no-alloc scope '{}':{}",
+                    violation.Size, SlotName(violation.Thread), violation.Scope,
+                    DescribeStack(violation.Frames, violation.FrameCount));
+    }
+}
+} // namespace
+
+bool AllocationTracker::IsEnabled() {
+#ifdef SE_ALLOCATION_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationCounts AllocationTracker::MarkFrame() {
+    AllocationCounts frame;
+    const uint32_t count = SlotCount();
+    for (uint32_t i = 0; i < count; ++i) {
+        ThreadSlot& slot = s_Slots[i];
+        if (!slot.Used.load(std::memory_order_acquire))
+            continue;
+
+        AllocationCounts now;
+        now.Allocations = slot.Allocations.load(std::memory_order_relaxed);
+        now.Frees = slot.Frees.load(std::memory_order_relaxed);
+        now.Bytes = slot.Bytes.load(std::memory_order_relaxed);
+        slot.LastFrame.Allocations = now.Allocations - slot.LastSeen.Allocations;
+        slot.LastFrame.Frees = now.Frees - slot.LastSeen.Frees;
+        slot.LastFrame.Bytes = now.Bytes - slot.LastSeen.Bytes;
+        slot.LastSeen = now;
+
+        frame.Allocations += slot.LastFrame.Allocations;
+        frame.Frees += slot.LastFrame.Frees;
+        frame.Bytes += slot.LastFrame.Bytes;
+    }
+    s_LastFrame = frame;
+
+    ReportViolations();
+    return frame;
+}
+
+AllocationCounts AllocationTracker::GetLastFrameCounts() {
+    return s_LastFrame;
+}
+
+AllocationCounts AllocationTracker::GetTotalCounts() {
+    AllocationCounts total;
+    const uint32_t count = SlotCount();
+    for (uint32_t i = 0; i < count; ++i) {
+        total.Allocations += s_Slots[i].Allocations.load(std::memory_order_relaxed);
+        total.Frees += s_Slots[i].Frees.load(std::memory_order_relaxed);
+        total.Bytes += s_Slots[i].Bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::vector<ThreadAllocationCounts> AllocationTracker::GetThreadCounts() {
+    std::vector<ThreadAllocationCounts> threads;
+    const uint32_t count = SlotCount();
+    for (uint32_t i = 0; i < count; ++i) {
+        const ThreadSlot& slot = s_Slots[i];
+        if (!slot.Used.load(std::memory_order_acquire))
+            continue;
+
+        ThreadAllocationCounts& thread = threads.emplace_back();
+        thread.ThreadName = SlotName(i);
+        thread.LastFrame = slot.LastFrame;
+        thread.Total.Allocations = slot.Allocations.load(std::memory_order_relaxed);
+        thread.Total.Frees = slot.Frees.load(std::memory_order_relaxed);
+        thread.Total.Bytes = slot.Bytes.load(std::memory_order_relaxed);
+    }
+    return threads;
+}
+
+void AllocationTracker::SetThreadName(const char* name) {
+    ThreadSlot& slot = GetThreadSlot();
+    std::lock_guard lock(s_Mutex);
+    std::snprintf(slot.Name, sizeof(slot.Name), "%s", name);
+}
+
+void AllocationTracker::SetNoAllocMode(NoAllocMode mode) {
+    s_Mode.store(mode, std::memory_order_relaxed);
+}
+
+NoAllocMode AllocationTracker::GetNoAllocMode() {
+    return s_Mode.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationTracker::GetNoAllocViolationCount() {
+    return s_ViolationCount.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::BeginNoAllocScope(const char* name) {
+    // Nested scopes report the outermost name
+    if (t_NoAllocDepth++ == 0)
+        t_NoAllocScope = name;
+}
+
+void AllocationTracker::EndNoAllocScope() {
+    if (t_NoAllocDepth > 0 && --t_NoAllocDepth == 0)
+        t_NoAllocScope = nullptr;
+}
+
+} // namespace se
+
+#ifdef SE_ALLOCATION_TRACKING
+
+// Replacements for the global allocation functions, picked up by the linker in place of the
+// standard library's because this file is always linked in through Application
+
+namespace {
+void* TrackedMalloc(std::size_t size) {
+    se::OnAllocate(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* TrackedAlignedMalloc(std::size_t size, std::align_val_t alignment) {
+    se::OnAllocate(size);
+    size = size ? size : 1;
+#    ifdef _WIN32
+    return _aligned_malloc(size, static_cast<std::size_t>(alignment));
+#    else
+    // posix_memalign rejects alignments below sizeof(void*), which std::pmr's default
+    // resource passes through for small types
+    void* memory = nullptr;
+    const std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+    if (posix_memalign(&memory, align, size) != 0)
+        return nullptr;
+    return memory;
+#    endif
+}
+
+void TrackedFree(void* memory) noexcept {
+    se::OnFree(memory);
+    std::free(memory);
+}
+
+void TrackedAlignedFree(void* memory) noexcept {
+    se::OnFree(memory);
+#    ifdef _WIN32
+    _aligned_free(memory);
+#    else
+    std::free(memory);
+#    endif
+}
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* memory = TrackedMalloc(size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* memory = TrackedMalloc(size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return TrackedMalloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return TrackedMalloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* memory = TrackedAlignedMalloc(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* memory = TrackedAlignedMalloc(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return TrackedAlignedMalloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+    return TrackedAlignedMalloc(size, alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    TrackedAlignedFree(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    TrackedAlignedFree(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    TrackedAlignedFree(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+    TrackedAlignedFree(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    TrackedAlignedFree(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    TrackedAlignedFree(memory);
+}
+
+#endif
@@ -1,13 +1,63 @@
 
 #include "engine/Application.h"
+#include "engine/AllocationTracker.h"
+#include "engine/FlightRecorder.h"
 #include "engine/Input.h"
+#include "engine/JobSystem.h"
 #include "engine/Log.h"
+#include "engine/MemoryTracker.h"
+#include "engine/Metrics.h"
+#include "engine/Profiler.h"
+#include "engine/RenderThread.h"
 #include <GLFW/glfw3.h>
 #include <glm.hpp>
 #include <imgui.h>
 
 namespace se {
 
+namespace {
+// Adds the time between construction and destruction to a FrameTimings phase
+class PhaseTimer {
+  public:
+    explicit PhaseTimer(float& phaseMs) : phaseMs_(phaseMs), start_(Profiler::Now()) {}
+    ~PhaseTimer() {
+        phaseMs_ += static_cast<float>(static_cast<double>(Profiler::Now() - start_) * 1e-6);
+    }
+
+  private:
+    float& phaseMs_;
+    uint64_t start_;
+};
+
+void PublishFrameMetrics(const FrameTimings& timings) {
+    static MetricCounter& frames = Metrics::Counter("se_frames_total", "Main loop iterations");
+    static MetricHistogram& frameTime =
+        Metrics::Histogram("se_frame_time_seconds", "Main loop iteration time",
+                           {0.004, 0.008, 0.0167, 0.0333, 0.05, 0.1, 0.25, 1.0});
+    static MetricCounter* phases[] = {
+        &Metrics::Counter("se_frame_phase_seconds_total", "Main thread time per loop phase",
+                          "phase=\"events\""),
+        &Metrics::Counter("se_frame_phase_seconds_total", "", "phase=\"update\""),
+        &Metrics::Counter("se_frame_phase_seconds_total", "", "phase=\"render\""),
+        &Metrics::Counter("se_frame_phase_seconds_total", "", "phase=\"imgui\""),
+        &Metrics::Counter("se_frame_phase_seconds_total", "", "phase=\"swap\"")};
+    static MetricCounter& allocations =
+        Metrics::Counter("se_heap_allocations_total", "operator new calls, all threads");
+    static MetricCounter& allocatedBytes =
+        Metrics::Counter("se_heap_allocated_bytes_total", "Bytes requested from operator new");
+
+    frames.Add();
+    frameTime.Observe(timings.FrameMs * 1e-3);
+    const float phaseMs[] = {timings.EventsMs, timings.UpdateMs, timings.RenderMs,
+                             timings.ImGuiMs, timings.SwapMs};
+    for (size_t i = 0; i < std::size(phases); ++i) {
+        phases[i]->Add(phaseMs[i] * 1e-3);
+    }
+    allocations.Add(static_cast<double>(timings.Allocations));
+    allocatedBytes.Add(static_cast<double>(timings.AllocatedBytes));
+}
+} // namespace
+
 Application* Application::s_Instance = nullptr;
 
 Application::Application(const ApplicationSpec& specification) {
@@ -19,6 +69,11 @@ Application::Application(const ApplicationSpec& specification) {
 
     SE_LOG_INFO("Starting Simple Engine");
 
+    JobSystem::Init();
+    FlightRecorder::Init();
+    MemoryTracker::RegisterMetrics();
+    Metrics::StartExporter({specification.MetricsSnapshotPath, 15.0f, specification.MetricsPort});
+
     // Create window
     window_ = std::make_unique<Window>(specification);
 
@@ -30,14 +85,19 @@ Application::Application(const ApplicationSpec& specification) {
     renderer_->SetClearColor(0.1f, 0.1f, 0.15f, 1.0f);
 
     // Create and attach ImGui layer
+    useRenderThread_ = specification.UseRenderThread;
     imguiLayer_ = std::make_shared<ImGuiLayer>();
     imguiLayer_->SetWindow(window_->GetNativeWindow());
+    imguiLayer_->SetViewportsEnabled(!useRenderThread_);
     imguiLayer_->OnAttach();
 }
 
 Application::~Application() {
     SE_LOG_INFO("Shutting down Simple Engine");
 
+    // Layers and systems release their GL objects on this thread
+    RenderThread::Stop();
+
     // Detach ImGui
     if (imguiLayer_) {
         imguiLayer_->OnDetach();
@@ -54,6 +114,10 @@ Application::~Application() {
     window_.reset();
     glfwTerminate();
 
+    Metrics::StopExporter();
+    FlightRecorder::Shutdown();
+    JobSystem::Shutdown();
+
     s_Instance = nullptr;
 }
 
@@ -62,8 +126,29 @@ int Application::Run() {
     float lastTime = GetTime();
 
     SE_LOG_INFO("Application main loop started");
+    SE_PROFILE_THREAD("Main");
+
+    // Layers were attached with the context current here; from now on it belongs to the
+    // render thread and every GL call below goes through RenderThread::Submit
+    if (useRenderThread_)
+        RenderThread::Start(window_->GetContext());
 
+    FrameTimings timings;
     while (running_) {
+        SE_PROFILE_FRAME();
+        const uint64_t frameStart = Profiler::Now();
+        if (timings.Index != 0) {
+            timings.FrameMs =
+                static_cast<float>(static_cast<double>(frameStart - timings.StartNs) * 1e-6);
+            const AllocationCounts allocations = AllocationTracker::MarkFrame();
+            timings.Allocations = allocations.Allocations;
+            timings.AllocatedBytes = allocations.Bytes;
+            performancePanel_.RecordFrame(timings);
+            FlightRecorder::RecordFrame(timings);
+            PublishFrameMetrics(timings);
+        }
+        timings = {timings.Index + 1, frameStart};
+
         // Check for window close
         if (Input::IsKeyPressed(GLFW_KEY_ESCAPE)) {
             window_->RequestClose();
@@ -79,48 +164,79 @@ int Application::Run() {
         float timestep = glm::clamp(currentTime - lastTime, 0.001f, 0.1f);
         lastTime = currentTime;
 
-        // Begin frame
-        renderer_->BeginFrame();
+        // Begin frame and clear screen with the configured color
+        RenderThread::Submit([this] {
+            renderer_->BeginFrame();
+            renderer_->Clear();
+        });
 
         int width, height;
         glfwGetFramebufferSize(window_->GetNativeWindow(), &width, &height);
 
-        // Clear screen with the configured color
-        renderer_->Clear();
-
         if (window_->GetWidth() != width || window_->GetHeight() != height) {
             window_->SetWidth(width);
             window_->SetHeight(height);
         }
 
         // Update all layers
-        for (const std::unique_ptr<Layer>& layer : layer_stack_) {
-            layer->OnUpdate(timestep);
+        {
+            SE_PROFILE_SCOPE("Update");
+            SE_NO_ALLOC_SCOPE("Update");
+            PhaseTimer timer(timings.UpdateMs);
+            for (const std::unique_ptr<Layer>& layer : layer_stack_) {
+                layer->OnUpdate(timestep);
+            }
         }
 
-        // Render all layers
-        for (const std::unique_ptr<Layer>& layer : layer_stack_) {
-            layer->OnRender();
+        // Render all layers; SceneRenderer records here and submits its GL work. Once warmed
+        // up this does not allocate in either threading mode; reused buffers only grow while
+        // the scene does (more objects, lights or visible clusters than any frame before)
+        {
+            SE_PROFILE_SCOPE("Render");
+            SE_NO_ALLOC_SCOPE("Render");
+            PhaseTimer timer(timings.RenderMs);
+            for (const std::unique_ptr<Layer>& layer : layer_stack_) {
+                layer->OnRender();
+            }
         }
 
         // End frame
-        renderer_->EndFrame();
+        RenderThread::Submit([this] { renderer_->EndFrame(); });
 
         // ImGui rendering
-        imguiLayer_->Begin();
-
-        // Let layers draw their ImGui
-        for (const std::unique_ptr<Layer>& layer : layer_stack_) {
-            layer->OnImGuiRender();
+        {
+            SE_PROFILE_SCOPE("ImGui");
+            PhaseTimer timer(timings.ImGuiMs);
+            imguiLayer_->Begin();
+
+            // Let layers draw their ImGui
+            for (const std::unique_ptr<Layer>& layer : layer_stack_) {
+                layer->OnImGuiRender();
+            }
+            performancePanel_.Draw();
+
+            imguiLayer_->End();
         }
 
-        imguiLayer_->End();
-
-        // Swap buffers and poll events
-        window_->SwapBuffers();
-        window_->OnUpdate();
+        // Swap buffers, hand the frame to the render thread and poll events while it runs
+        {
+            SE_PROFILE_SCOPE("Swap");
+            PhaseTimer timer(timings.SwapMs);
+            RenderThread::Submit([this] {
+                SE_PROFILE_SCOPE("SwapBuffers");
+                window_->SwapBuffers();
+            });
+            RenderThread::EndFrame();
+        }
+        {
+            SE_PROFILE_SCOPE("Events");
+            PhaseTimer timer(timings.EventsMs);
+            window_->OnUpdate();
+        }
     }
 
+    RenderThread::Stop();
+
     SE_LOG_INFO("Application main loop ended");
     return 0;
 }
@@ -0,0 +1,265 @@
+#include "engine/FlightRecorder.h"
+#include "engine/Log.h"
+#include "engine/MemoryTracker.h"
+#include "engine/Profiler.h"
+#include "engine/renderer/SceneRenderer.h"
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace se {
+
+namespace {
+struct Counter {
+    const char* Name = nullptr;
+    double Value = 0.0;
+};
+
+struct FrameRecord {
+    FrameTimings Timings;
+    std::array<Counter, FlightRecorder::kMaxCounters> Counters{};
+    uint32_t CounterCount = 0;
+};
+
+struct DumpJob {
+    std::vector<FrameRecord> Frames;
+    uint64_t TriggerFrame = 0;
+    bool Hitch = false;
+};
+
+struct FlightRecorderState {
+    FlightRecorderSettings Settings;
+    MemoryAllocation Memory{MemoryTag::Profiling, MemoryDomain::Cpu,
+                            sizeof(FlightRecorderState)};
+
+    // Main thread only
+    std::array<FrameRecord, FlightRecorder::kHistoryFrames> Frames{};
+    uint32_t Count = 0;
+    uint32_t Next = 0;
+    FrameRecord Pending;
+    bool Triggered = false;
+    bool TriggerIsHitch = false;
+    uint64_t TriggerFrame = 0;
+    uint32_t FramesUntilDump = 0;
+    bool DumpRequested = false;
+    uint64_t LastDumpNs = 0;
+    uint32_t Dumps = 0;
+
+    std::thread Writer;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    std::deque<DumpJob> Jobs;
+    bool Stop = false;
+};
+
+FlightRecorderState* s_State = nullptr;
+
+void StoreCounter(FrameRecord& record, const char* name, double value) {
+    for (uint32_t i = 0; i < record.CounterCount; ++i) {
+        if (record.Counters[i].Name == name) {
+            record.Counters[i].Value = value;
+            return;
+        }
+    }
+    if (record.CounterCount < FlightRecorder::kMaxCounters)
+        record.Counters[record.CounterCount++] = {name, value};
+}
+
+void WriteDump(const DumpJob& job, const std::string& directory) {
+    SE_PROFILE_FUNCTION();
+    const FrameTimings& first = job.Frames.front().Timings;
+    const FrameTimings& last = job.Frames.back().Timings;
+    const uint64_t endNs = last.StartNs + static_cast<uint64_t>(last.FrameMs * 1e6);
+
+    std::vector<ProfileThreadZones> threads = Profiler::CollectZones(first.StartNs, endNs);
+
+    // Frames get a track of their own; counters are sampled at each frame's start
+    ProfileThreadZones frames;
+    frames.ThreadName = "Frames";
+    std::vector<ProfileCounterSample> counters;
+    counters.reserve(job.Frames.size() * 8);
+    for (const FrameRecord& record : job.Frames) {
+        const FrameTimings& timings = record.Timings;
+        ProfileZone zone;
+        zone.Name = timings.Index == job.TriggerFrame ? (job.Hitch ? "Hitch" : "Dump") : "Frame";
+        zone.StartNs = timings.StartNs;
+        zone.EndNs = timings.StartNs + static_cast<uint64_t>(timings.FrameMs * 1e6);
+        frames.Zones.push_back(zone);
+
+        counters.push_back({"FrameMs", timings.StartNs, timings.FrameMs});
+        for (uint32_t i = 0; i < record.CounterCount; ++i) {
+            counters.push_back(
+                {record.Counters[i].Name, timings.StartNs, record.Counters[i].Value});
+        }
+    }
+    threads.insert(threads.begin(), std::move(frames));
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    const std::string path = (std::filesystem::path(directory) /
+                              ((job.Hitch ? "hitch_" : "dump_") +
+                               std::to_string(job.TriggerFrame) + ".json"))
+                                 .string();
+    if (Profiler::WriteChromeTrace(path, threads, counters))
+        SE_LOG_INFO("FlightRecorder: {} frames around frame {} written to '{}'",
+                    job.Frames.size(), job.TriggerFrame, path);
+}
+
+void WriterLoop(FlightRecorderState& state) {
+    SE_PROFILE_THREAD("FlightRecorder");
+    std::unique_lock lock(state.Mutex);
+    for (;;) {
+        state.Condition.wait(lock, [&] { return state.Stop || !state.Jobs.empty(); });
+        if (state.Jobs.empty())
+            return;
+
+        DumpJob job = std::move(state.Jobs.front());
+        state.Jobs.pop_front();
+        const std::string directory = state.Settings.Directory;
+        lock.unlock();
+        WriteDump(job, directory);
+        lock.lock();
+    }
+}
+
+void QueueDump(FlightRecorderState& state) {
+    const uint32_t window =
+        std::min(state.Settings.FramesBefore + state.Settings.FramesAfter + 1, state.Count);
+
+    DumpJob job;
+    job.TriggerFrame = state.TriggerFrame;
+    job.Hitch = state.TriggerIsHitch;
+    job.Frames.reserve(window);
+    for (uint32_t i = state.Count - window; i < state.Count; ++i) {
+        const uint32_t slot =
+            (state.Next + FlightRecorder::kHistoryFrames - state.Count + i) %
+            FlightRecorder::kHistoryFrames;
+        job.Frames.push_back(state.Frames[slot]);
+    }
+
+    {
+        std::lock_guard lock(state.Mutex);
+        state.Jobs.push_back(std::move(job));
+    }
+    state.Condition.notify_one();
+    state.LastDumpNs = Profiler::Now();
+    state.Dumps++;
+}
+} // namespace
+
+void FlightRecorder::Init(const FlightRecorderSettings& settings) {
+    if (s_State) {
+        SE_LOG_WARN("FlightRecorder already initialized");
+        return;
+    }
+
+    s_State = new FlightRecorderState();
+    SetSettings(settings);
+    s_State->Writer = std::thread(WriterLoop, std::ref(*s_State));
+}
+
+void FlightRecorder::Shutdown() {
+    if (!s_State)
+        return;
+
+    {
+        std::lock_guard lock(s_State->Mutex);
+        s_State->Stop = true;
+    }
+    s_State->Condition.notify_one();
+    s_State->Writer.join();
+
+    delete s_State;
+    s_State = nullptr;
+}
+
+void FlightRecorder::SetSettings(const FlightRecorderSettings& settings) {
+    if (!s_State)
+        return;
+
+    std::lock_guard lock(s_State->Mutex);
+    s_State->Settings = settings;
+    // The window has to fit the history
+    s_State->Settings.FramesAfter = std::min(settings.FramesAfter, kHistoryFrames - 1);
+    s_State->Settings.FramesBefore =
+        std::min(settings.FramesBefore, kHistoryFrames - 1 - s_State->Settings.FramesAfter);
+}
+
+FlightRecorderSettings FlightRecorder::GetSettings() {
+    if (!s_State)
+        return {};
+
+    std::lock_guard lock(s_State->Mutex);
+    return s_State->Settings;
+}
+
+void FlightRecorder::SetCounter(const char* name, double value) {
+    if (s_State)
+        StoreCounter(s_State->Pending, name, value);
+}
+
+void FlightRecorder::RecordFrame(const FrameTimings& timings) {
+    if (!s_State)
+        return;
+
+    FlightRecorderState& state = *s_State;
+    FrameRecord& record = state.Pending;
+    record.Timings = timings;
+
+    const RenderStats stats = SceneRenderer::GetStats();
+    StoreCounter(record, "DrawCalls", stats.DrawCalls);
+    StoreCounter(record, "Triangles", stats.TriangleCount);
+    StoreCounter(record, "CommandPackets", stats.CommandPackets);
+    StoreCounter(record, "ShadowDrawCalls", stats.ShadowDrawCalls);
+    StoreCounter(record, "CulledObjects", stats.CulledObjects);
+    StoreCounter(record, "Allocations", static_cast<double>(timings.Allocations));
+    StoreCounter(record, "AllocatedBytes", static_cast<double>(timings.AllocatedBytes));
+
+    state.Frames[state.Next] = record;
+    state.Next = (state.Next + 1) % kHistoryFrames;
+    state.Count = std::min(state.Count + 1, kHistoryFrames);
+    record.CounterCount = 0;
+
+    // Settings only change on the main thread, reading them here needs no lock
+    const FlightRecorderSettings& settings = state.Settings;
+    if (!state.Triggered) {
+        const bool cooledDown = state.Dumps == 0 ||
+                                Profiler::Now() - state.LastDumpNs >=
+                                    static_cast<uint64_t>(settings.CooldownSeconds * 1e9f);
+        const bool hitch =
+            settings.Enabled && cooledDown && timings.FrameMs > settings.HitchThresholdMs;
+        if (hitch || state.DumpRequested) {
+            state.Triggered = true;
+            state.TriggerIsHitch = !state.DumpRequested;
+            state.TriggerFrame = timings.Index;
+            state.FramesUntilDump = state.DumpRequested ? 0 : settings.FramesAfter;
+            state.DumpRequested = false;
+            if (hitch)
+                SE_LOG_WARN("FlightRecorder: frame {} took {:.2f} ms", timings.Index,
+                            timings.FrameMs);
+        }
+    } else if (state.FramesUntilDump > 0) {
+        state.FramesUntilDump--;
+    }
+
+    if (state.Triggered && state.FramesUntilDump == 0) {
+        QueueDump(state);
+        state.Triggered = false;
+    }
+}
+
+void FlightRecorder::RequestDump() {
+    if (s_State)
+        s_State->DumpRequested = true;
+}
+
+uint32_t FlightRecorder::GetDumpCount() {
+    return s_State ? s_State->Dumps : 0;
+}
+
+} // namespace se
@@ -1,13 +1,49 @@
 #include "engine/ImGuiLayer.h"
 #include "engine/Log.h"
+#include "engine/RenderThread.h"
+#include "engine/renderer/GpuProfiler.h"
 #include <GLFW/glfw3.h>
 #include <imgui.h>
+#include <memory>
+#include <vector>
 
 #include "examples/imgui_impl_glfw.h"
 #include "examples/imgui_impl_opengl3.h"
 
 namespace se {
 
+namespace {
+// Deep copy of a frame's draw data. The draw lists ImGui::Render returns are rebuilt by the
+// next NewFrame, while the render thread may still be drawing them.
+class DrawDataSnapshot {
+  public:
+    explicit DrawDataSnapshot(const ImDrawData& source) : drawData_(source) {
+        lists_.reserve(static_cast<size_t>(source.CmdListsCount));
+        for (int i = 0; i < source.CmdListsCount; ++i) {
+            lists_.push_back(source.CmdLists[i]->CloneOutput());
+        }
+        drawData_.CmdLists = lists_.data();
+    }
+
+    ~DrawDataSnapshot() {
+        for (ImDrawList* list : lists_) {
+            IM_DELETE(list);
+        }
+    }
+
+    DrawDataSnapshot(const DrawDataSnapshot&) = delete;
+    DrawDataSnapshot& operator=(const DrawDataSnapshot&) = delete;
+
+    ImDrawData* Get() {
+        return &drawData_;
+    }
+
+  private:
+    ImDrawData drawData_;
+    std::vector<ImDrawList*> lists_;
+};
+} // namespace
+
 ImGuiLayer::ImGuiLayer() : Layer("ImGuiLayer") {}
 
 ImGuiLayer::~ImGuiLayer() {}
@@ -16,6 +52,10 @@ void ImGuiLayer::SetWindow(GLFWwindow* window) {
     window_ = window;
 }
 
+void ImGuiLayer::SetViewportsEnabled(bool enabled) {
+    viewportsEnabled_ = enabled;
+}
+
 void ImGuiLayer::OnAttach() {
     SE_LOG_INFO("ImGuiLayer::OnAttach");
 
@@ -27,7 +67,8 @@ void ImGuiLayer::OnAttach() {
 
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+    if (viewportsEnabled_)
+        io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
 
     // Setup Dear ImGui style
     ImGui::StyleColorsDark();
@@ -44,6 +85,8 @@ void ImGuiLayer::OnAttach() {
     const char* glsl_version = "#version 330 core";
     ImGui_ImplGlfw_InitForOpenGL(window_, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
+    // Creates the shader and font texture now, while the context is current on this thread
+    ImGui_ImplOpenGL3_NewFrame();
 }
 
 void ImGuiLayer::OnDetach() {
@@ -75,7 +118,16 @@ void ImGuiLayer::Begin() {
 
 void ImGuiLayer::End() {
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    if (RenderThread::IsRunning()) {
+        auto snapshot = std::make_shared<DrawDataSnapshot>(*ImGui::GetDrawData());
+        RenderThread::Submit([snapshot] {
+            GpuProfileScope scope("ImGui");
+            ImGui_ImplOpenGL3_RenderDrawData(snapshot->Get());
+        });
+    } else {
+        GpuProfileScope scope("ImGui");
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
 
     ImGuiIO& io = ImGui::GetIO();
     if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -0,0 +1,158 @@
+#include "engine/JobSystem.h"
+#include "engine/Log.h"
+#include "engine/Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace se {
+
+namespace {
+struct JobSystemState {
+    std::vector<std::thread> Workers;
+
+    std::mutex Mutex;
+    std::condition_variable WakeCondition;
+    std::condition_variable DoneCondition;
+
+    // Serializes ParallelFor calls coming from different threads
+    std::mutex SubmitMutex;
+
+    const void* Job = nullptr;
+    void (*Thunk)(const void* job, uint32_t begin, uint32_t end) = nullptr;
+    std::atomic<uint32_t> NextIndex{0};
+    uint32_t Count = 0;
+    uint32_t BatchSize = 1;
+    uint32_t PendingWorkers = 0;
+    uint64_t Generation = 0;
+    bool Stop = false;
+};
+
+JobSystemState* s_State = nullptr;
+thread_local bool t_InsideJob = false;
+
+void RunBatches(JobSystemState& state) {
+    const bool wasInside = t_InsideJob;
+    t_InsideJob = true;
+
+    for (;;) {
+        const uint32_t begin = state.NextIndex.fetch_add(state.BatchSize);
+        if (begin >= state.Count)
+            break;
+        state.Thunk(state.Job, begin, std::min(begin + state.BatchSize, state.Count));
+    }
+
+    t_InsideJob = wasInside;
+}
+
+void WorkerLoop(JobSystemState& state, uint32_t workerIndex) {
+    SE_PROFILE_THREAD("Worker " + std::to_string(workerIndex));
+    uint64_t seenGeneration = 0;
+
+    for (;;) {
+        {
+            std::unique_lock lock(state.Mutex);
+            state.WakeCondition.wait(
+                lock, [&] { return state.Stop || state.Generation != seenGeneration; });
+            if (state.Stop)
+                return;
+            seenGeneration = state.Generation;
+        }
+
+        {
+            SE_PROFILE_SCOPE("Jobs");
+            RunBatches(state);
+        }
+
+        std::lock_guard lock(state.Mutex);
+        if (--state.PendingWorkers == 0)
+            state.DoneCondition.notify_one();
+    }
+}
+} // namespace
+
+void JobSystem::Init(uint32_t workerCount) {
+    if (s_State) {
+        SE_LOG_WARN("JobSystem already initialized");
+        return;
+    }
+
+    if (workerCount == 0) {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    s_State = new JobSystemState();
+    s_State->Workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        s_State->Workers.emplace_back(WorkerLoop, std::ref(*s_State), i);
+    }
+
+    SE_LOG_INFO("JobSystem initialized with {} worker threads", workerCount);
+}
+
+void JobSystem::Shutdown() {
+    if (!s_State)
+        return;
+
+    {
+        std::lock_guard lock(s_State->Mutex);
+        s_State->Stop = true;
+    }
+    s_State->WakeCondition.notify_all();
+
+    for (auto& worker : s_State->Workers) {
+        worker.join();
+    }
+
+    delete s_State;
+    s_State = nullptr;
+}
+
+uint32_t JobSystem::GetWorkerCount() {
+    return s_State ? static_cast<uint32_t>(s_State->Workers.size()) : 0;
+}
+
+void JobSystem::RunParallelFor(uint32_t count, uint32_t batchSize, const void* job,
+                               JobThunk thunk) {
+    if (count == 0)
+        return;
+
+    batchSize = std::max(batchSize, 1u);
+
+    // Run inline when there is nothing to gain or when called from inside a job
+    if (!s_State || s_State->Workers.empty() || count <= batchSize || t_InsideJob) {
+        for (uint32_t begin = 0; begin < count; begin += batchSize) {
+            thunk(job, begin, std::min(begin + batchSize, count));
+        }
+        return;
+    }
+
+    SE_PROFILE_SCOPE("ParallelFor");
+    std::lock_guard submitLock(s_State->SubmitMutex);
+
+    {
+        std::lock_guard lock(s_State->Mutex);
+        s_State->Job = job;
+        s_State->Thunk = thunk;
+        s_State->NextIndex.store(0);
+        s_State->Count = count;
+        s_State->BatchSize = batchSize;
+        s_State->PendingWorkers = static_cast<uint32_t>(s_State->Workers.size());
+        s_State->Generation++;
+    }
+    s_State->WakeCondition.notify_all();
+
+    // The calling thread helps instead of idling
+    RunBatches(*s_State);
+
+    std::unique_lock lock(s_State->Mutex);
+    s_State->DoneCondition.wait(lock, [] { return s_State->PendingWorkers == 0; });
+    s_State->Job = nullptr;
+    s_State->Thunk = nullptr;
+}
+
+} // namespace se
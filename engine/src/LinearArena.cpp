@@ -0,0 +1,83 @@
+#include "engine/LinearArena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace se {
+
+LinearArena::LinearArena(size_t blockSize, MemoryTag tag)
+    : blockSize_(std::max<size_t>(blockSize, 4096)), memory_(tag, MemoryDomain::Cpu) {
+    AddBlock(blockSize_);
+}
+
+LinearArena::~LinearArena() = default;
+
+LinearArena::Block* LinearArena::AddBlock(size_t minimumSize) {
+    auto block = std::make_unique<Block>();
+    block->Size = std::max(minimumSize, blockSize_);
+    block->Data.reset(new std::byte[block->Size]);
+
+    Block* added = block.get();
+    blocks_.push_back(std::move(block));
+    capacity_.fetch_add(added->Size, std::memory_order_relaxed);
+    memory_.Resize(GetCapacity());
+    current_.store(added, std::memory_order_release);
+    return added;
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment) {
+    for (;;) {
+        Block* block = current_.load(std::memory_order_acquire);
+        const auto base = reinterpret_cast<uintptr_t>(block->Data.get());
+
+        size_t used = block->Used.load(std::memory_order_relaxed);
+        for (;;) {
+            const uintptr_t start = (base + used + alignment - 1) & ~(uintptr_t(alignment) - 1);
+            const size_t end = start - base + size;
+            if (end > block->Size)
+                break;
+            if (block->Used.compare_exchange_weak(used, end, std::memory_order_relaxed))
+                return reinterpret_cast<void*>(start);
+        }
+
+        // Full: the first thread to get here chains a new block, the others retry on it
+        std::lock_guard lock(mutex_);
+        if (current_.load(std::memory_order_relaxed) == block)
+            AddBlock(size + alignment);
+    }
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment) {
+    return Allocate(bytes, alignment);
+}
+
+void LinearArena::Reset() {
+    std::lock_guard lock(mutex_);
+    size_t used = 0;
+    size_t capacity = 0;
+    for (const auto& block : blocks_) {
+        used += block->Used.load(std::memory_order_relaxed);
+        capacity += block->Size;
+    }
+    peakBytes_ = std::max(peakBytes_, used);
+
+    // Next time everything fits in one block
+    if (blocks_.size() > 1) {
+        blocks_.clear();
+        capacity_.store(0, std::memory_order_relaxed);
+        AddBlock(capacity);
+    }
+    blocks_.front()->Used.store(0, std::memory_order_relaxed);
+    current_.store(blocks_.front().get(), std::memory_order_release);
+}
+
+size_t LinearArena::GetUsedBytes() const {
+    std::lock_guard lock(mutex_);
+    size_t used = 0;
+    for (const auto& block : blocks_) {
+        used += block->Used.load(std::memory_order_relaxed);
+    }
+    return used;
+}
+
+} // namespace se
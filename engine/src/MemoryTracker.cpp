@@ -0,0 +1,262 @@
+#include "engine/MemoryTracker.h"
+#include "engine/Log.h"
+#include "engine/Metrics.h"
+#include <atomic>
+#include <cstdio>
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+namespace se {
+
+namespace {
+constexpr size_t kTagCount = static_cast<size_t>(MemoryTag::Count);
+constexpr size_t kDomainCount = static_cast<size_t>(MemoryDomain::Count);
+
+constexpr const char* kTagNames[kTagCount] = {"Untagged", "Meshes",   "Shaders", "RenderTargets",
+                                              "Shadows",  "Renderer", "Scene",   "Profiling"};
+// Prometheus label values
+constexpr const char* kTagLabels[kTagCount] = {"untagged", "meshes",   "shaders", "render_targets",
+                                               "shadows",  "renderer", "scene",   "profiling"};
+constexpr const char* kDomainNames[kDomainCount] = {"CPU", "GPU"};
+constexpr const char* kDomainLabels[kDomainCount] = {"cpu", "gpu"};
+
+struct Counters {
+    std::atomic<uint64_t> Bytes{0};
+    std::atomic<uint64_t> PeakBytes{0};
+    std::atomic<uint64_t> Allocations{0};
+    std::atomic<uint64_t> BudgetBytes{0};
+    std::atomic<bool> OverBudget{false};
+};
+
+// Constant initialized, so allocations made by other statics' constructors are counted
+Counters s_Counters[kTagCount][kDomainCount];
+
+Counters& GetCounters(MemoryTag tag, MemoryDomain domain) {
+    return s_Counters[static_cast<size_t>(tag)][static_cast<size_t>(domain)];
+}
+
+std::string FormatBytes(uint64_t bytes) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.2f MiB", static_cast<double>(bytes) / (1 << 20));
+    return buffer;
+}
+
+void AddBytes(MemoryTag tag, MemoryDomain domain, uint64_t bytes) {
+    Counters& counters = GetCounters(tag, domain);
+    const uint64_t current = counters.Bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    uint64_t peak = counters.PeakBytes.load(std::memory_order_relaxed);
+    while (current > peak &&
+           !counters.PeakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+
+    const uint64_t budget = counters.BudgetBytes.load(std::memory_order_relaxed);
+    if (budget != 0 && current > budget &&
+        !counters.OverBudget.exchange(true, std::memory_order_relaxed))
+        SE_LOG_WARN("Memory: {} {} uses {}, over its budget of {}",
+                    MemoryTracker::GetTagName(tag), MemoryTracker::GetDomainName(domain),
+                    FormatBytes(current), FormatBytes(budget));
+}
+
+void SubtractBytes(MemoryTag tag, MemoryDomain domain, uint64_t bytes) {
+    Counters& counters = GetCounters(tag, domain);
+    const uint64_t current = counters.Bytes.fetch_sub(bytes, std::memory_order_relaxed) - bytes;
+    if (current <= counters.BudgetBytes.load(std::memory_order_relaxed))
+        counters.OverBudget.store(false, std::memory_order_relaxed);
+}
+} // namespace
+
+void MemoryTracker::Allocate(MemoryTag tag, MemoryDomain domain, uint64_t bytes) {
+    AddBytes(tag, domain, bytes);
+    GetCounters(tag, domain).Allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::Free(MemoryTag tag, MemoryDomain domain, uint64_t bytes) {
+    SubtractBytes(tag, domain, bytes);
+    GetCounters(tag, domain).Allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::Resize(MemoryTag tag, MemoryDomain domain, uint64_t oldBytes,
+                           uint64_t newBytes) {
+    if (newBytes > oldBytes)
+        AddBytes(tag, domain, newBytes - oldBytes);
+    else
+        SubtractBytes(tag, domain, oldBytes - newBytes);
+}
+
+MemoryUsage MemoryTracker::GetUsage(MemoryTag tag, MemoryDomain domain) {
+    const Counters& counters = GetCounters(tag, domain);
+    MemoryUsage usage;
+    usage.Bytes = counters.Bytes.load(std::memory_order_relaxed);
+    usage.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+    usage.Allocations = counters.Allocations.load(std::memory_order_relaxed);
+    usage.BudgetBytes = counters.BudgetBytes.load(std::memory_order_relaxed);
+    return usage;
+}
+
+uint64_t MemoryTracker::GetTotalBytes(MemoryDomain domain) {
+    uint64_t total = 0;
+    for (size_t tag = 0; tag < kTagCount; ++tag) {
+        total += GetCounters(static_cast<MemoryTag>(tag), domain)
+                     .Bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void MemoryTracker::ResetPeaks() {
+    for (auto& tag : s_Counters) {
+        for (Counters& counters : tag) {
+            counters.PeakBytes.store(counters.Bytes.load(std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
+        }
+    }
+}
+
+void MemoryTracker::SetBudget(MemoryTag tag, MemoryDomain domain, uint64_t bytes) {
+    Counters& counters = GetCounters(tag, domain);
+    counters.BudgetBytes.store(bytes, std::memory_order_relaxed);
+
+    const uint64_t current = counters.Bytes.load(std::memory_order_relaxed);
+    const bool over = bytes != 0 && current > bytes;
+    if (over && !counters.OverBudget.exchange(true, std::memory_order_relaxed))
+        SE_LOG_WARN("Memory: {} {} uses {}, over its budget of {}", GetTagName(tag),
+                    GetDomainName(domain), FormatBytes(current), FormatBytes(bytes));
+    else if (!over)
+        counters.OverBudget.store(false, std::memory_order_relaxed);
+}
+
+bool MemoryTracker::IsOverBudget(MemoryTag tag, MemoryDomain domain) {
+    const MemoryUsage usage = GetUsage(tag, domain);
+    return usage.BudgetBytes != 0 && usage.Bytes > usage.BudgetBytes;
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag) {
+    return tag < MemoryTag::Count ? kTagNames[static_cast<size_t>(tag)] : "Invalid";
+}
+
+const char* MemoryTracker::GetDomainName(MemoryDomain domain) {
+    return domain < MemoryDomain::Count ? kDomainNames[static_cast<size_t>(domain)] : "Invalid";
+}
+
+uint64_t MemoryTracker::TextureBytes(uint32_t internalFormat, uint32_t width, uint32_t height) {
+    uint64_t bytesPerPixel = 4;
+    switch (internalFormat) {
+        case GL_R8:
+            bytesPerPixel = 1;
+            break;
+        case GL_RG8:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            bytesPerPixel = 2;
+            break;
+        case GL_RGB8:
+        case GL_DEPTH_COMPONENT24: // padded to 32 bits by every driver we know of
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_RGBA8:
+        case GL_R32F:
+        case GL_R32UI:
+        case GL_RG16F:
+        case GL_R11F_G11F_B10F:
+            bytesPerPixel = 4;
+            break;
+        case GL_DEPTH32F_STENCIL8:
+        case GL_RGBA16F:
+        case GL_RG32F:
+        case GL_RG32UI:
+            bytesPerPixel = 8;
+            break;
+        case GL_RGB16F:
+            bytesPerPixel = 6;
+            break;
+        case GL_RGB32F:
+            bytesPerPixel = 12;
+            break;
+        case GL_RGBA32F:
+        case GL_RGBA32UI:
+            bytesPerPixel = 16;
+            break;
+        default:
+            break;
+    }
+    return bytesPerPixel * width * height;
+}
+
+void MemoryTracker::RegisterMetrics() {
+    static const bool registered = [] {
+        struct Series {
+            MemoryTag Tag;
+            MemoryDomain Domain;
+            MetricGauge* Bytes;
+            MetricGauge* Peak;
+            MetricGauge* Budget;
+        };
+        std::vector<Series> series;
+        for (size_t tag = 0; tag < kTagCount; ++tag) {
+            for (size_t domain = 0; domain < kDomainCount; ++domain) {
+                const std::string labels = std::string("tag=\"") + kTagLabels[tag] +
+                                           "\",domain=\"" + kDomainLabels[domain] + "\"";
+                series.push_back(
+                    {static_cast<MemoryTag>(tag), static_cast<MemoryDomain>(domain),
+                     &Metrics::Gauge("se_memory_bytes", "Tracked memory per subsystem", labels),
+                     &Metrics::Gauge("se_memory_peak_bytes", "High-water mark of se_memory_bytes",
+                                     labels),
+                     &Metrics::Gauge("se_memory_budget_bytes", "Memory budget, 0 when unset",
+                                     labels)});
+            }
+        }
+
+        Metrics::AddCollector([series = std::move(series)] {
+            for (const Series& entry : series) {
+                const MemoryUsage usage = GetUsage(entry.Tag, entry.Domain);
+                entry.Bytes->Set(static_cast<double>(usage.Bytes));
+                entry.Peak->Set(static_cast<double>(usage.PeakBytes));
+                entry.Budget->Set(static_cast<double>(usage.BudgetBytes));
+            }
+        });
+        return true;
+    }();
+    (void)registered;
+}
+
+// ========== MemoryAllocation ==========
+
+MemoryAllocation::MemoryAllocation(MemoryTag tag, MemoryDomain domain, uint64_t bytes)
+    : tag_(tag), domain_(domain) {
+    Resize(bytes);
+}
+
+MemoryAllocation::~MemoryAllocation() {
+    Reset();
+}
+
+MemoryAllocation::MemoryAllocation(MemoryAllocation&& other) noexcept
+    : tag_(other.tag_), domain_(other.domain_), bytes_(other.bytes_) {
+    other.bytes_ = 0;
+}
+
+MemoryAllocation& MemoryAllocation::operator=(MemoryAllocation&& other) noexcept {
+    if (this != &other) {
+        Reset();
+        tag_ = other.tag_;
+        domain_ = other.domain_;
+        bytes_ = other.bytes_;
+        other.bytes_ = 0;
+    }
+    return *this;
+}
+
+void MemoryAllocation::Resize(uint64_t bytes) {
+    if (bytes == bytes_)
+        return;
+    if (bytes_ == 0)
+        MemoryTracker::Allocate(tag_, domain_, bytes);
+    else if (bytes == 0)
+        MemoryTracker::Free(tag_, domain_, bytes_);
+    else
+        MemoryTracker::Resize(tag_, domain_, bytes_, bytes);
+    bytes_ = bytes;
+}
+
+} // namespace se
@@ -7,7 +7,7 @@ Mesh::Mesh(const std::vector<float>& vertices, const std::vector<unsigned int>&
 
 Mesh::Mesh(Mesh&& other) noexcept
     : vertices_(std::move(other.vertices_)), indices_(std::move(other.indices_)), vao_(other.vao_),
-      vbo_(other.vbo_), ebo_(other.ebo_) {
+      vbo_(other.vbo_), ebo_(other.ebo_), gpuMemory_(std::move(other.gpuMemory_)) {
     other.vao_ = 0;
     other.vbo_ = 0;
     other.ebo_ = 0;
@@ -29,6 +29,7 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept {
     vao_ = other.vao_;
     vbo_ = other.vbo_;
     ebo_ = other.ebo_;
+    gpuMemory_ = std::move(other.gpuMemory_);
 
     other.vao_ = 0;
     other.vbo_ = 0;
@@ -64,6 +65,9 @@ void Mesh::setupMesh() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_.size() * sizeof(unsigned int), indices_.data(),
                  GL_STATIC_DRAW);
+    gpuMemory_ = se::MemoryAllocation(
+        se::MemoryTag::Meshes, se::MemoryDomain::Gpu,
+        vertices_.size() * sizeof(float) + indices_.size() * sizeof(unsigned int));
 
     // Vertex attributes
     // Position attribute (location = 0, 3 floats)
@@ -0,0 +1,201 @@
+#include "engine/Metrics.h"
+#include "engine/Log.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace se {
+
+namespace {
+enum class MetricType { Counter, Gauge, Histogram };
+
+struct Series {
+    std::string Labels;
+    std::unique_ptr<MetricCounter> Counter;
+    std::unique_ptr<MetricGauge> Gauge;
+    std::unique_ptr<MetricHistogram> Histogram;
+};
+
+struct Family {
+    std::string Help;
+    MetricType Type = MetricType::Counter;
+    std::vector<Series> Entries;
+};
+
+struct Registry {
+    std::mutex Mutex;
+    // Ordered, so snapshots list metrics the same way every time
+    std::map<std::string, Family> Families;
+    std::vector<std::function<void()>> Collectors;
+};
+
+// Never destroyed: call sites hold references to the metrics
+Registry& GetRegistry() {
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+const char* TypeName(MetricType type) {
+    switch (type) {
+        case MetricType::Counter:
+            return "counter";
+        case MetricType::Gauge:
+            return "gauge";
+        case MetricType::Histogram:
+            return "histogram";
+    }
+    return "untyped";
+}
+
+Series& FindSeries(const std::string& name, const std::string& help, const std::string& labels,
+                   MetricType type) {
+    Registry& registry = GetRegistry();
+    auto [it, inserted] = registry.Families.try_emplace(name);
+    Family& family = it->second;
+    if (inserted) {
+        family.Help = help;
+        family.Type = type;
+    } else if (family.Type != type) {
+        throw std::runtime_error("Metric '" + name + "' is already registered as a " +
+                                 TypeName(family.Type));
+    }
+
+    for (Series& series : family.Entries) {
+        if (series.Labels == labels)
+            return series;
+    }
+    family.Entries.emplace_back();
+    family.Entries.back().Labels = labels;
+    return family.Entries.back();
+}
+
+void AppendValue(std::string& out, double value) {
+    // Counts read better without an exponent
+    if (value == std::floor(value) && std::abs(value) < 1e15) {
+        out += std::to_string(static_cast<int64_t>(value));
+        return;
+    }
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void AppendName(std::string& out, const std::string& name, const char* suffix,
+                const std::string& labels, const std::string& extraLabel = "") {
+    out += name;
+    out += suffix;
+    if (labels.empty() && extraLabel.empty())
+        return;
+
+    out += '{';
+    out += labels;
+    if (!labels.empty() && !extraLabel.empty())
+        out += ',';
+    out += extraLabel;
+    out += '}';
+}
+} // namespace
+
+MetricHistogram::MetricHistogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)), buckets_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+    std::sort(bounds_.begin(), bounds_.end());
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::Observe(double value) {
+    const auto bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+MetricCounter& Metrics::Counter(const std::string& name, const std::string& help,
+                                const std::string& labels) {
+    std::lock_guard lock(GetRegistry().Mutex);
+    Series& series = FindSeries(name, help, labels, MetricType::Counter);
+    if (!series.Counter)
+        series.Counter = std::make_unique<MetricCounter>();
+    return *series.Counter;
+}
+
+MetricGauge& Metrics::Gauge(const std::string& name, const std::string& help,
+                            const std::string& labels) {
+    std::lock_guard lock(GetRegistry().Mutex);
+    Series& series = FindSeries(name, help, labels, MetricType::Gauge);
+    if (!series.Gauge)
+        series.Gauge = std::make_unique<MetricGauge>();
+    return *series.Gauge;
+}
+
+MetricHistogram& Metrics::Histogram(const std::string& name, const std::string& help,
+                                    std::vector<double> bounds, const std::string& labels) {
+    std::lock_guard lock(GetRegistry().Mutex);
+    Series& series = FindSeries(name, help, labels, MetricType::Histogram);
+    if (!series.Histogram)
+        series.Histogram = std::make_unique<MetricHistogram>(std::move(bounds));
+    return *series.Histogram;
+}
+
+void Metrics::AddCollector(std::function<void()> collector) {
+    std::lock_guard lock(GetRegistry().Mutex);
+    GetRegistry().Collectors.push_back(std::move(collector));
+}
+
+std::string Metrics::Snapshot() {
+    Registry& registry = GetRegistry();
+
+    // Collectors update metrics themselves, which takes the lock
+    std::vector<std::function<void()>> collectors;
+    {
+        std::lock_guard lock(registry.Mutex);
+        collectors = registry.Collectors;
+    }
+    for (const auto& collector : collectors) {
+        collector();
+    }
+
+    std::string out;
+    std::lock_guard lock(registry.Mutex);
+    for (const auto& [name, family] : registry.Families) {
+        out += "# HELP " + name + " " + family.Help + "\n";
+        out += "# TYPE " + name + " " + TypeName(family.Type) + "\n";
+
+        for (const Series& series : family.Entries) {
+            if (series.Counter || series.Gauge) {
+                AppendName(out, name, "", series.Labels);
+                out += ' ';
+                AppendValue(out, series.Counter ? series.Counter->Get() : series.Gauge->Get());
+                out += '\n';
+                continue;
+            }
+
+            const MetricHistogram& histogram = *series.Histogram;
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i <= histogram.GetBounds().size(); ++i) {
+                cumulative += histogram.GetBucketCount(i);
+                std::string bound = "+Inf";
+                if (i < histogram.GetBounds().size()) {
+                    bound.clear();
+                    AppendValue(bound, histogram.GetBounds()[i]);
+                }
+                AppendName(out, name, "_bucket", series.Labels, "le=\"" + bound + "\"");
+                out += ' ' + std::to_string(cumulative) + '\n';
+            }
+            AppendName(out, name, "_sum", series.Labels);
+            out += ' ';
+            AppendValue(out, histogram.GetSum());
+            out += '\n';
+            AppendName(out, name, "_count", series.Labels);
+            out += ' ' + std::to_string(histogram.GetCount()) + '\n';
+        }
+    }
+    return out;
+}
+
+} // namespace se
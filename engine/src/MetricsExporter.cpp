@@ -0,0 +1,250 @@
+#include "engine/Log.h"
+#include "engine/Metrics.h"
+#include "engine/Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <thread>
+
+#ifdef _WIN32
+#    include <winsock2.h>
+#    include <ws2tcpip.h>
+#    ifndef PSAPI_VERSION
+#        define PSAPI_VERSION 2
+#    endif
+#    include <psapi.h>
+#else
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/select.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif
+
+namespace se {
+
+namespace {
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle kInvalidSocket = INVALID_SOCKET;
+constexpr int kSendFlags = 0;
+void CloseSocket(SocketHandle socket) {
+    closesocket(socket);
+}
+#else
+using SocketHandle = int;
+constexpr SocketHandle kInvalidSocket = -1;
+// A client hanging up mid-response must not raise SIGPIPE
+#    ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#    else
+constexpr int kSendFlags = 0;
+#    endif
+void CloseSocket(SocketHandle socket) {
+    close(socket);
+}
+#endif
+
+// How often the exporter thread checks for connections and Stop
+constexpr long kPollMicroseconds = 100'000;
+
+struct ExporterState {
+    MetricsExporterSettings Settings;
+    std::thread Thread;
+    std::atomic<bool> Stop{false};
+    SocketHandle Listener = kInvalidSocket;
+};
+
+ExporterState* s_Exporter = nullptr;
+
+SocketHandle OpenListener(uint16_t port) {
+    SocketHandle listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == kInvalidSocket)
+        return kInvalidSocket;
+
+    const int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse),
+               sizeof(reuse));
+
+    // Loopback only, the endpoint has no authentication
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 4) != 0) {
+        CloseSocket(listener);
+        return kInvalidSocket;
+    }
+    return listener;
+}
+
+bool WaitReadable(SocketHandle socket, long microseconds) {
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(socket, &readable);
+    timeval timeout{0, microseconds};
+    return select(static_cast<int>(socket) + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+void SendAll(SocketHandle socket, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const auto result =
+            send(socket, data.data() + sent, static_cast<int>(data.size() - sent), kSendFlags);
+        if (result <= 0)
+            return;
+        sent += static_cast<size_t>(result);
+    }
+}
+
+void ServeClient(SocketHandle client) {
+    // A client that connects and sends nothing doesn't get to stall the exporter
+    char request[1024];
+    if (!WaitReadable(client, 1'000'000))
+        return;
+    const auto received = recv(client, request, sizeof(request) - 1, 0);
+    if (received <= 0)
+        return;
+    request[received] = '\0';
+
+    const std::string_view line(request);
+    std::string response;
+    if (line.starts_with("GET /metrics ") || line.starts_with("GET / ")) {
+        const std::string body = Metrics::Snapshot();
+        response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                   "Content-Length: " +
+                   std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    } else {
+        response = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+    SendAll(client, response);
+}
+
+void WriteSnapshot(const std::string& path) {
+    SE_PROFILE_FUNCTION();
+    // Readers never see a half-written file
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << Metrics::Snapshot();
+        if (!file) {
+            SE_LOG_WARN("Metrics: failed to write '{}'", temporary);
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+        SE_LOG_WARN("Metrics: failed to replace '{}': {}", path, error.message());
+}
+
+// Resident set size, 0 where the platform isn't supported
+double ResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<double>(counters.WorkingSetSize);
+#elif defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    double totalPages = 0.0;
+    double residentPages = 0.0;
+    if (statm >> totalPages >> residentPages)
+        return residentPages * static_cast<double>(sysconf(_SC_PAGESIZE));
+#endif
+    return 0.0;
+}
+
+void ExporterLoop(ExporterState& state) {
+    SE_PROFILE_THREAD("Metrics");
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(state.Settings.SnapshotIntervalSeconds));
+    auto nextSnapshot = Clock::now() + interval;
+
+    while (!state.Stop.load(std::memory_order_relaxed)) {
+        if (state.Listener != kInvalidSocket) {
+            if (WaitReadable(state.Listener, kPollMicroseconds)) {
+                const SocketHandle client = accept(state.Listener, nullptr, nullptr);
+                if (client != kInvalidSocket) {
+                    ServeClient(client);
+                    CloseSocket(client);
+                }
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(kPollMicroseconds));
+        }
+
+        if (!state.Settings.SnapshotPath.empty() && Clock::now() >= nextSnapshot) {
+            WriteSnapshot(state.Settings.SnapshotPath);
+            nextSnapshot = Clock::now() + interval;
+        }
+    }
+
+    if (!state.Settings.SnapshotPath.empty())
+        WriteSnapshot(state.Settings.SnapshotPath);
+}
+} // namespace
+
+void Metrics::StartExporter(const MetricsExporterSettings& settings) {
+    if (s_Exporter) {
+        SE_LOG_WARN("Metrics exporter already running");
+        return;
+    }
+    if (settings.SnapshotPath.empty() && settings.HttpPort == 0)
+        return;
+
+    static const bool collectorAdded = [] {
+        MetricGauge& resident =
+            Metrics::Gauge("se_process_resident_bytes", "Resident memory of the process");
+        Metrics::AddCollector([&resident] { resident.Set(ResidentBytes()); });
+        return true;
+    }();
+    (void)collectorAdded;
+
+    s_Exporter = new ExporterState();
+    s_Exporter->Settings = settings;
+    s_Exporter->Settings.SnapshotIntervalSeconds =
+        std::max(settings.SnapshotIntervalSeconds, 1.0f);
+
+    if (settings.HttpPort != 0) {
+#ifdef _WIN32
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+        s_Exporter->Listener = OpenListener(settings.HttpPort);
+        if (s_Exporter->Listener == kInvalidSocket)
+            SE_LOG_ERROR("Metrics: failed to listen on 127.0.0.1:{}", settings.HttpPort);
+        else
+            SE_LOG_INFO("Metrics served on http://127.0.0.1:{}/metrics", settings.HttpPort);
+    }
+    if (!settings.SnapshotPath.empty())
+        SE_LOG_INFO("Metrics snapshot written to '{}' every {:.0f} s", settings.SnapshotPath,
+                    s_Exporter->Settings.SnapshotIntervalSeconds);
+
+    s_Exporter->Thread = std::thread(ExporterLoop, std::ref(*s_Exporter));
+}
+
+void Metrics::StopExporter() {
+    if (!s_Exporter)
+        return;
+
+    s_Exporter->Stop.store(true, std::memory_order_relaxed);
+    s_Exporter->Thread.join();
+
+    if (s_Exporter->Listener != kInvalidSocket)
+        CloseSocket(s_Exporter->Listener);
+#ifdef _WIN32
+    if (s_Exporter->Settings.HttpPort != 0)
+        WSACleanup();
+#endif
+
+    delete s_Exporter;
+    s_Exporter = nullptr;
+}
+
+} // namespace se
@@ -0,0 +1,391 @@
+#include "engine/PerformancePanel.h"
+#include "engine/AllocationTracker.h"
+#include "engine/LinearArena.h"
+#include "engine/MemoryTracker.h"
+#include "engine/RenderThread.h"
+#include "engine/renderer/GpuProfiler.h"
+#include "engine/renderer/SceneRenderer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <imgui.h>
+
+namespace se {
+
+namespace {
+constexpr uint32_t kPhaseCount = 5;
+constexpr const char* kPhaseNames[kPhaseCount] = {"Events", "Update", "Render", "ImGui", "Swap"};
+constexpr ImU32 kPhaseColors[kPhaseCount] = {
+    IM_COL32(120, 120, 200, 255), IM_COL32(90, 180, 90, 255), IM_COL32(220, 150, 60, 255),
+    IM_COL32(180, 90, 180, 255), IM_COL32(80, 170, 200, 255)};
+constexpr ImU32 kOtherColor = IM_COL32(110, 110, 110, 255);
+constexpr ImU32 kHitchColor = IM_COL32(230, 50, 50, 255);
+constexpr uint32_t kMaxListedZones = 256;
+
+float Phase(const FrameTimings& frame, uint32_t phase) {
+    const float phases[kPhaseCount] = {frame.EventsMs, frame.UpdateMs, frame.RenderMs,
+                                       frame.ImGuiMs, frame.SwapMs};
+    return phases[phase];
+}
+
+float Percentile(const std::vector<float>& sorted, float fraction) {
+    const float position = fraction * static_cast<float>(sorted.size() - 1);
+    return sorted[static_cast<size_t>(position + 0.5f)];
+}
+
+void PhaseLegend(const FrameTimings& frame) {
+    for (uint32_t phase = 0; phase < kPhaseCount; ++phase) {
+        ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(kPhaseColors[phase]), "%s %.2f",
+                           kPhaseNames[phase], Phase(frame, phase));
+        ImGui::SameLine();
+    }
+    ImGui::Text("ms");
+}
+
+float Mebibytes(uint64_t bytes) {
+    return static_cast<float>(static_cast<double>(bytes) / (1 << 20));
+}
+} // namespace
+
+void PerformancePanel::RecordFrame(const FrameTimings& frame) {
+    live_.Frames[live_.Next] = frame;
+    live_.Next = (live_.Next + 1) % kHistoryFrames;
+    live_.Count = std::min(live_.Count + 1, kHistoryFrames);
+}
+
+void PerformancePanel::Draw() {
+    if (!open_)
+        return;
+    SE_PROFILE_SCOPE("PerformancePanel::Draw");
+
+    const uint64_t now = Profiler::Now();
+    if (!paused_ && now - lastSummaryNs_ >= kSummaryIntervalNs) {
+        RefreshSummary();
+        lastSummaryNs_ = now;
+    }
+
+    if (!ImGui::Begin("Performance", &open_)) {
+        ImGui::End();
+        return;
+    }
+
+    bool paused = paused_;
+    if (ImGui::Checkbox("Pause", &paused))
+        SetPaused(paused);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(120.0f);
+    if (ImGui::SliderFloat("Hitch factor", &hitchFactor_, 1.25f, 5.0f, "%.2fx") && paused_)
+        RefreshSummary();
+
+    DrawSummary();
+    DrawFrameGraph();
+    DrawSelectedFrame();
+    DrawGpuPasses();
+    DrawMemory();
+
+    ImGui::End();
+}
+
+void PerformancePanel::SetPaused(bool paused) {
+    if (paused && !paused_)
+        frozen_ = live_;
+    paused_ = paused;
+    RefreshSummary();
+}
+
+void PerformancePanel::RefreshSummary() {
+    const History& history = Displayed();
+    summary_ = Summary();
+    if (history.Count == 0)
+        return;
+
+    std::vector<float> times;
+    times.reserve(history.Count);
+    for (uint32_t i = 0; i < history.Count; ++i) {
+        const FrameTimings& frame = history.At(i);
+        times.push_back(frame.FrameMs);
+        summary_.AverageMs += frame.FrameMs;
+        for (uint32_t phase = 0; phase < kPhaseCount; ++phase) {
+            summary_.PhaseMs[phase] += Phase(frame, phase);
+        }
+        summary_.Allocations += static_cast<float>(frame.Allocations);
+        summary_.AllocatedBytes += static_cast<float>(frame.AllocatedBytes);
+        summary_.MaxAllocations = std::max(summary_.MaxAllocations, frame.Allocations);
+    }
+    const float count = static_cast<float>(history.Count);
+    summary_.AverageMs /= count;
+    summary_.Allocations /= count;
+    summary_.AllocatedBytes /= count;
+    for (float& phase : summary_.PhaseMs) {
+        phase /= count;
+    }
+
+    std::sort(times.begin(), times.end());
+    summary_.P50Ms = Percentile(times, 0.50f);
+    summary_.P95Ms = Percentile(times, 0.95f);
+    summary_.P99Ms = Percentile(times, 0.99f);
+    summary_.MaxMs = times.back();
+    summary_.HitchThresholdMs =
+        std::max(summary_.P50Ms * hitchFactor_, summary_.P50Ms + kMinHitchMs);
+
+    // The top bin also collects everything slower than p99
+    summary_.HistogramMaxMs = std::max(summary_.P99Ms * 1.25f, 1.0f);
+    for (float ms : times) {
+        const auto bin = static_cast<uint32_t>(ms / summary_.HistogramMaxMs * kHistogramBins);
+        summary_.Histogram[std::min(bin, kHistogramBins - 1)] += 1.0f;
+        if (ms > summary_.HitchThresholdMs)
+            summary_.Hitches++;
+    }
+}
+
+void PerformancePanel::DrawSummary() {
+    const History& history = Displayed();
+    const float fps = summary_.AverageMs > 0.0f ? 1000.0f / summary_.AverageMs : 0.0f;
+    ImGui::Text("Frame %.2f ms (%.0f FPS)  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f",
+                summary_.AverageMs, fps, summary_.P50Ms, summary_.P95Ms, summary_.P99Ms,
+                summary_.MaxMs);
+    ImGui::Text("Hitches: %u of %u frames over %.2f ms", summary_.Hitches, history.Count,
+                summary_.HitchThresholdMs);
+
+    FrameTimings average;
+    average.EventsMs = summary_.PhaseMs[0];
+    average.UpdateMs = summary_.PhaseMs[1];
+    average.RenderMs = summary_.PhaseMs[2];
+    average.ImGuiMs = summary_.PhaseMs[3];
+    average.SwapMs = summary_.PhaseMs[4];
+    ImGui::Text("CPU:");
+    ImGui::SameLine();
+    PhaseLegend(average);
+    if (AllocationTracker::IsEnabled())
+        ImGui::Text("Allocations: %.1f per frame (%.1f KiB), max %llu", summary_.Allocations,
+                    summary_.AllocatedBytes / 1024.0f,
+                    static_cast<unsigned long long>(summary_.MaxAllocations));
+
+    char overlay[32];
+    snprintf(overlay, sizeof(overlay), "0 - %.1f ms", summary_.HistogramMaxMs);
+    ImGui::PlotHistogram("##FrameHistogram", summary_.Histogram.data(), kHistogramBins, 0,
+                         overlay, 0.0f, FLT_MAX, ImVec2(-1.0f, 50.0f));
+}
+
+void PerformancePanel::DrawFrameGraph() {
+    const History& history = Displayed();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 64.0f);
+    const float height = 120.0f;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 corner(origin.x + width, origin.y + height);
+    ImGui::InvisibleButton("##FrameGraph", ImVec2(width, height));
+
+    // Scaled to the slow tail rather than the worst frame, so one spike doesn't flatten it
+    const float scaleMs = std::max({summary_.P99Ms * 1.5f, summary_.HitchThresholdMs, 20.0f});
+    const float barWidth = width / kHistoryFrames;
+    const uint32_t firstSlot = kHistoryFrames - history.Count;
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, corner, IM_COL32(25, 25, 30, 255));
+    for (uint32_t i = 0; i < history.Count; ++i) {
+        const FrameTimings& frame = history.At(i);
+        const float left = origin.x + static_cast<float>(firstSlot + i) * barWidth;
+        const float right = left + std::max(barWidth - 1.0f, 1.0f);
+
+        float bottom = corner.y;
+        float phasesMs = 0.0f;
+        for (uint32_t phase = 0; phase < kPhaseCount; ++phase) {
+            const float ms = Phase(frame, phase);
+            const float top = std::max(bottom - ms / scaleMs * height, origin.y);
+            drawList->AddRectFilled(ImVec2(left, top), ImVec2(right, bottom), kPhaseColors[phase]);
+            bottom = top;
+            phasesMs += ms;
+        }
+        const float otherTop =
+            std::max(bottom - std::max(frame.FrameMs - phasesMs, 0.0f) / scaleMs * height,
+                     origin.y);
+        drawList->AddRectFilled(ImVec2(left, otherTop), ImVec2(right, bottom), kOtherColor);
+
+        if (frame.FrameMs > summary_.HitchThresholdMs)
+            drawList->AddRectFilled(ImVec2(left, origin.y), ImVec2(right, origin.y + 4.0f),
+                                    kHitchColor);
+        if (hasSelection_ && frame.Index == selected_.Index)
+            drawList->AddRect(ImVec2(left - 1.0f, origin.y), ImVec2(right + 1.0f, corner.y),
+                              IM_COL32(255, 255, 255, 255));
+    }
+
+    for (const float budgetMs : {1000.0f / 60.0f, 1000.0f / 30.0f}) {
+        if (budgetMs >= scaleMs)
+            continue;
+        const float y = corner.y - budgetMs / scaleMs * height;
+        drawList->AddLine(ImVec2(origin.x, y), ImVec2(corner.x, y), IM_COL32(255, 255, 255, 70));
+        char label[16];
+        snprintf(label, sizeof(label), "%.1f ms", budgetMs);
+        drawList->AddText(ImVec2(origin.x + 2.0f, y - ImGui::GetTextLineHeight()),
+                          IM_COL32(255, 255, 255, 120), label);
+    }
+
+    if (!ImGui::IsItemHovered() || history.Count == 0)
+        return;
+
+    const auto slot = static_cast<int>((ImGui::GetIO().MousePos.x - origin.x) / barWidth);
+    if (slot < static_cast<int>(firstSlot) || slot >= static_cast<int>(kHistoryFrames))
+        return;
+
+    const FrameTimings& frame = history.At(static_cast<uint32_t>(slot) - firstSlot);
+    ImGui::BeginTooltip();
+    ImGui::Text("Frame %llu: %.2f ms%s", static_cast<unsigned long long>(frame.Index),
+                frame.FrameMs, frame.FrameMs > summary_.HitchThresholdMs ? " (hitch)" : "");
+    PhaseLegend(frame);
+    ImGui::TextDisabled("Click to pause and inspect");
+    ImGui::EndTooltip();
+
+    if (ImGui::IsItemClicked()) {
+        const FrameTimings clicked = frame;
+        SetPaused(true);
+        SelectFrame(clicked);
+    }
+}
+
+void PerformancePanel::SelectFrame(const FrameTimings& frame) {
+    hasSelection_ = true;
+    selected_ = frame;
+
+    const auto durationNs = static_cast<uint64_t>(static_cast<double>(frame.FrameMs) * 1e6);
+    selectedZones_ = Profiler::CollectZones(frame.StartNs, frame.StartNs + durationNs);
+    for (ProfileThreadZones& thread : selectedZones_) {
+        std::sort(thread.Zones.begin(), thread.Zones.end(),
+                  [](const ProfileZone& a, const ProfileZone& b) {
+                      return a.StartNs < b.StartNs;
+                  });
+    }
+}
+
+void PerformancePanel::DrawSelectedFrame() {
+    if (!hasSelection_)
+        return;
+
+    char header[48];
+    snprintf(header, sizeof(header), "Frame %llu###SelectedFrame",
+             static_cast<unsigned long long>(selected_.Index));
+    if (!ImGui::CollapsingHeader(header, ImGuiTreeNodeFlags_DefaultOpen))
+        return;
+
+    ImGui::Text("%.2f ms", selected_.FrameMs);
+    ImGui::SameLine();
+    PhaseLegend(selected_);
+    if (AllocationTracker::IsEnabled())
+        ImGui::Text("%llu allocations, %.1f KiB",
+                    static_cast<unsigned long long>(selected_.Allocations),
+                    static_cast<double>(selected_.AllocatedBytes) / 1024.0);
+
+#ifndef SE_PROFILING_ENABLED
+    ImGui::TextDisabled("CPU zones need SIMPLEENGINE_ENABLE_PROFILING");
+#else
+    if (selectedZones_.empty())
+        ImGui::TextDisabled("The profiler no longer holds zones for this frame");
+#endif
+
+    for (const ProfileThreadZones& thread : selectedZones_) {
+        if (!ImGui::TreeNode(reinterpret_cast<void*>(static_cast<uintptr_t>(thread.ThreadId)),
+                             "%s (%zu zones)", thread.ThreadName.c_str(), thread.Zones.size()))
+            continue;
+
+        const size_t listed = std::min<size_t>(thread.Zones.size(), kMaxListedZones);
+        for (size_t i = 0; i < listed; ++i) {
+            const ProfileZone& zone = thread.Zones[i];
+            ImGui::Text("%*s%s  %.3f ms", static_cast<int>(zone.Depth * 2), "", zone.Name,
+                        static_cast<double>(zone.EndNs - zone.StartNs) * 1e-6);
+        }
+        if (listed < thread.Zones.size())
+            ImGui::TextDisabled("... %zu more", thread.Zones.size() - listed);
+        ImGui::TreePop();
+    }
+}
+
+void PerformancePanel::DrawGpuPasses() {
+    if (!ImGui::CollapsingHeader("GPU Passes"))
+        return;
+
+    if (ImGui::Checkbox("Profile GPU", &profileGpu_)) {
+        const bool enabled = profileGpu_;
+        RenderThread::Submit([enabled] { GpuProfiler::SetEnabled(enabled); });
+    }
+
+    const RenderStats stats = SceneRenderer::GetStats();
+    if (stats.GpuPasses.empty()) {
+        ImGui::TextDisabled("No GPU timings yet");
+        return;
+    }
+
+    float totalMs = 0.0f;
+    for (const GpuPassStats& pass : stats.GpuPasses) {
+        ImGui::Text("%-14s %6.3f ms  p50 %6.3f  p95 %6.3f  p99 %6.3f", pass.Name,
+                    pass.AverageMs, pass.P50Ms, pass.P95Ms, pass.P99Ms);
+        ImGui::Text("%-14s %llu primitives, %llu samples", "",
+                    static_cast<unsigned long long>(pass.Primitives),
+                    static_cast<unsigned long long>(pass.Samples));
+        totalMs += pass.AverageMs;
+    }
+    ImGui::Text("Total: %.3f ms", totalMs);
+}
+
+void PerformancePanel::DrawMemory() {
+    if (!ImGui::CollapsingHeader("Memory"))
+        return;
+
+    if (ImGui::Button("Reset peaks"))
+        MemoryTracker::ResetPeaks();
+
+    for (uint32_t d = 0; d < static_cast<uint32_t>(MemoryDomain::Count); ++d) {
+        const auto domain = static_cast<MemoryDomain>(d);
+        ImGui::Text("%s: %.2f MiB", MemoryTracker::GetDomainName(domain),
+                    Mebibytes(MemoryTracker::GetTotalBytes(domain)));
+
+        for (uint32_t t = 0; t < static_cast<uint32_t>(MemoryTag::Count); ++t) {
+            const auto tag = static_cast<MemoryTag>(t);
+            const MemoryUsage usage = MemoryTracker::GetUsage(tag, domain);
+            if (usage.PeakBytes == 0 && usage.BudgetBytes == 0)
+                continue;
+
+            const ImVec4 color = MemoryTracker::IsOverBudget(tag, domain)
+                                     ? ImGui::ColorConvertU32ToFloat4(kHitchColor)
+                                     : ImGui::GetStyleColorVec4(ImGuiCol_Text);
+            ImGui::TextColored(color, "  %-14s %9.2f MiB  peak %9.2f MiB  %6llu allocations",
+                               MemoryTracker::GetTagName(tag), Mebibytes(usage.Bytes),
+                               Mebibytes(usage.PeakBytes),
+                               static_cast<unsigned long long>(usage.Allocations));
+            if (usage.BudgetBytes == 0)
+                continue;
+
+            char overlay[48];
+            std::snprintf(overlay, sizeof(overlay), "of %.0f MiB", Mebibytes(usage.BudgetBytes));
+            ImGui::SameLine();
+            ImGui::ProgressBar(static_cast<float>(usage.Bytes) /
+                                   static_cast<float>(usage.BudgetBytes),
+                               ImVec2(140.0f, 0.0f), overlay);
+        }
+    }
+
+    const LinearArena& arena = RenderThread::GetFrameArena();
+    ImGui::Text("Frame arena: %.1f of %.1f KiB, peak %.1f KiB",
+                static_cast<double>(arena.GetUsedBytes()) / 1024.0,
+                static_cast<double>(arena.GetCapacity()) / 1024.0,
+                static_cast<double>(arena.GetPeakBytes()) / 1024.0);
+
+    if (!AllocationTracker::IsEnabled())
+        return;
+
+    ImGui::Text("Heap allocations last frame:");
+    for (const ThreadAllocationCounts& thread : AllocationTracker::GetThreadCounts()) {
+        ImGui::Text("  %-16s %6llu (%8.1f KiB)  total %llu", thread.ThreadName.c_str(),
+                    static_cast<unsigned long long>(thread.LastFrame.Allocations),
+                    static_cast<double>(thread.LastFrame.Bytes) / 1024.0,
+                    static_cast<unsigned long long>(thread.Total.Allocations));
+    }
+
+    int mode = static_cast<int>(AllocationTracker::GetNoAllocMode());
+    ImGui::SetNextItemWidth(120.0f);
+    if (ImGui::Combo("No-alloc scopes", &mode, "Off\0Report\0Abort\0"))
+        AllocationTracker::SetNoAllocMode(static_cast<NoAllocMode>(mode));
+    ImGui::SameLine();
+    ImGui::Text("%llu violations",
+                static_cast<unsigned long long>(AllocationTracker::GetNoAllocViolationCount()));
+}
+
+} // namespace se
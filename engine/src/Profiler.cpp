@@ -0,0 +1,280 @@
+#include "engine/Profiler.h"
+#include "engine/AllocationTracker.h"
+#include "engine/Log.h"
+#include "engine/MemoryTracker.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+namespace se {
+
+namespace {
+struct ThreadBuffer {
+    // Single writer: the owning thread fills Zones[WriteIndex % size] and then publishes
+    // WriteIndex + 1. Readers copy without locking and drop whatever the writer may have
+    // overwritten meanwhile.
+    std::unique_ptr<ProfileZone[]> Zones{new ProfileZone[Profiler::kZonesPerThread]};
+    MemoryAllocation Memory{MemoryTag::Profiling, MemoryDomain::Cpu,
+                            sizeof(ProfileZone) * Profiler::kZonesPerThread};
+    std::atomic<uint64_t> WriteIndex{0};
+
+    uint32_t ThreadId = 0;
+    std::string Name;  // guarded by Registry::Mutex
+    bool InUse = true; // guarded by Registry::Mutex
+};
+
+struct Registry {
+    std::mutex Mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> Threads;
+
+    std::array<std::atomic<uint64_t>, Profiler::kFrameHistory> FrameStarts{};
+    std::atomic<uint64_t> FrameIndex{0};
+
+    std::atomic<uint64_t> CaptureStart{0};
+    std::atomic<bool> Enabled{true};
+};
+
+// Never destroyed: threads may still record while statics are torn down
+Registry& GetRegistry() {
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+// Hands the buffer back when its thread exits, so the next thread reuses it
+struct ThreadRegistration {
+    ThreadBuffer* Buffer = nullptr;
+
+    ~ThreadRegistration() {
+        if (!Buffer)
+            return;
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.Mutex);
+        Buffer->InUse = false;
+    }
+};
+
+thread_local ThreadRegistration t_Registration;
+thread_local uint32_t t_Depth = 0;
+
+ThreadBuffer& GetThreadBuffer() {
+    if (t_Registration.Buffer)
+        return *t_Registration.Buffer;
+
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.Mutex);
+    for (const auto& buffer : registry.Threads) {
+        if (!buffer->InUse) {
+            buffer->InUse = true;
+            buffer->Name.clear();
+            t_Registration.Buffer = buffer.get();
+            return *buffer;
+        }
+    }
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->ThreadId = static_cast<uint32_t>(registry.Threads.size() + 1);
+    t_Registration.Buffer = buffer.get();
+    registry.Threads.push_back(std::move(buffer));
+    return *t_Registration.Buffer;
+}
+
+void CopyZones(const ThreadBuffer& buffer, uint64_t beginNs, uint64_t endNs,
+               std::vector<ProfileZone>& out) {
+    constexpr uint64_t capacity = Profiler::kZonesPerThread;
+    const uint64_t written = buffer.WriteIndex.load(std::memory_order_acquire);
+    const uint64_t first = written > capacity ? written - capacity : 0;
+
+    const size_t offset = out.size();
+    std::vector<uint64_t> indices;
+    for (uint64_t i = first; i < written; ++i) {
+        const ProfileZone& zone = buffer.Zones[i % capacity];
+        if (zone.EndNs >= beginNs && zone.EndNs < endNs) {
+            out.push_back(zone);
+            indices.push_back(i);
+        }
+    }
+
+    // Slots the writer reached while we copied hold newer zones, or torn ones
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t after = buffer.WriteIndex.load(std::memory_order_relaxed);
+    size_t kept = offset;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] + capacity > after)
+            out[kept++] = out[offset + i];
+    }
+    out.resize(kept);
+}
+
+void WriteEscaped(std::ofstream& file, const char* text) {
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\')
+            file << '\\';
+        if (static_cast<unsigned char>(*c) >= 0x20)
+            file << *c;
+    }
+}
+} // namespace
+
+uint64_t Profiler::Now() {
+    using Clock = std::chrono::steady_clock;
+    static const Clock::time_point origin = Clock::now();
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count());
+}
+
+void Profiler::SetEnabled(bool enabled) {
+    GetRegistry().Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::IsEnabled() {
+    return GetRegistry().Enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+    AllocationTracker::SetThreadName(name.c_str());
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard lock(GetRegistry().Mutex);
+    buffer.Name = name;
+}
+
+void Profiler::MarkFrame() {
+    Registry& registry = GetRegistry();
+    const uint64_t frame = registry.FrameIndex.load(std::memory_order_relaxed);
+    registry.FrameStarts[frame % kFrameHistory].store(Now(), std::memory_order_relaxed);
+    registry.FrameIndex.store(frame + 1, std::memory_order_release);
+}
+
+uint64_t Profiler::GetFrameIndex() {
+    return GetRegistry().FrameIndex.load(std::memory_order_acquire);
+}
+
+std::vector<uint64_t> Profiler::GetFrameStarts(uint32_t count) {
+    Registry& registry = GetRegistry();
+    const uint64_t frames = registry.FrameIndex.load(std::memory_order_acquire);
+    const uint64_t available = std::min<uint64_t>({frames, count, kFrameHistory});
+
+    std::vector<uint64_t> starts;
+    starts.reserve(available);
+    for (uint64_t i = frames - available; i < frames; ++i) {
+        starts.push_back(registry.FrameStarts[i % kFrameHistory].load(std::memory_order_relaxed));
+    }
+    return starts;
+}
+
+std::vector<ProfileThreadZones> Profiler::CollectZones(uint64_t beginNs, uint64_t endNs) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.Mutex);
+
+    std::vector<ProfileThreadZones> result;
+    result.reserve(registry.Threads.size());
+    for (const auto& buffer : registry.Threads) {
+        ProfileThreadZones thread;
+        thread.ThreadId = buffer->ThreadId;
+        thread.ThreadName = buffer->Name;
+        CopyZones(*buffer, beginNs, endNs, thread.Zones);
+        if (!thread.Zones.empty())
+            result.push_back(std::move(thread));
+    }
+    return result;
+}
+
+void Profiler::BeginCapture() {
+    // 0 marks no capture, and Now() may still be 0 on the very first call
+    GetRegistry().CaptureStart.store(std::max<uint64_t>(Now(), 1), std::memory_order_relaxed);
+    SE_LOG_INFO("Profiler capture started");
+}
+
+bool Profiler::EndCapture(const std::string& path) {
+    const uint64_t start = GetRegistry().CaptureStart.exchange(0, std::memory_order_relaxed);
+    if (start == 0) {
+        SE_LOG_WARN("Profiler::EndCapture called without a running capture");
+        return false;
+    }
+
+    const std::vector<ProfileThreadZones> threads = CollectZones(start, Now());
+    if (!WriteChromeTrace(path, threads))
+        return false;
+
+    size_t zones = 0;
+    for (const ProfileThreadZones& thread : threads) {
+        zones += thread.Zones.size();
+    }
+    SE_LOG_INFO("Profiler capture of {:.2f} ms written to '{}' ({} zones)",
+                static_cast<double>(Now() - start) * 1e-6, path, zones);
+    return true;
+}
+
+bool Profiler::IsCapturing() {
+    return GetRegistry().CaptureStart.load(std::memory_order_relaxed) != 0;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path,
+                                const std::vector<ProfileThreadZones>& threads,
+                                const std::vector<ProfileCounterSample>& counters) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        SE_LOG_ERROR("Profiler: failed to open '{}' for writing", path);
+        return false;
+    }
+
+    // Timestamps are microseconds in the trace format
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const ProfileThreadZones& thread : threads) {
+        file << (first ? "\n" : ",\n");
+        first = false;
+        file << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << thread.ThreadId
+             << R"(,"args":{"name":")";
+        WriteEscaped(file, thread.ThreadName.empty() ? "Thread" : thread.ThreadName.c_str());
+        file << "\"}}";
+
+        for (const ProfileZone& zone : thread.Zones) {
+            file << ",\n{\"name\":\"";
+            WriteEscaped(file, zone.Name);
+            file << R"(","ph":"X","pid":1,"tid":)" << thread.ThreadId
+                 << ",\"ts\":" << static_cast<double>(zone.StartNs) * 1e-3
+                 << ",\"dur\":" << static_cast<double>(zone.EndNs - zone.StartNs) * 1e-3 << "}";
+        }
+    }
+    for (const ProfileCounterSample& counter : counters) {
+        file << (first ? "\n" : ",\n") << "{\"name\":\"";
+        first = false;
+        WriteEscaped(file, counter.Name);
+        file << R"(","ph":"C","pid":1,"ts":)" << static_cast<double>(counter.TimeNs) * 1e-3
+             << R"(,"args":{"value":)" << counter.Value << "}}";
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        SE_LOG_ERROR("Profiler: failed to write '{}'", path);
+        return false;
+    }
+    return true;
+}
+
+uint32_t Profiler::BeginZone() {
+    return t_Depth++;
+}
+
+void Profiler::EndZone(const char* name, uint64_t startNs, uint32_t depth) {
+    t_Depth = depth;
+    if (!GetRegistry().Enabled.load(std::memory_order_relaxed))
+        return;
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    const uint64_t index = buffer.WriteIndex.load(std::memory_order_relaxed);
+    ProfileZone& zone = buffer.Zones[index % kZonesPerThread];
+    zone.Name = name;
+    zone.StartNs = startNs;
+    zone.EndNs = Now();
+    zone.Depth = depth;
+    buffer.WriteIndex.store(index + 1, std::memory_order_release);
+}
+
+} // namespace se
@@ -0,0 +1,220 @@
+#include "engine/RenderThread.h"
+#include "engine/LinearArena.h"
+#include "engine/Log.h"
+#include "engine/Profiler.h"
+#include "engine/renderer/GraphicsContext.h"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace se {
+
+namespace {
+using Frame = std::vector<std::function<void()>>;
+
+struct RenderThreadState {
+    GraphicsContext* Context = nullptr;
+    std::thread Thread;
+
+    // Single-producer single-consumer ring: the main thread only advances Tail, the render
+    // thread only advances Head. A slot is cleared before Head moves past it, so the producer
+    // can swap its recorded frame in without copying and keeps the cleared vector's capacity.
+    std::array<Frame, RenderThread::kMaxFramesInFlight> Frames;
+    std::array<LinearArena*, RenderThread::kMaxFramesInFlight> FrameArenas{};
+    std::atomic<uint64_t> Head{0}; // next frame to execute
+    std::atomic<uint64_t> Tail{0}; // next slot to fill
+    Frame Recording;
+
+    bool Exit = false; // render thread only
+
+    // First exception thrown by a command; Error is written once, before Failed is set
+    std::exception_ptr Error;
+    std::atomic<bool> Failed{false};
+};
+
+constexpr uint32_t kFrameArenaCount = RenderThread::kMaxFramesInFlight + 1;
+
+std::array<LinearArena, kFrameArenaCount>& FrameArenas() {
+    static std::array<LinearArena, kFrameArenaCount> arenas;
+    return arenas;
+}
+
+RenderThreadState* s_State = nullptr;
+thread_local bool t_IsRenderThread = false;
+uint32_t s_RecordingArena = 0;                    // main thread only
+thread_local LinearArena* t_FrameArena = nullptr; // render thread, frame being executed
+// Objects released while recording with each arena, destroyed once it comes around again
+std::array<std::vector<std::shared_ptr<const void>>, kFrameArenaCount> s_DeferredReleases;
+
+void RenderLoop(RenderThreadState& state) {
+    t_IsRenderThread = true;
+    SE_PROFILE_THREAD("Render");
+    state.Context->MakeCurrent();
+
+    uint64_t head = 0;
+    while (!state.Exit) {
+        {
+            SE_PROFILE_SCOPE("WaitForFrame");
+            state.Tail.wait(head, std::memory_order_acquire);
+        }
+
+        SE_PROFILE_SCOPE("RenderThreadFrame");
+        Frame& frame = state.Frames[head % RenderThread::kMaxFramesInFlight];
+        t_FrameArena = state.FrameArenas[head % RenderThread::kMaxFramesInFlight];
+        try {
+            for (const auto& command : frame) {
+                command();
+            }
+        } catch (...) {
+            if (!state.Failed.load(std::memory_order_relaxed)) {
+                state.Error = std::current_exception();
+                state.Failed.store(true, std::memory_order_release);
+            }
+        }
+        // Closures may own GL resources, they are destroyed here
+        frame.clear();
+        t_FrameArena = nullptr;
+
+        head++;
+        state.Head.store(head, std::memory_order_release);
+        state.Head.notify_one();
+    }
+
+    state.Context->ReleaseCurrent();
+    t_IsRenderThread = false;
+}
+
+void DestroyDeferredReleases() {
+    for (auto& objects : s_DeferredReleases) {
+        objects.clear();
+    }
+}
+
+void PushFrame(RenderThreadState& state) {
+    SE_PROFILE_FUNCTION();
+    const uint64_t tail = state.Tail.load(std::memory_order_relaxed);
+    for (;;) {
+        const uint64_t head = state.Head.load(std::memory_order_acquire);
+        if (tail - head < RenderThread::kMaxFramesInFlight)
+            break;
+        state.Head.wait(head, std::memory_order_acquire);
+    }
+
+    std::swap(state.Frames[tail % RenderThread::kMaxFramesInFlight], state.Recording);
+    state.FrameArenas[tail % RenderThread::kMaxFramesInFlight] =
+        &FrameArenas()[s_RecordingArena];
+    state.Tail.store(tail + 1, std::memory_order_release);
+    state.Tail.notify_one();
+}
+} // namespace
+
+void RenderThread::Start(GraphicsContext& context) {
+    if (s_State) {
+        SE_LOG_WARN("RenderThread already running");
+        return;
+    }
+
+    s_State = new RenderThreadState();
+    s_State->Context = &context;
+
+    // A context is current on one thread at a time
+    context.ReleaseCurrent();
+    s_State->Thread = std::thread(RenderLoop, std::ref(*s_State));
+
+    SE_LOG_INFO("RenderThread started, up to {} frames in flight", kMaxFramesInFlight);
+}
+
+void RenderThread::Stop() {
+    if (t_IsRenderThread)
+        return;
+    if (!s_State) {
+        DestroyDeferredReleases();
+        return;
+    }
+
+    RenderThreadState& state = *s_State;
+    state.Recording.push_back([&state] { state.Exit = true; });
+    PushFrame(state);
+    state.Thread.join();
+
+    state.Context->MakeCurrent();
+    if (state.Failed.load(std::memory_order_acquire) && state.Error)
+        SE_LOG_ERROR("RenderThread stopped after a command failed");
+
+    delete s_State;
+    s_State = nullptr;
+    // Nothing is in flight anymore
+    DestroyDeferredReleases();
+    SE_LOG_INFO("RenderThread stopped");
+}
+
+bool RenderThread::IsRunning() {
+    return s_State != nullptr;
+}
+
+bool RenderThread::IsRenderThread() {
+    return t_IsRenderThread;
+}
+
+void RenderThread::RequireContext(const char* caller) {
+    if (!s_State || t_IsRenderThread)
+        return;
+
+    SE_LOG_ERROR("{} needs the GL context, which belongs to the render thread while it runs; "
+                 "call it before Start, after Stop or from a Submit command",
+                 caller);
+    Logger()->flush();
+    std::abort();
+}
+
+void RenderThread::Submit(std::function<void()> command) {
+    if (!s_State || t_IsRenderThread) {
+        command();
+        return;
+    }
+
+    s_State->Recording.push_back(std::move(command));
+}
+
+void RenderThread::EndFrame() {
+    if (t_IsRenderThread)
+        return;
+
+    if (s_State)
+        PushFrame(*s_State);
+
+    // PushFrame(f) returned once Head >= f + 1 - kMaxFramesInFlight, i.e. every frame before
+    // f - 1 has executed; only f - 1 and f may still be in flight. Arenas rotate through
+    // kFrameArenaCount = kMaxFramesInFlight + 1 slots, so the next one was last recorded into by
+    // frame f - kMaxFramesInFlight, which is done: its arena can be reset and the objects
+    // released while recording it destroyed.
+    s_RecordingArena = (s_RecordingArena + 1) % kFrameArenaCount;
+    FrameArenas()[s_RecordingArena].Reset();
+    if (auto& released = s_DeferredReleases[s_RecordingArena]; !released.empty())
+        Submit([objects = std::move(released)]() mutable { objects.clear(); });
+    s_DeferredReleases[s_RecordingArena].clear();
+
+    // Surface render thread failures where the frame loop can see them
+    if (s_State && s_State->Failed.load(std::memory_order_acquire)) {
+        if (std::exception_ptr error = std::exchange(s_State->Error, nullptr))
+            std::rethrow_exception(error);
+    }
+}
+
+void RenderThread::DeferRelease(std::shared_ptr<const void> object) {
+    if (object)
+        s_DeferredReleases[s_RecordingArena].push_back(std::move(object));
+}
+
+LinearArena& RenderThread::GetFrameArena() {
+    if (t_FrameArena)
+        return *t_FrameArena;
+    return FrameArenas()[s_RecordingArena];
+}
+
+} // namespace se
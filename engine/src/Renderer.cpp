@@ -1,6 +1,7 @@
 #include "engine/Renderer.h"
 #include "engine/Log.h"
 #include "engine/ecs/RenderSystem.h"
+#include "engine/renderer/GpuProfiler.h"
 #include "engine/resources/MaterialManager.h"
 #include "engine/resources/MeshManager.h"
 
@@ -22,6 +23,7 @@ void Renderer::Init() {
 
     // Initialize low-level rendering systems
     RenderCommand::Init();
+    GpuProfiler::Init();
     SceneRenderer::Init();
 
     // Initialize resource managers
@@ -45,12 +47,13 @@ void Renderer::Shutdown() {
     MaterialManager::Shutdown();
     MeshManager::Shutdown();
     SceneRenderer::Shutdown();
+    GpuProfiler::Shutdown();
 
     initialized_ = false;
 }
 
 void Renderer::BeginFrame() {
-    // Any per-frame setup can go here
+    GpuProfiler::BeginFrame();
 }
 
 void Renderer::EndFrame() {
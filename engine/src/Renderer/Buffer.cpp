@@ -30,6 +30,17 @@ static uint32_t ShaderDataTypeSize(ShaderDataType type) {
             return 4 * 4;
         case ShaderDataType::Bool:
             return 1;
+        case ShaderDataType::Half2:
+            return 2 * 2;
+        case ShaderDataType::Half4:
+            return 2 * 4;
+        case ShaderDataType::Byte4:
+        case ShaderDataType::UByte4:
+            return 4;
+        case ShaderDataType::Short2:
+            return 2 * 2;
+        case ShaderDataType::Int2_10_10_10_Rev:
+            return 4;
         default:
             return 0;
     }
@@ -62,6 +73,14 @@ uint32_t BufferElement::GetComponentCount() const {
             return 4;
         case ShaderDataType::Bool:
             return 1;
+        case ShaderDataType::Half2:
+        case ShaderDataType::Short2:
+            return 2;
+        case ShaderDataType::Half4:
+        case ShaderDataType::Byte4:
+        case ShaderDataType::UByte4:
+        case ShaderDataType::Int2_10_10_10_Rev:
+            return 4;
         default:
             return 0;
     }
@@ -86,13 +105,14 @@ void BufferLayout::CalculateOffsetsAndStride() {
 
 // ========== VertexBuffer ==========
 
-VertexBuffer::VertexBuffer(const void* vertices, uint32_t size) {
+VertexBuffer::VertexBuffer(const void* vertices, uint32_t size, MemoryTag tag)
+    : memory_(tag, MemoryDomain::Gpu, size) {
     glGenBuffers(1, &rendererId_);
     glBindBuffer(GL_ARRAY_BUFFER, rendererId_);
     glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
 }
 
-VertexBuffer::VertexBuffer(uint32_t size) {
+VertexBuffer::VertexBuffer(uint32_t size, MemoryTag tag) : memory_(tag, MemoryDomain::Gpu, size) {
     glGenBuffers(1, &rendererId_);
     glBindBuffer(GL_ARRAY_BUFFER, rendererId_);
     glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
@@ -118,10 +138,23 @@ void VertexBuffer::SetData(const void* data, uint32_t size) {
 
 // ========== IndexBuffer ==========
 
-IndexBuffer::IndexBuffer(const uint32_t* indices, uint32_t count) : count_(count) {
+uint32_t IndexTypeToOpenGL(IndexType type) {
+    return type == IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+IndexBuffer::IndexBuffer(const uint32_t* indices, uint32_t count)
+    : IndexBuffer(indices, count, IndexType::UInt32) {}
+
+IndexBuffer::IndexBuffer(const uint16_t* indices, uint32_t count)
+    : IndexBuffer(indices, count, IndexType::UInt16) {}
+
+IndexBuffer::IndexBuffer(const void* indices, uint32_t count, IndexType type, MemoryTag tag)
+    : count_(count), type_(type),
+      memory_(tag, MemoryDomain::Gpu, static_cast<uint64_t>(count) * IndexTypeSize(type)) {
     glGenBuffers(1, &rendererId_);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rendererId_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(count) * IndexTypeSize(type),
+                 indices, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
@@ -137,4 +170,66 @@ void IndexBuffer::Unbind() const {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+// ========== TextureBuffer ==========
+
+TextureBuffer::TextureBuffer(uint32_t internalFormat, MemoryTag tag)
+    : internalFormat_(internalFormat), memory_(tag, MemoryDomain::Gpu) {
+    glGenBuffers(1, &bufferId_);
+    glGenTextures(1, &textureId_);
+
+    // Texture buffers must never be empty
+    capacity_ = 16;
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferId_);
+    glBufferData(GL_TEXTURE_BUFFER, capacity_, nullptr, GL_STREAM_DRAW);
+    memory_.Resize(capacity_);
+
+    glBindTexture(GL_TEXTURE_BUFFER, textureId_);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat_, bufferId_);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+TextureBuffer::~TextureBuffer() {
+    glDeleteTextures(1, &textureId_);
+    glDeleteBuffers(1, &bufferId_);
+}
+
+void TextureBuffer::SetData(const void* data, uint32_t size) {
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferId_);
+    if (size > capacity_) {
+        capacity_ = size + size / 2;
+        memory_.Resize(capacity_);
+    }
+    // Orphan the previous storage so the driver doesn't wait on in-flight frames
+    glBufferData(GL_TEXTURE_BUFFER, capacity_, nullptr, GL_STREAM_DRAW);
+    if (size > 0)
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::Reserve(uint32_t size) {
+    if (size <= capacity_)
+        return;
+
+    capacity_ = size;
+    memory_.Resize(capacity_);
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferId_);
+    glBufferData(GL_TEXTURE_BUFFER, capacity_, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::SetSubData(const void* data, uint32_t size, uint32_t offset) {
+    if (size == 0 || offset + size > capacity_)
+        return;
+
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferId_);
+    glBufferSubData(GL_TEXTURE_BUFFER, offset, size, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::BindTexture(uint32_t slot) const {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_BUFFER, textureId_);
+}
+
 } // namespace se
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "engine/renderer/CommandBuffer.h"
+#include "engine/renderer/VertexArray.h"
+
+namespace se {
+
+namespace {
+// Sub-allocations of one arena share its vertex array object
+const void* VertexBinding(const VertexArray* vertexArray) {
+    if (GeometryArena* arena = vertexArray->GetArena())
+        return arena;
+    return vertexArray;
+}
+} // namespace
+
+void CommandBuffer::Clear() {
+    packets_.clear();
+    material_ = nullptr;
+    blend_ = BlendMode::Opaque;
+    vertexBinding_ = nullptr;
+}
+
+void CommandBuffer::BindPipeline(const Material* material, BlendMode blend) {
+    if (material == material_ && blend == blend_)
+        return;
+
+    material_ = material;
+    blend_ = blend;
+    CommandPacket packet;
+    packet.Type = CommandType::BindPipeline;
+    packet.Pipeline = {material, blend};
+    packets_.push_back(packet);
+}
+
+void CommandBuffer::BindVertexArray(const VertexArray* vertexArray) {
+    const void* binding = VertexBinding(vertexArray);
+    if (binding == vertexBinding_)
+        return;
+
+    vertexBinding_ = binding;
+    CommandPacket packet;
+    packet.Type = CommandType::BindVertexArray;
+    packet.Vertices = {vertexArray};
+    packets_.push_back(packet);
+}
+
+void CommandBuffer::SetDrawData(uint32_t objectIndex, uint32_t objectId,
+                                uint32_t occlusionQuery, bool receiveShadows) {
+    CommandPacket packet;
+    packet.Type = CommandType::SetDrawData;
+    packet.Draw = {objectIndex, objectId, occlusionQuery, receiveShadows};
+    packets_.push_back(packet);
+}
+
+void CommandBuffer::DrawIndexed(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex,
+                                IndexType type) {
+    CommandPacket packet;
+    packet.Type = CommandType::DrawIndexed;
+    packet.Indexed = {indexCount, firstIndex, baseVertex, type};
+    packets_.push_back(packet);
+}
+
+void CommandBuffer::Draw(const VertexArray* vertexArray) {
+    BindVertexArray(vertexArray);
+    DrawIndexed(vertexArray->GetIndexCount(), vertexArray->GetFirstIndex(),
+                vertexArray->GetBaseVertex(), vertexArray->GetIndexType());
+}
+
+} // namespace se
@@ -0,0 +1,53 @@
+#include "engine/renderer/Frustum.h"
+
+namespace se {
+
+AABB AABB::Transformed(const glm::mat4& transform) const {
+    if (!IsValid())
+        return *this;
+
+    // Arvo: the new extents are the absolute rotation/scale applied to the old extents
+    const glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f));
+    const glm::vec3 extents = GetExtents();
+    const glm::mat3 basis(transform);
+    glm::vec3 newExtents(0.0f);
+    for (int column = 0; column < 3; ++column) {
+        newExtents += glm::abs(basis[column]) * extents[column];
+    }
+
+    return AABB{center - newExtents, center + newExtents};
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection) {
+    // Gribb/Hartmann, using the rows of the matrix (glm is column-major)
+    const glm::mat4 m = glm::transpose(viewProjection);
+
+    Frustum frustum;
+    frustum.Planes[0] = m[3] + m[0];
+    frustum.Planes[1] = m[3] - m[0];
+    frustum.Planes[2] = m[3] + m[1];
+    frustum.Planes[3] = m[3] - m[1];
+    frustum.Planes[4] = m[3] + m[2];
+    frustum.Planes[5] = m[3] - m[2];
+
+    for (glm::vec4& plane : frustum.Planes) {
+        const float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+            plane /= length;
+    }
+
+    return frustum;
+}
+
+bool Frustum::Intersects(const glm::vec3& center, const glm::vec3& extents) const {
+    for (const glm::vec4& plane : Planes) {
+        const glm::vec3 normal(plane);
+        const float distance = glm::dot(normal, center) + plane.w;
+        const float radius = glm::dot(glm::abs(normal), extents);
+        if (distance + radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+} // namespace se
@@ -0,0 +1,297 @@
+#include "engine/renderer/GeometryArena.h"
+#include "engine/Log.h"
+#include "engine/Metrics.h"
+#include "engine/RenderThread.h"
+#include <algorithm>
+#include <glad/glad.h>
+
+namespace se {
+
+namespace {
+MetricGauge& ArenaBytes() {
+    static MetricGauge& gauge =
+        Metrics::Gauge("se_geometry_arena_bytes", "GPU memory held by geometry arenas");
+    return gauge;
+}
+} // namespace
+
+// ========== RangeAllocator ==========
+
+RangeAllocator::RangeAllocator(uint32_t capacity) {
+    Grow(capacity);
+}
+
+uint32_t RangeAllocator::Allocate(uint32_t size) {
+    if (size == 0)
+        return kInvalidOffset;
+
+    for (auto it = freeBlocks_.begin(); it != freeBlocks_.end(); ++it) {
+        if (it->Size < size)
+            continue;
+
+        const uint32_t offset = it->Offset;
+        it->Offset += size;
+        it->Size -= size;
+        if (it->Size == 0)
+            freeBlocks_.erase(it);
+
+        freeSize_ -= size;
+        return offset;
+    }
+
+    return kInvalidOffset;
+}
+
+void RangeAllocator::Free(uint32_t offset, uint32_t size) {
+    if (size == 0)
+        return;
+
+    auto next = std::lower_bound(freeBlocks_.begin(), freeBlocks_.end(), offset,
+                                 [](const Block& block, uint32_t value) {
+                                     return block.Offset < value;
+                                 });
+    auto it = freeBlocks_.insert(next, Block{offset, size});
+    freeSize_ += size;
+
+    // Merge with the following block, then with the preceding one
+    auto following = it + 1;
+    if (following != freeBlocks_.end() && it->Offset + it->Size == following->Offset) {
+        it->Size += following->Size;
+        it = freeBlocks_.erase(following) - 1;
+    }
+    if (it != freeBlocks_.begin()) {
+        auto preceding = it - 1;
+        if (preceding->Offset + preceding->Size == it->Offset) {
+            preceding->Size += it->Size;
+            freeBlocks_.erase(it);
+        }
+    }
+}
+
+void RangeAllocator::Grow(uint32_t newCapacity) {
+    if (newCapacity <= capacity_)
+        return;
+
+    const uint32_t oldCapacity = capacity_;
+    capacity_ = newCapacity;
+    Free(oldCapacity, newCapacity - oldCapacity);
+}
+
+void RangeAllocator::Reset(uint32_t usedSize) {
+    freeBlocks_.clear();
+    freeSize_ = 0;
+    if (usedSize < capacity_)
+        Free(usedSize, capacity_ - usedSize);
+}
+
+uint32_t RangeAllocator::GetLargestFreeBlock() const {
+    uint32_t largest = 0;
+    for (const auto& block : freeBlocks_) {
+        largest = std::max(largest, block.Size);
+    }
+    return largest;
+}
+
+// ========== GeometryArena ==========
+
+GeometryArena::GeometryArena(const BufferLayout& layout, uint32_t vertexCapacity,
+                             uint32_t indexCapacity, IndexType indexType)
+    : layout_(layout), indexType_(indexType) {
+    if (layout_.GetStride() == 0) {
+        throw std::runtime_error("Geometry arena needs a vertex layout!");
+    }
+
+    Reallocate(std::max(vertexCapacity, 1u), std::max(indexCapacity, 1u), false);
+}
+
+GeometryArena::~GeometryArena() {
+    ArenaBytes().Add(-static_cast<double>(bufferBytes_));
+}
+
+GeometryArena::AllocationId GeometryArena::Allocate(const void* vertices, uint32_t vertexCount,
+                                                    const uint32_t* indices,
+                                                    uint32_t indexCount) {
+    RenderThread::RequireContext("GeometryArena::Allocate");
+    if (vertexCount == 0 || indexCount == 0)
+        return kInvalidAllocation;
+    if (indexType_ == IndexType::UInt16 && vertexCount > 0x10000)
+        return kInvalidAllocation;
+
+    uint32_t firstVertex = vertexAllocator_.Allocate(vertexCount);
+    uint32_t firstIndex = indexAllocator_.Allocate(indexCount);
+
+    if (firstVertex == RangeAllocator::kInvalidOffset ||
+        firstIndex == RangeAllocator::kInvalidOffset) {
+        if (firstVertex != RangeAllocator::kInvalidOffset)
+            vertexAllocator_.Free(firstVertex, vertexCount);
+        if (firstIndex != RangeAllocator::kInvalidOffset)
+            indexAllocator_.Free(firstIndex, indexCount);
+
+        // Compacting is enough when the free space is only split up, otherwise grow
+        uint32_t vertexCapacity = vertexAllocator_.GetCapacity();
+        uint32_t indexCapacity = indexAllocator_.GetCapacity();
+        if (vertexAllocator_.GetFreeSize() < vertexCount)
+            vertexCapacity = std::max(vertexCapacity * 2, vertexCapacity + vertexCount);
+        if (indexAllocator_.GetFreeSize() < indexCount)
+            indexCapacity = std::max(indexCapacity * 2, indexCapacity + indexCount);
+
+        Reallocate(vertexCapacity, indexCapacity, true);
+
+        firstVertex = vertexAllocator_.Allocate(vertexCount);
+        firstIndex = indexAllocator_.Allocate(indexCount);
+    }
+
+    AllocationId id;
+    if (!freeIds_.empty()) {
+        id = freeIds_.back();
+        freeIds_.pop_back();
+    } else {
+        id = static_cast<AllocationId>(allocations_.size());
+        allocations_.emplace_back();
+    }
+
+    Allocation& allocation = allocations_[id];
+    allocation.Extent.BaseVertex = static_cast<int32_t>(firstVertex);
+    allocation.Extent.FirstIndex = firstIndex;
+    allocation.Extent.VertexCount = vertexCount;
+    allocation.Extent.IndexCount = indexCount;
+    allocation.Live = true;
+
+    const uint32_t stride = layout_.GetStride();
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_->GetRendererId());
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(firstVertex) * stride,
+                    static_cast<GLsizeiptr>(vertexCount) * stride, vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::vector<uint16_t> narrowed;
+    const void* indexData = indices;
+    if (indexType_ == IndexType::UInt16) {
+        narrowed.assign(indices, indices + indexCount);
+        indexData = narrowed.data();
+    }
+
+    // Not through GL_ELEMENT_ARRAY_BUFFER, that would change the bound VAO's index buffer
+    const uint32_t indexSize = IndexTypeSize(indexType_);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer_->GetRendererId());
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(firstIndex) * indexSize,
+                    static_cast<GLsizeiptr>(indexCount) * indexSize, indexData);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return id;
+}
+
+void GeometryArena::Free(AllocationId allocation) {
+    if (allocation >= allocations_.size() || !allocations_[allocation].Live)
+        return;
+
+    Allocation& entry = allocations_[allocation];
+    vertexAllocator_.Free(static_cast<uint32_t>(entry.Extent.BaseVertex),
+                          entry.Extent.VertexCount);
+    indexAllocator_.Free(entry.Extent.FirstIndex, entry.Extent.IndexCount);
+    entry.Live = false;
+    freeIds_.push_back(allocation);
+}
+
+void GeometryArena::Defragment() {
+    Reallocate(vertexAllocator_.GetCapacity(), indexAllocator_.GetCapacity(), true);
+}
+
+float GeometryArena::GetFragmentation() const {
+    const uint32_t freeVertices = vertexAllocator_.GetFreeSize();
+    if (freeVertices == 0)
+        return 0.0f;
+
+    return 1.0f - static_cast<float>(vertexAllocator_.GetLargestFreeBlock()) /
+                      static_cast<float>(freeVertices);
+}
+
+void GeometryArena::Bind() const {
+    vertexArray_->Bind();
+}
+
+void GeometryArena::Reallocate(uint32_t vertexCapacity, uint32_t indexCapacity, bool compact) {
+    RenderThread::RequireContext("GeometryArena::Reallocate");
+    const uint32_t stride = layout_.GetStride();
+    const uint32_t indexSize = IndexTypeSize(indexType_);
+
+    auto vertexBuffer = std::make_shared<VertexBuffer>(vertexCapacity * stride);
+    vertexBuffer->SetLayout(layout_);
+    auto indexBuffer = std::make_shared<IndexBuffer>(nullptr, indexCapacity, indexType_);
+
+    if (vertexBuffer_ && indexBuffer_) {
+        glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer_->GetRendererId());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer->GetRendererId());
+
+        if (compact) {
+            // Vertices keep their relative indices, so only the offsets need to change
+            uint32_t nextVertex = 0;
+            for (auto& allocation : allocations_) {
+                if (!allocation.Live)
+                    continue;
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                    static_cast<GLintptr>(allocation.Extent.BaseVertex) * stride,
+                                    static_cast<GLintptr>(nextVertex) * stride,
+                                    static_cast<GLsizeiptr>(allocation.Extent.VertexCount) *
+                                        stride);
+                allocation.Extent.BaseVertex = static_cast<int32_t>(nextVertex);
+                nextVertex += allocation.Extent.VertexCount;
+            }
+
+            glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer_->GetRendererId());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer->GetRendererId());
+            uint32_t nextIndex = 0;
+            for (auto& allocation : allocations_) {
+                if (!allocation.Live)
+                    continue;
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                    static_cast<GLintptr>(allocation.Extent.FirstIndex) *
+                                        indexSize,
+                                    static_cast<GLintptr>(nextIndex) * indexSize,
+                                    static_cast<GLsizeiptr>(allocation.Extent.IndexCount) *
+                                        indexSize);
+                allocation.Extent.FirstIndex = nextIndex;
+                nextIndex += allocation.Extent.IndexCount;
+            }
+
+            vertexAllocator_.Grow(vertexCapacity);
+            indexAllocator_.Grow(indexCapacity);
+            vertexAllocator_.Reset(nextVertex);
+            indexAllocator_.Reset(nextIndex);
+        } else {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                                static_cast<GLsizeiptr>(vertexAllocator_.GetCapacity()) * stride);
+            glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer_->GetRendererId());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer->GetRendererId());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                                static_cast<GLsizeiptr>(indexAllocator_.GetCapacity()) *
+                                    indexSize);
+
+            vertexAllocator_.Grow(vertexCapacity);
+            indexAllocator_.Grow(indexCapacity);
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        SE_LOG_INFO("Geometry arena reallocated: {} vertices, {} indices{}", vertexCapacity,
+                    indexCapacity, compact ? " (compacted)" : "");
+    } else {
+        vertexAllocator_ = RangeAllocator(vertexCapacity);
+        indexAllocator_ = RangeAllocator(indexCapacity);
+    }
+
+    vertexBuffer_ = vertexBuffer;
+    indexBuffer_ = indexBuffer;
+
+    const uint64_t bufferBytes = static_cast<uint64_t>(vertexCapacity) * stride +
+                                 static_cast<uint64_t>(indexCapacity) * indexSize;
+    ArenaBytes().Add(static_cast<double>(bufferBytes) - static_cast<double>(bufferBytes_));
+    bufferBytes_ = bufferBytes;
+
+    vertexArray_ = std::make_unique<VertexArray>();
+    vertexArray_->AddVertexBuffer(vertexBuffer_);
+    vertexArray_->SetIndexBuffer(indexBuffer_);
+    glBindVertexArray(0);
+}
+
+} // namespace se
@@ -0,0 +1,140 @@
+#include "engine/renderer/GpuCuller.h"
+#include "engine/LinearArena.h"
+#include "engine/Log.h"
+#include "engine/RenderThread.h"
+#include "engine/renderer/GpuScene.h"
+#include "engine/renderer/IndirectDraw.h"
+#include "engine/renderer/shader_v2.h"
+#include <glad/glad.h>
+#include <gtc/type_ptr.hpp>
+#include <memory_resource>
+
+namespace se {
+
+namespace {
+constexpr uint32_t kWorkGroupSize = 64; // local_size_x in cull.comp
+constexpr uint32_t kInvalidProgram = static_cast<uint32_t>(-1);
+} // namespace
+
+bool GpuCuller::IsSupported() {
+    return GLAD_GL_VERSION_4_3 && glDispatchCompute != nullptr;
+}
+
+GpuCuller::GpuCuller() {
+    const auto assets = findAssetsFolder();
+    if (!assets) {
+        SE_LOG_WARN("GpuCuller: assets folder not found, GPU culling disabled");
+        return;
+    }
+
+    const uint32_t program = Renderer::CreateComputeShader(*assets / "shaders" / "cull.comp");
+    if (program == kInvalidProgram) {
+        SE_LOG_WARN("GpuCuller: failed to build cull.comp, GPU culling disabled");
+        return;
+    }
+
+    program_ = program;
+    planesLocation_ = glGetUniformLocation(program_, "uFrustumPlanes");
+    firstCommandLocation_ = glGetUniformLocation(program_, "uFirstCommand");
+    commandCountLocation_ = glGetUniformLocation(program_, "uCommandCount");
+    compactLocation_ = glGetUniformLocation(program_, "uCompact");
+    boundsLocation_ = glGetUniformLocation(program_, "uObjectBounds");
+}
+
+GpuCuller::~GpuCuller() {
+    if (program_)
+        glDeleteProgram(program_);
+}
+
+void GpuCuller::Cull(const IndirectDrawList& list, uint32_t firstCommand, uint32_t commandCount,
+                     const Frustum& frustum) const {
+    if (!program_ || commandCount == 0)
+        return;
+
+    glUseProgram(program_);
+    glUniform4fv(planesLocation_, 6, glm::value_ptr(frustum.Planes[0]));
+    glUniform1ui(firstCommandLocation_, firstCommand);
+    glUniform1ui(commandCountLocation_, commandCount);
+    glUniform1i(compactLocation_, IndirectDrawList::SupportsDrawCount() ? 1 : 0);
+    glUniform1i(boundsLocation_, static_cast<int>(GpuScene::kObjectBoundsSlot));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, list.GetCommandBufferId());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, list.GetInfoBufferId());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, list.GetCulledBufferId());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, list.GetCounterBufferId());
+
+    glDispatchCompute((commandCount + kWorkGroupSize - 1) / kWorkGroupSize, 1, 1);
+
+    for (uint32_t binding = 0; binding < 4; ++binding) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    }
+    glUseProgram(0);
+}
+
+void GpuCuller::Finish() const {
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+uint32_t GpuCuller::Validate(const IndirectDrawList& list, uint32_t firstCommand,
+                             uint32_t commandCount, const Frustum& frustum,
+                             const GpuScene& objects) const {
+    if (!program_ || commandCount == 0)
+        return 0;
+
+    LinearArena& arena = RenderThread::GetFrameArena();
+    std::pmr::vector<uint32_t> counters(list.GetBatchCount(), &arena);
+    glBindBuffer(GL_COPY_READ_BUFFER, list.GetCounterBufferId());
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, counters.size() * sizeof(uint32_t),
+                       counters.data());
+
+    std::pmr::vector<DrawElementsIndirectCommand> culled(commandCount, &arena);
+    glBindBuffer(GL_COPY_READ_BUFFER, list.GetCulledBufferId());
+    glGetBufferSubData(GL_COPY_READ_BUFFER, firstCommand * sizeof(DrawElementsIndirectCommand),
+                       culled.size() * sizeof(DrawElementsIndirectCommand), culled.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    // Which commands the GPU kept, indexed relative to firstCommand
+    std::pmr::vector<bool> gpuVisible(commandCount, false, &arena);
+    if (IndirectDrawList::SupportsDrawCount()) {
+        uint32_t lastBatch = ~0u;
+        for (uint32_t i = 0; i < commandCount; ++i) {
+            const auto& info = list.GetCommandInfo(firstCommand + i);
+            if (info.Batch == lastBatch)
+                continue;
+            lastBatch = info.Batch;
+
+            for (uint32_t slot = 0; slot < counters[info.Batch]; ++slot) {
+                const uint32_t command = culled[info.BatchFirstCommand - firstCommand + slot]
+                                             .BaseInstance;
+                if (command >= firstCommand && command < firstCommand + commandCount)
+                    gpuVisible[command - firstCommand] = true;
+            }
+        }
+    } else {
+        for (uint32_t i = 0; i < commandCount; ++i) {
+            gpuVisible[i] = culled[i].InstanceCount != 0;
+        }
+    }
+
+    uint32_t culledCount = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < commandCount; ++i) {
+        const auto& info = list.GetCommandInfo(firstCommand + i);
+        const AABB& bounds = objects.GetWorldBounds(static_cast<uint32_t>(info.ObjectIndex));
+        const bool expected = !bounds.IsValid() || frustum.Intersects(bounds);
+
+        if (!gpuVisible[i])
+            culledCount++;
+        if (gpuVisible[i] != expected)
+            mismatches++;
+    }
+
+    if (mismatches > 0) {
+        SE_LOG_WARN("GpuCuller: {} of {} commands disagree with the CPU reference", mismatches,
+                    commandCount);
+    }
+
+    return culledCount;
+}
+
+} // namespace se
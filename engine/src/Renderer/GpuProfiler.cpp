@@ -0,0 +1,270 @@
+#include "engine/renderer/GpuProfiler.h"
+#include "engine/Log.h"
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <glad/glad.h>
+
+namespace se {
+
+namespace {
+struct ScopeQueries {
+    GLuint Time = 0;
+    GLuint Primitives = 0;
+    GLuint Samples = 0;
+    uint32_t Pass = 0;
+    bool CountSamples = true;
+};
+
+// Query objects are created on demand and reused every time the slot comes around
+struct FrameSlot {
+    std::vector<ScopeQueries> Scopes;
+    uint32_t ScopeCount = 0;
+    bool Pending = false;
+};
+
+struct PassSample {
+    float Ms = 0.0f;
+    uint64_t Primitives = 0;
+    uint64_t Samples = 0;
+};
+
+struct PassHistory {
+    const char* Name = nullptr;
+    std::array<PassSample, GpuProfiler::kHistoryFrames> Samples{};
+    uint32_t Count = 0;
+    uint32_t Next = 0;
+};
+
+struct ProfilerState {
+    std::array<FrameSlot, GpuProfiler::kFrameLatency> Frames;
+    uint32_t CurrentFrame = 0;
+    bool FrameActive = false;
+    bool Enabled = true;
+
+    uint32_t ScopeDepth = 0;
+    bool ScopeIssued = false;
+
+    std::vector<PassHistory> Passes;
+    // Elements never move, so the names handed out in GpuPassStats stay valid
+    std::deque<std::string> PassNames;
+    // Per-pass totals of the slot being read back, kept to reuse their storage
+    std::vector<PassSample> Totals;
+    std::vector<bool> Ran;
+    uint64_t SkippedFrames = 0;
+};
+
+ProfilerState* s_State = nullptr;
+
+bool IsAvailable(GLuint query) {
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available == GL_TRUE;
+}
+
+uint32_t FindPass(ProfilerState& state, const char* name) {
+    for (uint32_t i = 0; i < state.Passes.size(); ++i) {
+        if (state.PassNames[i] == name)
+            return i;
+    }
+    state.PassNames.push_back(name);
+    state.Passes.emplace_back();
+    state.Passes.back().Name = state.PassNames.back().c_str();
+    return static_cast<uint32_t>(state.Passes.size() - 1);
+}
+
+// Returns false, reading nothing, while any of the slot's results is outstanding
+bool ReadBack(ProfilerState& state, FrameSlot& slot) {
+    for (uint32_t i = 0; i < slot.ScopeCount; ++i) {
+        const ScopeQueries& scope = slot.Scopes[i];
+        if (!IsAvailable(scope.Time) || !IsAvailable(scope.Primitives) ||
+            (scope.CountSamples && !IsAvailable(scope.Samples)))
+            return false;
+    }
+
+    // A pass that ran several times in the frame counts once, with the totals
+    std::vector<PassSample>& totals = state.Totals;
+    std::vector<bool>& ran = state.Ran;
+    totals.assign(state.Passes.size(), PassSample{});
+    ran.assign(state.Passes.size(), false);
+    for (uint32_t i = 0; i < slot.ScopeCount; ++i) {
+        const ScopeQueries& scope = slot.Scopes[i];
+        GLuint64 nanoseconds = 0;
+        GLuint64 primitives = 0;
+        GLuint64 samples = 0;
+        glGetQueryObjectui64v(scope.Time, GL_QUERY_RESULT, &nanoseconds);
+        glGetQueryObjectui64v(scope.Primitives, GL_QUERY_RESULT, &primitives);
+        if (scope.CountSamples)
+            glGetQueryObjectui64v(scope.Samples, GL_QUERY_RESULT, &samples);
+
+        PassSample& total = totals[scope.Pass];
+        total.Ms += static_cast<float>(static_cast<double>(nanoseconds) * 1e-6);
+        total.Primitives += primitives;
+        total.Samples += samples;
+        ran[scope.Pass] = true;
+    }
+
+    for (uint32_t pass = 0; pass < totals.size(); ++pass) {
+        if (!ran[pass])
+            continue;
+        PassHistory& history = state.Passes[pass];
+        history.Samples[history.Next] = totals[pass];
+        history.Next = (history.Next + 1) % GpuProfiler::kHistoryFrames;
+        history.Count = std::min(history.Count + 1, GpuProfiler::kHistoryFrames);
+    }
+
+    slot.Pending = false;
+    slot.ScopeCount = 0;
+    return true;
+}
+
+float Percentile(const float* sorted, uint32_t count, float fraction) {
+    const float position = fraction * static_cast<float>(count - 1);
+    return sorted[static_cast<size_t>(position + 0.5f)];
+}
+} // namespace
+
+void GpuProfiler::Init() {
+    if (s_State) {
+        SE_LOG_WARN("GpuProfiler already initialized");
+        return;
+    }
+
+    s_State = new ProfilerState();
+}
+
+void GpuProfiler::Shutdown() {
+    if (!s_State)
+        return;
+
+    for (FrameSlot& slot : s_State->Frames) {
+        for (ScopeQueries& scope : slot.Scopes) {
+            const GLuint queries[] = {scope.Time, scope.Primitives, scope.Samples};
+            glDeleteQueries(3, queries);
+        }
+    }
+
+    delete s_State;
+    s_State = nullptr;
+}
+
+void GpuProfiler::SetEnabled(bool enabled) {
+    if (s_State)
+        s_State->Enabled = enabled;
+}
+
+bool GpuProfiler::IsEnabled() {
+    return s_State && s_State->Enabled;
+}
+
+void GpuProfiler::BeginFrame() {
+    if (!s_State)
+        return;
+
+    ProfilerState& state = *s_State;
+    if (state.FrameActive) {
+        FrameSlot& finished = state.Frames[state.CurrentFrame];
+        finished.Pending = finished.ScopeCount > 0;
+    }
+
+    // Oldest first, so every pass history stays in frame order
+    for (uint32_t i = 1; i <= kFrameLatency; ++i) {
+        FrameSlot& slot = state.Frames[(state.CurrentFrame + i) % kFrameLatency];
+        if (slot.Pending && !ReadBack(state, slot))
+            break;
+    }
+
+    state.CurrentFrame = (state.CurrentFrame + 1) % kFrameLatency;
+    FrameSlot& slot = state.Frames[state.CurrentFrame];
+    state.FrameActive = state.Enabled && !slot.Pending;
+    if (state.Enabled && slot.Pending)
+        state.SkippedFrames++;
+    if (state.FrameActive)
+        slot.ScopeCount = 0;
+}
+
+void GpuProfiler::BeginScope(const char* name, bool countSamples) {
+    if (!s_State)
+        return;
+
+    ProfilerState& state = *s_State;
+    if (state.ScopeDepth++ > 0 || !state.FrameActive) {
+        if (state.ScopeDepth > 1)
+            SE_LOG_WARN("GpuProfiler: scope '{}' is nested and not measured", name);
+        return;
+    }
+
+    FrameSlot& slot = state.Frames[state.CurrentFrame];
+    if (slot.ScopeCount == slot.Scopes.size()) {
+        ScopeQueries scope;
+        glGenQueries(1, &scope.Time);
+        glGenQueries(1, &scope.Primitives);
+        glGenQueries(1, &scope.Samples);
+        slot.Scopes.push_back(scope);
+    }
+
+    ScopeQueries& scope = slot.Scopes[slot.ScopeCount];
+    scope.Pass = FindPass(state, name);
+    scope.CountSamples = countSamples;
+    glBeginQuery(GL_TIME_ELAPSED, scope.Time);
+    glBeginQuery(GL_PRIMITIVES_GENERATED, scope.Primitives);
+    if (countSamples)
+        glBeginQuery(GL_SAMPLES_PASSED, scope.Samples);
+    state.ScopeIssued = true;
+}
+
+void GpuProfiler::EndScope() {
+    if (!s_State || s_State->ScopeDepth == 0)
+        return;
+
+    ProfilerState& state = *s_State;
+    if (--state.ScopeDepth > 0 || !state.ScopeIssued)
+        return;
+
+    FrameSlot& slot = state.Frames[state.CurrentFrame];
+    const ScopeQueries& scope = slot.Scopes[slot.ScopeCount];
+    if (scope.CountSamples)
+        glEndQuery(GL_SAMPLES_PASSED);
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+    glEndQuery(GL_TIME_ELAPSED);
+    slot.ScopeCount++;
+    state.ScopeIssued = false;
+}
+
+void GpuProfiler::GetPassStats(std::vector<GpuPassStats>& passes) {
+    passes.clear();
+    if (!s_State)
+        return;
+
+    std::array<float, kHistoryFrames> times;
+    for (const PassHistory& history : s_State->Passes) {
+        if (history.Count == 0)
+            continue;
+
+        GpuPassStats& stats = passes.emplace_back();
+        stats.Name = history.Name;
+        uint64_t primitives = 0;
+        uint64_t samples = 0;
+        for (uint32_t i = 0; i < history.Count; ++i) {
+            const PassSample& sample = history.Samples[i];
+            times[i] = sample.Ms;
+            stats.AverageMs += sample.Ms;
+            primitives += sample.Primitives;
+            samples += sample.Samples;
+        }
+        stats.AverageMs /= static_cast<float>(history.Count);
+        stats.Primitives = primitives / history.Count;
+        stats.Samples = samples / history.Count;
+
+        std::sort(times.begin(), times.begin() + history.Count);
+        stats.P50Ms = Percentile(times.data(), history.Count, 0.50f);
+        stats.P95Ms = Percentile(times.data(), history.Count, 0.95f);
+        stats.P99Ms = Percentile(times.data(), history.Count, 0.99f);
+    }
+}
+
+uint64_t GpuProfiler::GetSkippedFrames() {
+    return s_State ? s_State->SkippedFrames : 0;
+}
+
+} // namespace se
@@ -0,0 +1,169 @@
+#include "engine/renderer/GpuScene.h"
+#include "engine/Shader.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <glad/glad.h>
+
+namespace se {
+
+namespace {
+// Dirty slots closer than this are uploaded together, saving calls for a few clean bytes
+constexpr uint32_t kMergeGap = 4;
+// Past this many ranges a single covering upload is cheaper than many small ones
+constexpr uint32_t kMaxUploadRanges = 32;
+} // namespace
+
+GpuScene::GpuScene() {
+    buffer_ = std::make_unique<TextureBuffer>(GL_RGBA32F);
+    boundsBuffer_ = std::make_unique<TextureBuffer>(GL_RGBA32F);
+}
+
+void GpuScene::BeginFrame() {
+    frame_++;
+    uploadedObjects_ = 0;
+}
+
+uint32_t GpuScene::UpdateObject(uint64_t key, const glm::mat4& world, uint32_t materialIndex,
+                                const AABB& localBounds) {
+    uint32_t slot;
+    bool changed = false;
+
+    auto it = slots_.find(key);
+    if (it != slots_.end()) {
+        slot = it->second;
+    } else {
+        if (!freeSlots_.empty()) {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(objects_.size());
+            objects_.emplace_back();
+            bounds_.emplace_back();
+            slotStates_.emplace_back();
+            dirtyFlags_.push_back(false);
+        }
+        slots_.emplace(key, slot);
+        slotStates_[slot].Key = key;
+        slotStates_[slot].Live = true;
+        changed = true;
+    }
+
+    SlotState& state = slotStates_[slot];
+    state.LastFrame = frame_;
+
+    ObjectData& object = objects_[slot];
+    const float material = static_cast<float>(materialIndex);
+    if (changed || object.Misc.x != material ||
+        std::memcmp(&object.World, &world, sizeof(glm::mat4)) != 0 ||
+        std::memcmp(&state.LocalBounds, &localBounds, sizeof(AABB)) != 0) {
+        object.World = world;
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+        for (int column = 0; column < 3; ++column) {
+            object.NormalMatrix[column] = glm::vec4(normalMatrix[column], 0.0f);
+        }
+        object.Misc.x = material;
+
+        state.LocalBounds = localBounds;
+        state.WorldBounds = localBounds.Transformed(world);
+        ObjectBounds& bounds = bounds_[slot];
+        if (state.WorldBounds.IsValid()) {
+            bounds.Center = glm::vec4(state.WorldBounds.GetCenter(), 1.0f);
+            bounds.Extents = glm::vec4(state.WorldBounds.GetExtents(), 1.0f);
+        } else {
+            bounds = ObjectBounds();
+        }
+        MarkDirty(slot);
+    }
+
+    return slot;
+}
+
+void GpuScene::MarkDirty(uint32_t slot) {
+    if (dirtyFlags_[slot])
+        return;
+
+    dirtyFlags_[slot] = true;
+    dirtySlots_.push_back(slot);
+}
+
+void GpuScene::Flush() {
+    // Objects that weren't submitted this frame give their slot back
+    for (auto it = slots_.begin(); it != slots_.end();) {
+        SlotState& state = slotStates_[it->second];
+        if (state.LastFrame != frame_) {
+            state.Live = false;
+            freeSlots_.push_back(it->second);
+            it = slots_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const uint32_t requiredSize = static_cast<uint32_t>(objects_.size() * sizeof(ObjectData));
+    if (requiredSize > buffer_->GetCapacity()) {
+        const uint32_t capacity = std::max(requiredSize, buffer_->GetCapacity() * 2);
+        buffer_->Reserve(capacity);
+        boundsBuffer_->Reserve(capacity / sizeof(ObjectData) * sizeof(ObjectBounds));
+        fullUpload_ = true;
+    }
+
+    if (fullUpload_) {
+        buffer_->SetSubData(objects_.data(), requiredSize, 0);
+        boundsBuffer_->SetSubData(bounds_.data(),
+                                  static_cast<uint32_t>(bounds_.size() * sizeof(ObjectBounds)), 0);
+        uploadedObjects_ += static_cast<uint32_t>(objects_.size());
+        fullUpload_ = false;
+    } else if (!dirtySlots_.empty()) {
+        std::sort(dirtySlots_.begin(), dirtySlots_.end());
+
+        std::array<std::pair<uint32_t, uint32_t>, kMaxUploadRanges> ranges; // [first, last]
+        uint32_t rangeCount = 0;
+        for (uint32_t slot : dirtySlots_) {
+            if (rangeCount > 0 && slot <= ranges[rangeCount - 1].second + kMergeGap) {
+                ranges[rangeCount - 1].second = slot;
+            } else if (rangeCount < kMaxUploadRanges) {
+                ranges[rangeCount++] = {slot, slot};
+            } else {
+                // Too scattered, one upload spanning every dirty slot is cheaper
+                ranges[0] = {dirtySlots_.front(), dirtySlots_.back()};
+                rangeCount = 1;
+                break;
+            }
+        }
+
+        for (uint32_t i = 0; i < rangeCount; ++i) {
+            const auto [first, last] = ranges[i];
+            const uint32_t count = last - first + 1;
+            buffer_->SetSubData(&objects_[first],
+                                static_cast<uint32_t>(count * sizeof(ObjectData)),
+                                static_cast<uint32_t>(first * sizeof(ObjectData)));
+            boundsBuffer_->SetSubData(&bounds_[first],
+                                      static_cast<uint32_t>(count * sizeof(ObjectBounds)),
+                                      static_cast<uint32_t>(first * sizeof(ObjectBounds)));
+            uploadedObjects_ += count;
+        }
+    }
+
+    for (uint32_t slot : dirtySlots_) {
+        dirtyFlags_[slot] = false;
+    }
+    dirtySlots_.clear();
+}
+
+void GpuScene::BindTexture() const {
+    buffer_->BindTexture(kObjectDataSlot);
+    boundsBuffer_->BindTexture(kObjectBoundsSlot);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void GpuScene::SetUniforms(const Shader& shader) const {
+    shader.setInt("uObjectData", static_cast<int>(kObjectDataSlot));
+}
+
+void GpuScene::SetObjectIndex(uint32_t index) {
+    // With the attribute array disabled, the vertex shader reads this current value
+    glVertexAttribI4i(kObjectIndexAttributeLocation, static_cast<GLint>(index), 0, 0, 0);
+}
+
+} // namespace se
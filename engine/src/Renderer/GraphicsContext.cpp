@@ -32,4 +32,12 @@ void GraphicsContext::SwapBuffers() {
     glfwSwapBuffers(windowHandle_);
 }
 
+void GraphicsContext::MakeCurrent() {
+    glfwMakeContextCurrent(windowHandle_);
+}
+
+void GraphicsContext::ReleaseCurrent() {
+    glfwMakeContextCurrent(nullptr);
+}
+
 } // namespace se
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "engine/renderer/IndirectDraw.h"
+#include "engine/renderer/GeometryArena.h"
+#include "engine/renderer/GpuScene.h"
+#include "engine/renderer/VertexArray.h"
+#include <glad/glad.h>
+
+namespace se {
+
+namespace {
+// Orphans the buffer storage every frame; grows by 50% when the data doesn't fit
+void UploadStreamBuffer(GLenum target, uint32_t buffer, uint32_t& capacity, const void* data,
+                        uint32_t size, GLenum usage = GL_STREAM_DRAW) {
+    glBindBuffer(target, buffer);
+    if (size > capacity)
+        capacity = size + size / 2;
+    glBufferData(target, capacity, nullptr, usage);
+    if (size > 0 && data)
+        glBufferSubData(target, 0, size, data);
+    glBindBuffer(target, 0);
+}
+} // namespace
+
+bool IndirectDrawList::IsSupported() {
+    return GLAD_GL_VERSION_4_3 && glMultiDrawElementsIndirect != nullptr;
+}
+
+bool IndirectDrawList::SupportsDrawCount() {
+    return GLAD_GL_VERSION_4_6 && glMultiDrawElementsIndirectCount != nullptr;
+}
+
+IndirectDrawList::IndirectDrawList() {
+    glGenBuffers(1, &commandBufferId_);
+    glGenBuffers(1, &infoBufferId_);
+    glGenBuffers(1, &culledBufferId_);
+    glGenBuffers(1, &counterBufferId_);
+}
+
+IndirectDrawList::~IndirectDrawList() {
+    glDeleteBuffers(1, &commandBufferId_);
+    glDeleteBuffers(1, &infoBufferId_);
+    glDeleteBuffers(1, &culledBufferId_);
+    glDeleteBuffers(1, &counterBufferId_);
+}
+
+void IndirectDrawList::Clear() {
+    commands_.clear();
+    infos_.clear();
+    batches_.clear();
+}
+
+uint32_t IndirectDrawList::BeginBatch() {
+    BatchRange batch;
+    batch.FirstCommand = static_cast<uint32_t>(commands_.size());
+    batches_.push_back(batch);
+    return static_cast<uint32_t>(batches_.size() - 1);
+}
+
+uint32_t IndirectDrawList::Add(const VertexArray& vertexArray, uint32_t objectIndex) {
+    const uint32_t index = static_cast<uint32_t>(commands_.size());
+
+    DrawElementsIndirectCommand command;
+    command.Count = vertexArray.GetIndexCount();
+    command.InstanceCount = 1;
+    command.FirstIndex = vertexArray.GetFirstIndex();
+    command.BaseVertex = vertexArray.GetBaseVertex();
+    command.BaseInstance = index;
+
+    if (batches_.empty())
+        BeginBatch();
+
+    BatchRange& batch = batches_.back();
+    batch.CommandCount++;
+
+    CommandInfo info;
+    info.ObjectIndex = static_cast<int32_t>(objectIndex);
+    info.Batch = static_cast<uint32_t>(batches_.size() - 1);
+    info.BatchFirstCommand = batch.FirstCommand;
+
+    commands_.push_back(command);
+    infos_.push_back(info);
+    return index;
+}
+
+void IndirectDrawList::Upload() {
+    UploadStreamBuffer(
+        GL_DRAW_INDIRECT_BUFFER, commandBufferId_, commandCapacity_, commands_.data(),
+        static_cast<uint32_t>(commands_.size() * sizeof(DrawElementsIndirectCommand)));
+    UploadStreamBuffer(GL_ARRAY_BUFFER, infoBufferId_, infoCapacity_, infos_.data(),
+                       static_cast<uint32_t>(infos_.size() * sizeof(CommandInfo)));
+    batchCounters_.assign(batches_.size(), 0);
+    UploadStreamBuffer(GL_ARRAY_BUFFER, counterBufferId_, counterCapacity_,
+                       batchCounters_.data(),
+                       static_cast<uint32_t>(batchCounters_.size() * sizeof(uint32_t)),
+                       GL_DYNAMIC_COPY);
+    // Written by the culling shader, only needs storage
+    UploadStreamBuffer(GL_ARRAY_BUFFER, culledBufferId_, culledCapacity_, nullptr,
+                       static_cast<uint32_t>(commands_.size() *
+                                             sizeof(DrawElementsIndirectCommand)),
+                       GL_DYNAMIC_COPY);
+    memory_.Resize(static_cast<uint64_t>(commandCapacity_) + infoCapacity_ + counterCapacity_ +
+                   culledCapacity_);
+}
+
+void IndirectDrawList::BindObjectIndexStream() const {
+    // The object index stream is attached only for the duration of the multi-draw, regular
+    // draws from the same VAO read the constant value set by GpuScene::SetObjectIndex
+    const uint32_t location = GpuScene::kObjectIndexAttributeLocation;
+    glBindBuffer(GL_ARRAY_BUFFER, infoBufferId_);
+    glEnableVertexAttribArray(location);
+    glVertexAttribIPointer(location, 1, GL_INT, sizeof(CommandInfo), nullptr);
+    glVertexAttribDivisor(location, 1);
+}
+
+void IndirectDrawList::Draw(const GeometryArena& arena, uint32_t first, uint32_t count) const {
+    if (count == 0)
+        return;
+
+    arena.Bind();
+    BindObjectIndexStream();
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBufferId_);
+    glMultiDrawElementsIndirect(
+        GL_TRIANGLES, IndexTypeToOpenGL(arena.GetIndexType()),
+        reinterpret_cast<const void*>(sizeof(DrawElementsIndirectCommand) * first),
+        static_cast<GLsizei>(count), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    glDisableVertexAttribArray(GpuScene::kObjectIndexAttributeLocation);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void IndirectDrawList::DrawCulled(const GeometryArena& arena, uint32_t batch) const {
+    const uint32_t first = batches_[batch].FirstCommand;
+    const uint32_t count = batches_[batch].CommandCount;
+    if (count == 0)
+        return;
+
+    arena.Bind();
+    BindObjectIndexStream();
+
+    const GLenum indexType = IndexTypeToOpenGL(arena.GetIndexType());
+    const void* offset =
+        reinterpret_cast<const void*>(sizeof(DrawElementsIndirectCommand) * first);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culledBufferId_);
+    if (SupportsDrawCount()) {
+        glBindBuffer(GL_PARAMETER_BUFFER, counterBufferId_);
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, indexType, offset,
+                                         static_cast<GLintptr>(sizeof(uint32_t) * batch),
+                                         static_cast<GLsizei>(count), 0);
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    } else {
+        glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, offset, static_cast<GLsizei>(count),
+                                    0);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    glDisableVertexAttribArray(GpuScene::kObjectIndexAttributeLocation);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+} // namespace se
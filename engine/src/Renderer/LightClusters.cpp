@@ -0,0 +1,273 @@
+#include "engine/renderer/LightClusters.h"
+#include "engine/JobSystem.h"
+#include "engine/Shader.h"
+#include <algorithm>
+#include <cmath>
+#include <glad/glad.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#    include <emmintrin.h>
+#    define SE_LIGHT_CLUSTERS_SSE 1
+#endif
+
+namespace se {
+
+// ========== LightSpheres ==========
+
+void LightClusterer::LightSpheres::Clear() {
+    X.clear();
+    Y.clear();
+    Z.clear();
+    Radius.clear();
+    Index.clear();
+}
+
+void LightClusterer::LightSpheres::Reserve(uint32_t count) {
+    const uint32_t padded = (count + 3) & ~3u;
+    X.reserve(padded);
+    Y.reserve(padded);
+    Z.reserve(padded);
+    Radius.reserve(padded);
+    Index.reserve(count);
+}
+
+void LightClusterer::LightSpheres::Push(const glm::vec3& center, float radius, uint32_t index) {
+    X.push_back(center.x);
+    Y.push_back(center.y);
+    Z.push_back(center.z);
+    Radius.push_back(radius);
+    Index.push_back(index);
+}
+
+void LightClusterer::LightSpheres::Pad() {
+    // Padding spheres are far away with a negative radius so they never intersect
+    while (X.size() % 4 != 0) {
+        X.push_back(1e30f);
+        Y.push_back(1e30f);
+        Z.push_back(1e30f);
+        Radius.push_back(-1.0f);
+    }
+}
+
+// ========== LightClusterer ==========
+
+LightClusterer::LightClusterer() {
+    clusterBounds_.resize(kClusterCount);
+    clusterRanges_.resize(kClusterCount);
+    sliceLights_.resize(kGridZ);
+    sliceIndices_.resize(kGridZ);
+
+    lightDataBuffer_ = std::make_unique<TextureBuffer>(GL_RGBA32F);
+    clusterBuffer_ = std::make_unique<TextureBuffer>(GL_RG32UI);
+    indexBuffer_ = std::make_unique<TextureBuffer>(GL_R32UI);
+}
+
+void LightClusterer::UpdateClusterBounds(const glm::mat4& projection) {
+    if (projection == cachedProjection_)
+        return;
+
+    cachedProjection_ = projection;
+    near_ = projection[3][2] / (projection[2][2] - 1.0f);
+    far_ = projection[3][2] / (projection[2][2] + 1.0f);
+
+    const glm::mat4 inverseProjection = glm::inverse(projection);
+
+    // View-space ray through an NDC position, scaled so that z = -1
+    auto tileRay = [&](float ndcX, float ndcY) {
+        glm::vec4 p = inverseProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+        glm::vec3 v = glm::vec3(p) / p.w;
+        return v / -v.z;
+    };
+
+    for (uint32_t z = 0; z < kGridZ; ++z) {
+        const float sliceNear =
+            near_ * std::pow(far_ / near_, static_cast<float>(z) / static_cast<float>(kGridZ));
+        const float sliceFar = near_ * std::pow(far_ / near_, static_cast<float>(z + 1) /
+                                                                  static_cast<float>(kGridZ));
+
+        for (uint32_t y = 0; y < kGridY; ++y) {
+            const float ndcY0 = -1.0f + 2.0f * static_cast<float>(y) / kGridY;
+            const float ndcY1 = -1.0f + 2.0f * static_cast<float>(y + 1) / kGridY;
+
+            for (uint32_t x = 0; x < kGridX; ++x) {
+                const float ndcX0 = -1.0f + 2.0f * static_cast<float>(x) / kGridX;
+                const float ndcX1 = -1.0f + 2.0f * static_cast<float>(x + 1) / kGridX;
+
+                const glm::vec3 rays[4] = {tileRay(ndcX0, ndcY0), tileRay(ndcX1, ndcY0),
+                                           tileRay(ndcX0, ndcY1), tileRay(ndcX1, ndcY1)};
+
+                ClusterBounds bounds{glm::vec3(1e30f), glm::vec3(-1e30f)};
+                for (const glm::vec3& ray : rays) {
+                    bounds.Min = glm::min(bounds.Min, glm::min(ray * sliceNear, ray * sliceFar));
+                    bounds.Max = glm::max(bounds.Max, glm::max(ray * sliceNear, ray * sliceFar));
+                }
+
+                clusterBounds_[x + y * kGridX + z * kGridX * kGridY] = bounds;
+            }
+        }
+    }
+}
+
+void LightClusterer::Build(std::span<const LocalLightData> lights, const glm::mat4& view,
+                           const glm::mat4& projection) {
+    UpdateClusterBounds(projection);
+
+    lightCount_ = static_cast<uint32_t>(lights.size());
+    lightData_.clear();
+    lightSpheres_.Clear();
+
+    for (uint32_t i = 0; i < lightCount_; ++i) {
+        const LocalLightData& light = lights[i];
+        const glm::vec3 direction = glm::length(light.Direction) > 0.0f
+                                        ? glm::normalize(light.Direction)
+                                        : glm::vec3(0.0f, -1.0f, 0.0f);
+
+        lightData_.emplace_back(light.Position, light.Range);
+        lightData_.emplace_back(light.Color * light.Intensity, static_cast<float>(light.Type));
+        lightData_.emplace_back(direction, light.OuterConeCos);
+        lightData_.emplace_back(light.InnerConeCos, 0.0f, 0.0f, 0.0f);
+
+        const glm::vec3 center = glm::vec3(view * glm::vec4(light.Position, 1.0f));
+        lightSpheres_.Push(center, light.Range, i);
+    }
+
+    // A slice never holds more candidates than there are lights, nor more indices than its
+    // tiles can reference, so the workers only ever fill capacity reserved here
+    if (lightCount_ > sliceCapacity_) {
+        sliceCapacity_ = lightCount_;
+        const uint32_t maxIndices = kGridX * kGridY * std::min(lightCount_, kMaxLightsPerCluster);
+        for (uint32_t z = 0; z < kGridZ; ++z) {
+            sliceLights_[z].Reserve(sliceCapacity_);
+            sliceIndices_[z].reserve(maxIndices);
+        }
+    }
+
+    JobSystem::ParallelFor(kGridZ, 1, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t slice = begin; slice < end; ++slice) {
+            AssignSlice(slice);
+        }
+    });
+
+    // Stitch the per-slice index lists together and rebase the cluster offsets
+    lightIndices_.clear();
+    for (uint32_t z = 0; z < kGridZ; ++z) {
+        const uint32_t base = static_cast<uint32_t>(lightIndices_.size());
+        const uint32_t firstCluster = z * kGridX * kGridY;
+        for (uint32_t c = 0; c < kGridX * kGridY; ++c) {
+            clusterRanges_[firstCluster + c].x += base;
+        }
+        lightIndices_.insert(lightIndices_.end(), sliceIndices_[z].begin(), sliceIndices_[z].end());
+    }
+}
+
+void LightClusterer::AssignSlice(uint32_t slice) {
+    const uint32_t firstCluster = slice * kGridX * kGridY;
+    std::vector<uint32_t>& indices = sliceIndices_[slice];
+    indices.clear();
+
+    // Coarse pass: keep only lights that overlap this slice's depth range
+    LightSpheres& candidates = sliceLights_[slice];
+    candidates.Clear();
+    const ClusterBounds& sliceBounds = clusterBounds_[firstCluster];
+    for (uint32_t i = 0; i < lightSpheres_.Size(); ++i) {
+        const float z = lightSpheres_.Z[i];
+        const float r = lightSpheres_.Radius[i];
+        if (z - r <= sliceBounds.Max.z && z + r >= sliceBounds.Min.z) {
+            candidates.Push({lightSpheres_.X[i], lightSpheres_.Y[i], z}, r, lightSpheres_.Index[i]);
+        }
+    }
+    candidates.Pad();
+
+    const uint32_t candidateCount = candidates.Size();
+
+    for (uint32_t tile = 0; tile < kGridX * kGridY; ++tile) {
+        const uint32_t cluster = firstCluster + tile;
+        const ClusterBounds& bounds = clusterBounds_[cluster];
+        const uint32_t offset = static_cast<uint32_t>(indices.size());
+        uint32_t count = 0;
+
+        if (candidateCount > 0) {
+#if SE_LIGHT_CLUSTERS_SSE
+            // Sphere vs AABB for four lights at a time
+            const __m128 minX = _mm_set1_ps(bounds.Min.x);
+            const __m128 minY = _mm_set1_ps(bounds.Min.y);
+            const __m128 minZ = _mm_set1_ps(bounds.Min.z);
+            const __m128 maxX = _mm_set1_ps(bounds.Max.x);
+            const __m128 maxY = _mm_set1_ps(bounds.Max.y);
+            const __m128 maxZ = _mm_set1_ps(bounds.Max.z);
+            const __m128 zero = _mm_setzero_ps();
+
+            for (uint32_t i = 0; i < candidateCount && count < kMaxLightsPerCluster; i += 4) {
+                const __m128 cx = _mm_loadu_ps(&candidates.X[i]);
+                const __m128 cy = _mm_loadu_ps(&candidates.Y[i]);
+                const __m128 cz = _mm_loadu_ps(&candidates.Z[i]);
+                const __m128 r = _mm_loadu_ps(&candidates.Radius[i]);
+
+                const __m128 dx =
+                    _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, cx), _mm_sub_ps(cx, maxX)), zero);
+                const __m128 dy =
+                    _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, cy), _mm_sub_ps(cy, maxY)), zero);
+                const __m128 dz =
+                    _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, cz), _mm_sub_ps(cz, maxZ)), zero);
+                const __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                                 _mm_mul_ps(dz, dz));
+                const __m128 hit = _mm_and_ps(_mm_cmple_ps(distSq, _mm_mul_ps(r, r)),
+                                              _mm_cmpge_ps(r, zero));
+
+                const int mask = _mm_movemask_ps(hit);
+                for (int lane = 0; mask && lane < 4 && count < kMaxLightsPerCluster; ++lane) {
+                    if (mask & (1 << lane)) {
+                        indices.push_back(candidates.Index[i + lane]);
+                        count++;
+                    }
+                }
+            }
+#else
+            for (uint32_t i = 0; i < candidateCount && count < kMaxLightsPerCluster; ++i) {
+                const float r = candidates.Radius[i];
+                if (r < 0.0f)
+                    continue;
+                const glm::vec3 c(candidates.X[i], candidates.Y[i], candidates.Z[i]);
+                const glm::vec3 d = glm::max(glm::max(bounds.Min - c, c - bounds.Max), 0.0f);
+                if (glm::dot(d, d) <= r * r) {
+                    indices.push_back(candidates.Index[i]);
+                    count++;
+                }
+            }
+#endif
+        }
+
+        clusterRanges_[cluster] = glm::uvec2(offset, count);
+    }
+}
+
+void LightClusterer::Upload() {
+    lightDataBuffer_->SetData(lightData_.data(),
+                              static_cast<uint32_t>(lightData_.size() * sizeof(glm::vec4)));
+    clusterBuffer_->SetData(clusterRanges_.data(),
+                            static_cast<uint32_t>(clusterRanges_.size() * sizeof(glm::uvec2)));
+    indexBuffer_->SetData(lightIndices_.data(),
+                          static_cast<uint32_t>(lightIndices_.size() * sizeof(uint32_t)));
+}
+
+void LightClusterer::BindTextures() const {
+    lightDataBuffer_->BindTexture(kLightDataSlot);
+    clusterBuffer_->BindTexture(kClusterSlot);
+    indexBuffer_->BindTexture(kIndexSlot);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void LightClusterer::SetUniforms(const Shader& shader, const glm::vec2& viewportSize) const {
+    const float zScale = static_cast<float>(kGridZ) / std::log(far_ / near_);
+
+    shader.setInt("uLightData", static_cast<int>(kLightDataSlot));
+    shader.setInt("uLightClusters", static_cast<int>(kClusterSlot));
+    shader.setInt("uLightIndices", static_cast<int>(kIndexSlot));
+    shader.setInt("uLocalLightCount", static_cast<int>(lightCount_));
+    shader.setIVec3("uClusterGrid", glm::ivec3(kGridX, kGridY, kGridZ));
+    shader.setVec2("uViewportSize", viewportSize);
+    shader.setFloat("uClusterZScale", zScale);
+    shader.setFloat("uClusterZBias", -std::log(near_) * zScale);
+}
+
+} // namespace se
@@ -1,7 +1,10 @@
 #include "engine/renderer/Material.h"
 
 namespace se {
-Material::Material(const std::shared_ptr<Shader>& shader) : shader_(shader) {}
+static uint32_t s_NextMaterialId = 0;
+
+Material::Material(const std::shared_ptr<Shader>& shader)
+    : shader_(shader), id_(s_NextMaterialId++) {}
 
 void Material::Bind() const {
     shader_->bind();
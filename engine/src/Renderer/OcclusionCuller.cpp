@@ -0,0 +1,314 @@
+#include "engine/renderer/OcclusionCuller.h"
+#include "engine/JobSystem.h"
+#include "engine/Mesh.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#    include <emmintrin.h>
+#    define SE_OCCLUSION_SSE 1
+#endif
+
+namespace se {
+
+namespace {
+constexpr float kMinClipW = 1e-4f;
+// Depth hierarchy texels read per axis when testing a box, picks the level
+constexpr uint32_t kMaxTestTexels = 4;
+
+bool IsInFrontOfNearPlane(const glm::vec4& clip) {
+    return clip.w > kMinClipW && clip.z >= -clip.w;
+}
+} // namespace
+
+// ========== OccluderMesh ==========
+
+OccluderMesh OccluderMesh::CreateBox(const glm::vec3& min, const glm::vec3& max) {
+    OccluderMesh mesh;
+    for (uint32_t i = 0; i < 8; ++i) {
+        mesh.Positions.emplace_back(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y,
+                                    i & 4 ? max.z : min.z);
+    }
+    // Two triangles per face, winding doesn't matter to the rasterizer
+    mesh.Indices = {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1,
+                    2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3};
+    return mesh;
+}
+
+OccluderMesh OccluderMesh::FromMesh(const Mesh& mesh) {
+    constexpr size_t kFloatsPerVertex = 9;
+
+    OccluderMesh occluder;
+    const std::vector<float>& vertices = mesh.getVertices();
+    occluder.Positions.reserve(vertices.size() / kFloatsPerVertex);
+    for (size_t i = 0; i + 2 < vertices.size(); i += kFloatsPerVertex) {
+        occluder.Positions.emplace_back(vertices[i], vertices[i + 1], vertices[i + 2]);
+    }
+    occluder.Indices.assign(mesh.getIndices().begin(), mesh.getIndices().end());
+    return occluder;
+}
+
+// ========== OcclusionCuller ==========
+
+OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height) {
+    Resize(width, height);
+}
+
+void OcclusionCuller::Resize(uint32_t width, uint32_t height) {
+    tilesX_ = std::max((width + kTileWidth - 1) / kTileWidth, 1u);
+    tilesY_ = std::max((height + kTileHeight - 1) / kTileHeight, 1u);
+    width_ = tilesX_ * kTileWidth;
+    height_ = tilesY_ * kTileHeight;
+
+    depth_.assign(static_cast<size_t>(width_) * height_, 1.0f);
+    tileBins_.assign(static_cast<size_t>(tilesX_) * tilesY_, {});
+
+    hierarchy_.clear();
+    hierarchySizes_.clear();
+    glm::uvec2 size(width_, height_);
+    while (size.x > 1 || size.y > 1) {
+        size = (size + 1u) / 2u;
+        hierarchySizes_.push_back(size);
+        hierarchy_.emplace_back(static_cast<size_t>(size.x) * size.y, 1.0f);
+    }
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection) {
+    viewProjection_ = viewProjection;
+    std::fill(depth_.begin(), depth_.end(), 1.0f);
+    triangles_.clear();
+}
+
+void OcclusionCuller::AddOccluder(const OccluderMesh& mesh, const glm::mat4& transform) {
+    const glm::mat4 mvp = viewProjection_ * transform;
+
+    clip_.clear();
+    for (const glm::vec3& position : mesh.Positions) {
+        clip_.push_back(mvp * glm::vec4(position, 1.0f));
+    }
+
+    for (size_t i = 0; i + 2 < mesh.Indices.size(); i += 3) {
+        const glm::vec4& v0 = clip_[mesh.Indices[i]];
+        const glm::vec4& v1 = clip_[mesh.Indices[i + 1]];
+        const glm::vec4& v2 = clip_[mesh.Indices[i + 2]];
+        if (IsInFrontOfNearPlane(v0) && IsInFrontOfNearPlane(v1) && IsInFrontOfNearPlane(v2))
+            SetupTriangle(v0, v1, v2);
+    }
+}
+
+void OcclusionCuller::SetupTriangle(const glm::vec4& v0, const glm::vec4& v1,
+                                    const glm::vec4& v2) {
+    const glm::vec2 viewport(static_cast<float>(width_), static_cast<float>(height_));
+    auto toScreen = [&](const glm::vec4& clip) {
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        return glm::vec3((glm::vec2(ndc) * 0.5f + 0.5f) * viewport, ndc.z * 0.5f + 0.5f);
+    };
+
+    glm::vec3 p0 = toScreen(v0);
+    glm::vec3 p1 = toScreen(v1);
+    glm::vec3 p2 = toScreen(v2);
+
+    float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+    if (std::abs(area) < 1e-8f)
+        return;
+    if (area < 0.0f) {
+        std::swap(p1, p2);
+        area = -area;
+    }
+
+    // Pixels whose centers can lie inside the triangle
+    const glm::vec2 lo = glm::min(glm::min(glm::vec2(p0), glm::vec2(p1)), glm::vec2(p2));
+    const glm::vec2 hi = glm::max(glm::max(glm::vec2(p0), glm::vec2(p1)), glm::vec2(p2));
+    Triangle triangle;
+    triangle.Min = glm::max(glm::ivec2(glm::ceil(lo - 0.5f)), glm::ivec2(0));
+    triangle.Max = glm::min(glm::ivec2(glm::floor(hi - 0.5f)),
+                            glm::ivec2(static_cast<int>(width_) - 1,
+                                       static_cast<int>(height_) - 1));
+    if (triangle.Min.x > triangle.Max.x || triangle.Min.y > triangle.Max.y)
+        return;
+
+    const glm::vec3 points[3] = {p0, p1, p2};
+    for (int edge = 0; edge < 3; ++edge) {
+        const glm::vec3& a = points[edge];
+        const glm::vec3& b = points[(edge + 1) % 3];
+        triangle.EdgeA[edge] = a.y - b.y;
+        triangle.EdgeB[edge] = b.x - a.x;
+        triangle.EdgeC[edge] = -(triangle.EdgeA[edge] * a.x + triangle.EdgeB[edge] * a.y);
+    }
+
+    // z/w is linear in screen space, so depth is a plane
+    triangle.DepthDx = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / area;
+    triangle.DepthDy = ((p2.z - p0.z) * (p1.x - p0.x) - (p1.z - p0.z) * (p2.x - p0.x)) / area;
+    triangle.Depth0 = p0.z - triangle.DepthDx * p0.x - triangle.DepthDy * p0.y;
+
+    triangles_.push_back(triangle);
+}
+
+void OcclusionCuller::RasterizeOccluders() {
+    for (auto& bin : tileBins_) {
+        bin.clear();
+    }
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(triangles_.size()); ++i) {
+        const Triangle& triangle = triangles_[i];
+        const uint32_t firstX = static_cast<uint32_t>(triangle.Min.x) / kTileWidth;
+        const uint32_t lastX = static_cast<uint32_t>(triangle.Max.x) / kTileWidth;
+        const uint32_t firstY = static_cast<uint32_t>(triangle.Min.y) / kTileHeight;
+        const uint32_t lastY = static_cast<uint32_t>(triangle.Max.y) / kTileHeight;
+        for (uint32_t y = firstY; y <= lastY; ++y) {
+            for (uint32_t x = firstX; x <= lastX; ++x) {
+                tileBins_[y * tilesX_ + x].push_back(i);
+            }
+        }
+    }
+
+    // Tiles don't share pixels, so they rasterize independently
+    JobSystem::ParallelFor(tilesX_ * tilesY_, 4, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t tile = begin; tile < end; ++tile) {
+            RasterizeTile(tile);
+        }
+    });
+
+    BuildHierarchy();
+}
+
+void OcclusionCuller::RasterizeTile(uint32_t tile) {
+    const int tileX0 = static_cast<int>((tile % tilesX_) * kTileWidth);
+    const int tileY0 = static_cast<int>((tile / tilesX_) * kTileHeight);
+    const int tileX1 = tileX0 + static_cast<int>(kTileWidth) - 1;
+    const int tileY1 = tileY0 + static_cast<int>(kTileHeight) - 1;
+
+    for (uint32_t index : tileBins_[tile]) {
+        const Triangle& t = triangles_[index];
+        // Rows are processed four pixels at a time from a 4-aligned start (tiles are too)
+        const int x0 = std::max(t.Min.x, tileX0) & ~3;
+        const int x1 = std::min(t.Max.x, tileX1);
+        const int y0 = std::max(t.Min.y, tileY0);
+        const int y1 = std::min(t.Max.y, tileY1);
+
+        for (int y = y0; y <= y1; ++y) {
+            const float py = static_cast<float>(y) + 0.5f;
+            const glm::vec3 rowEdges = t.EdgeB * py + t.EdgeC;
+            const float rowDepth = t.Depth0 + t.DepthDy * py;
+            float* row = &depth_[static_cast<size_t>(y) * width_];
+
+#if SE_OCCLUSION_SSE
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            for (int x = x0; x <= x1; x += 4) {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+                const __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.EdgeA.x), px),
+                                             _mm_set1_ps(rowEdges.x));
+                const __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.EdgeA.y), px),
+                                             _mm_set1_ps(rowEdges.y));
+                const __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.EdgeA.z), px),
+                                             _mm_set1_ps(rowEdges.z));
+                const __m128 inside =
+                    _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                               _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                const __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.DepthDx), px),
+                                                _mm_set1_ps(rowDepth));
+                const __m128 current = _mm_loadu_ps(row + x);
+                const __m128 nearest = _mm_min_ps(current, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest),
+                                                 _mm_andnot_ps(inside, current)));
+            }
+#else
+            for (int x = x0; x <= x1; ++x) {
+                const float px = static_cast<float>(x) + 0.5f;
+                const glm::vec3 edges = t.EdgeA * px + rowEdges;
+                if (edges.x < 0.0f || edges.y < 0.0f || edges.z < 0.0f)
+                    continue;
+
+                row[x] = std::min(row[x], t.DepthDx * px + rowDepth);
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::BuildHierarchy() {
+    const float* source = depth_.data();
+    glm::uvec2 sourceSize(width_, height_);
+
+    for (size_t level = 0; level < hierarchy_.size(); ++level) {
+        const glm::uvec2 size = hierarchySizes_[level];
+        float* target = hierarchy_[level].data();
+
+        for (uint32_t y = 0; y < size.y; ++y) {
+            const uint32_t sy0 = y * 2;
+            const uint32_t sy1 = std::min(sy0 + 1, sourceSize.y - 1);
+            for (uint32_t x = 0; x < size.x; ++x) {
+                const uint32_t sx0 = x * 2;
+                const uint32_t sx1 = std::min(sx0 + 1, sourceSize.x - 1);
+                target[y * size.x + x] = std::max(
+                    std::max(source[sy0 * sourceSize.x + sx0], source[sy0 * sourceSize.x + sx1]),
+                    std::max(source[sy1 * sourceSize.x + sx0], source[sy1 * sourceSize.x + sx1]));
+            }
+        }
+
+        source = target;
+        sourceSize = size;
+    }
+}
+
+bool OcclusionCuller::IsVisible(const AABB& worldBounds) const {
+    if (!worldBounds.IsValid() || triangles_.empty())
+        return true;
+
+    glm::vec2 lo(1e30f);
+    glm::vec2 hi(-1e30f);
+    float nearestDepth = 1.0f;
+    for (uint32_t i = 0; i < 8; ++i) {
+        const glm::vec3 corner(i & 1 ? worldBounds.Max.x : worldBounds.Min.x,
+                               i & 2 ? worldBounds.Max.y : worldBounds.Min.y,
+                               i & 4 ? worldBounds.Max.z : worldBounds.Min.z);
+        const glm::vec4 clip = viewProjection_ * glm::vec4(corner, 1.0f);
+        // Boxes reaching the camera are never culled
+        if (!IsInFrontOfNearPlane(clip))
+            return true;
+
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        lo = glm::min(lo, glm::vec2(ndc));
+        hi = glm::max(hi, glm::vec2(ndc));
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    // Off-screen boxes are left to frustum culling
+    if (hi.x < -1.0f || hi.y < -1.0f || lo.x > 1.0f || lo.y > 1.0f)
+        return true;
+
+    const glm::vec2 viewport(static_cast<float>(width_), static_cast<float>(height_));
+    const glm::ivec2 maxPixel(static_cast<int>(width_) - 1, static_cast<int>(height_) - 1);
+    const glm::ivec2 pixelMin =
+        glm::clamp(glm::ivec2(glm::floor((lo * 0.5f + 0.5f) * viewport)), glm::ivec2(0), maxPixel);
+    const glm::ivec2 pixelMax =
+        glm::clamp(glm::ivec2(glm::floor((hi * 0.5f + 0.5f) * viewport)), glm::ivec2(0), maxPixel);
+
+    // Coarsest level at which the rectangle still spans only a few texels
+    const uint32_t extent = static_cast<uint32_t>(
+        std::max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y) + 1);
+    uint32_t level = 0;
+    while (level < hierarchy_.size() && (extent >> level) > kMaxTestTexels) {
+        level++;
+    }
+
+    const float* depth = level == 0 ? depth_.data() : hierarchy_[level - 1].data();
+    const uint32_t levelWidth = level == 0 ? width_ : hierarchySizes_[level - 1].x;
+    const glm::uvec2 texelMin = glm::uvec2(pixelMin) >> level;
+    const glm::uvec2 texelMax = glm::uvec2(pixelMax) >> level;
+
+    for (uint32_t y = texelMin.y; y <= texelMax.y; ++y) {
+        for (uint32_t x = texelMin.x; x <= texelMax.x; ++x) {
+            if (depth[y * levelWidth + x] >= nearestDepth)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace se
@@ -6,7 +6,8 @@ namespace se {
 
 void RenderCommand::Init() {
     glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
+    // Blending is enabled per render queue, opaque geometry never pays for it
+    glDisable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
@@ -24,8 +25,17 @@ void RenderCommand::Clear() {
 
 void RenderCommand::DrawIndexed(const VertexArray* vertexArray, uint32_t indexCount) {
     vertexArray->Bind();
-    uint32_t count = indexCount ? indexCount : vertexArray->GetIndexBuffer()->GetCount();
-    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+    DrawIndexed(indexCount ? indexCount : vertexArray->GetIndexCount(),
+                vertexArray->GetIndexType(), vertexArray->GetFirstIndex(),
+                vertexArray->GetBaseVertex());
+}
+
+void RenderCommand::DrawIndexed(uint32_t indexCount, IndexType indexType, uint32_t firstIndex,
+                                int32_t baseVertex) {
+    const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(firstIndex) *
+                                                       IndexTypeSize(indexType));
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(indexCount),
+                             IndexTypeToOpenGL(indexType), offset, baseVertex);
 }
 
 void RenderCommand::DrawArrays(const VertexArray* vertexArray, uint32_t vertexCount) {
@@ -47,6 +57,45 @@ void RenderCommand::SetBlend(bool enabled) {
         glDisable(GL_BLEND);
 }
 
+void RenderCommand::SetBlendMode(BlendMode mode) {
+    switch (mode) {
+        case BlendMode::Opaque:
+            glDisable(GL_BLEND);
+            break;
+        case BlendMode::AlphaBlend:
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case BlendMode::Additive:
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+            break;
+    }
+}
+
+void RenderCommand::SetDepthWrite(bool enabled) {
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void RenderCommand::SetDepthFunc(DepthFunc func) {
+    switch (func) {
+        case DepthFunc::Less:
+            glDepthFunc(GL_LESS);
+            break;
+        case DepthFunc::LessEqual:
+            glDepthFunc(GL_LEQUAL);
+            break;
+        case DepthFunc::Equal:
+            glDepthFunc(GL_EQUAL);
+            break;
+    }
+}
+
+void RenderCommand::SetColorWrite(bool enabled) {
+    const GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+    glColorMask(mask, mask, mask, mask);
+}
+
 void RenderCommand::SetCullFace(bool enabled) {
     if (enabled)
         glEnable(GL_CULL_FACE);
@@ -0,0 +1,601 @@
+#include "engine/renderer/RenderGraph.h"
+#include "engine/LinearArena.h"
+#include "engine/Log.h"
+#include "engine/Metrics.h"
+#include "engine/Profiler.h"
+#include "engine/RenderThread.h"
+#include "engine/renderer/GpuProfiler.h"
+#include <algorithm>
+#include <glad/glad.h>
+#include <memory_resource>
+
+namespace se {
+
+namespace {
+// Pooled textures nobody asked for in this many frames are deleted
+constexpr uint64_t kPooledTextureLifetime = 120;
+
+bool IsDepthFormat(uint32_t format) {
+    switch (format) {
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH32F_STENCIL8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool HasStencil(uint32_t format) {
+    return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+}
+
+// Pixel format/type for allocating storage with glTexImage2D; no data is uploaded
+void UploadFormat(uint32_t internalFormat, GLenum& format, GLenum& type) {
+    if (HasStencil(internalFormat)) {
+        format = GL_DEPTH_STENCIL;
+        type = internalFormat == GL_DEPTH24_STENCIL8 ? GL_UNSIGNED_INT_24_8
+                                                     : GL_FLOAT_32_UNSIGNED_INT_24_8_REV;
+    } else if (IsDepthFormat(internalFormat)) {
+        format = GL_DEPTH_COMPONENT;
+        type = GL_FLOAT;
+    } else {
+        format = GL_RGBA;
+        type = GL_FLOAT;
+    }
+}
+} // namespace
+
+// ========== Builder ==========
+
+RenderGraphResource RenderGraph::Builder::Create(const char* name,
+                                                 const RenderGraphTextureDesc& desc) {
+    FrameGraph& frame = *graph_.current_;
+    TextureNode node;
+    node.Name = name;
+    node.Desc = desc;
+    frame.Textures.push_back(node);
+    return graph_.AddVersion(static_cast<uint32_t>(frame.Textures.size() - 1), ~0u,
+                             RenderGraphAccess::RenderTarget);
+}
+
+RenderGraphResource RenderGraph::Builder::Read(RenderGraphResource resource,
+                                               RenderGraphAccess access) {
+    FrameGraph& frame = *graph_.current_;
+    if (resource >= frame.Versions.size()) {
+        SE_LOG_ERROR("Render pass '{}' reads an invalid resource", frame.Passes[pass_].Name);
+        return kInvalidRenderGraphResource;
+    }
+
+    frame.Versions[resource].Readers.push_back(pass_);
+    frame.Passes[pass_].Reads.push_back({resource, access});
+    return resource;
+}
+
+RenderGraphResource RenderGraph::Builder::Write(RenderGraphResource resource,
+                                                RenderGraphAccess access) {
+    FrameGraph& frame = *graph_.current_;
+    if (resource >= frame.Versions.size()) {
+        SE_LOG_ERROR("Render pass '{}' writes an invalid resource", frame.Passes[pass_].Name);
+        return kInvalidRenderGraphResource;
+    }
+
+    const uint32_t node = frame.Versions[resource].TextureNode;
+    if (frame.Textures[node].LatestVersion != resource) {
+        SE_LOG_ERROR("Render pass '{}' writes an old version of '{}'", frame.Passes[pass_].Name,
+                     frame.Textures[node].Name);
+        return kInvalidRenderGraphResource;
+    }
+
+    // Writing keeps the previous contents, so whoever produced them is a dependency
+    if (frame.Versions[resource].Producer != ~0u)
+        Read(resource, access);
+
+    const RenderGraphResource written = graph_.AddVersion(node, pass_, access);
+    frame.Passes[pass_].Writes.push_back({written, access});
+    return written;
+}
+
+void RenderGraph::Builder::SideEffect() {
+    graph_.current_->Passes[pass_].SideEffect = true;
+}
+
+void RenderGraph::Builder::UsesOcclusionQueries() {
+    graph_.current_->Passes[pass_].OcclusionQueries = true;
+}
+
+// ========== Context ==========
+
+uint32_t RenderGraph::Context::GetTexture(RenderGraphResource resource) const {
+    const FrameGraph& frame = *graph_.current_;
+    return frame.Textures[frame.Versions[resource].TextureNode].Texture;
+}
+
+uint32_t RenderGraph::Context::GetFramebuffer(RenderGraphResource resource) const {
+    const uint32_t node = graph_.current_->Versions[resource].TextureNode;
+    return graph_.GetFramebuffer({&node, 1});
+}
+
+const RenderGraphTextureDesc& RenderGraph::Context::GetDesc(RenderGraphResource resource) const {
+    const FrameGraph& frame = *graph_.current_;
+    return frame.Textures[frame.Versions[resource].TextureNode].Desc;
+}
+
+// ========== RenderGraph ==========
+
+RenderGraph::~RenderGraph() {
+    ReleasePool();
+}
+
+void RenderGraph::Reset() {
+    // Last frame's graph went with its arena
+    LinearArena& arena = RenderThread::GetFrameArena();
+    current_ = arena.New<FrameGraph>(&arena);
+    compiled_ = false;
+
+    for (auto it = framebuffers_.begin(); it != framebuffers_.end();) {
+        if (it->FrameOnly) {
+            glDeleteFramebuffers(1, &it->Framebuffer);
+            it = framebuffers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+uint32_t RenderGraph::BeginPass(const char* name, const void* callback, ExecuteThunk execute) {
+    Pass& pass = current_->Passes.emplace_back(current_->Memory);
+    pass.Name = name;
+    pass.Callback = callback;
+    pass.Execute = execute;
+    compiled_ = false;
+    return static_cast<uint32_t>(current_->Passes.size() - 1);
+}
+
+void* RenderGraph::AllocateCallback(size_t size, size_t alignment) {
+    return current_->Memory->allocate(size, alignment);
+}
+
+RenderGraphResource RenderGraph::ImportTexture(const char* name, uint32_t texture,
+                                               const RenderGraphTextureDesc& desc,
+                                               uint32_t framebuffer) {
+    FrameGraph& frame = *current_;
+    TextureNode node;
+    node.Name = name;
+    node.Desc = desc;
+    node.Texture = texture;
+    node.Framebuffer = framebuffer;
+    node.Imported = true;
+    frame.Textures.push_back(node);
+    return AddVersion(static_cast<uint32_t>(frame.Textures.size() - 1), ~0u,
+                      RenderGraphAccess::RenderTarget);
+}
+
+RenderGraphResource RenderGraph::ImportBackbuffer() {
+    FrameGraph& frame = *current_;
+    TextureNode node;
+    node.Name = "Backbuffer";
+    node.Imported = true;
+    node.Backbuffer = true;
+    frame.Textures.push_back(node);
+    return AddVersion(static_cast<uint32_t>(frame.Textures.size() - 1), ~0u,
+                      RenderGraphAccess::RenderTarget);
+}
+
+RenderGraphResource RenderGraph::AddVersion(uint32_t textureNode, uint32_t producer,
+                                            RenderGraphAccess access) {
+    FrameGraph& frame = *current_;
+    ResourceVersion& version = frame.Versions.emplace_back(frame.Memory);
+    version.TextureNode = textureNode;
+    version.Producer = producer;
+    version.ProducerAccess = access;
+
+    const auto resource = static_cast<RenderGraphResource>(frame.Versions.size() - 1);
+    frame.Textures[textureNode].LatestVersion = resource;
+    return resource;
+}
+
+void RenderGraph::Compile() {
+    SE_PROFILE_SCOPE("RenderGraph::Compile");
+    CullPasses();
+    SortPasses();
+    ComputeLifetimes();
+    compiled_ = true;
+}
+
+void RenderGraph::CullPasses() {
+    FrameGraph& frame = *current_;
+
+    // A pass stays while something reads one of its outputs; writes to imported textures and
+    // declared side effects count as external readers
+    for (Pass& pass : frame.Passes) {
+        pass.Culled = false;
+        pass.RefCount = static_cast<uint32_t>(pass.Writes.size());
+        if (pass.SideEffect)
+            pass.RefCount++;
+        for (const Access& write : pass.Writes) {
+            if (frame.Textures[frame.Versions[write.Resource].TextureNode].Imported)
+                pass.RefCount++;
+        }
+    }
+
+    std::pmr::vector<RenderGraphResource> unread(&RenderThread::GetFrameArena());
+    for (RenderGraphResource r = 0; r < frame.Versions.size(); ++r) {
+        frame.Versions[r].ReaderCount = static_cast<uint32_t>(frame.Versions[r].Readers.size());
+        if (frame.Versions[r].ReaderCount == 0 && frame.Versions[r].Producer != ~0u)
+            unread.push_back(r);
+    }
+
+    auto cull = [&](Pass& pass) {
+        pass.Culled = true;
+        for (const Access& read : pass.Reads) {
+            ResourceVersion& version = frame.Versions[read.Resource];
+            if (--version.ReaderCount == 0 && version.Producer != ~0u)
+                unread.push_back(read.Resource);
+        }
+    };
+
+    // Passes without any output
+    for (Pass& pass : frame.Passes) {
+        if (pass.RefCount == 0)
+            cull(pass);
+    }
+
+    while (!unread.empty()) {
+        const RenderGraphResource resource = unread.back();
+        unread.pop_back();
+
+        Pass& producer = frame.Passes[frame.Versions[resource].Producer];
+        if (!producer.Culled && --producer.RefCount == 0)
+            cull(producer);
+    }
+}
+
+void RenderGraph::SortPasses() {
+    // Kahn's algorithm; ties go to the pass that was added first
+    FrameGraph& frame = *current_;
+    const auto passCount = static_cast<uint32_t>(frame.Passes.size());
+    LinearArena& arena = RenderThread::GetFrameArena();
+    std::pmr::vector<std::pmr::vector<uint32_t>> dependents(passCount, &arena);
+    std::pmr::vector<uint32_t> dependencies(passCount, 0, &arena);
+
+    auto addEdge = [&](uint32_t from, uint32_t to) {
+        if (from == ~0u || from == to || frame.Passes[from].Culled)
+            return;
+        dependents[from].push_back(to);
+        dependencies[to]++;
+    };
+
+    for (uint32_t p = 0; p < passCount; ++p) {
+        if (frame.Passes[p].Culled)
+            continue;
+        for (const Access& read : frame.Passes[p].Reads) {
+            addEdge(frame.Versions[read.Resource].Producer, p);
+        }
+        // Overwriting a texture has to wait until everyone reading the old contents is done
+        for (const Access& write : frame.Passes[p].Writes) {
+            const uint32_t node = frame.Versions[write.Resource].TextureNode;
+            for (RenderGraphResource r = 0; r < write.Resource; ++r) {
+                if (frame.Versions[r].TextureNode != node)
+                    continue;
+                for (uint32_t reader : frame.Versions[r].Readers) {
+                    addEdge(reader, p);
+                }
+            }
+        }
+    }
+
+    frame.Order.clear();
+    std::pmr::vector<uint8_t> done(passCount, 0, &arena);
+    for (uint32_t p = 0; p < passCount; ++p) {
+        if (frame.Passes[p].Culled)
+            done[p] = 1;
+    }
+
+    while (true) {
+        uint32_t next = ~0u;
+        for (uint32_t p = 0; p < passCount; ++p) {
+            if (!done[p] && dependencies[p] == 0) {
+                next = p;
+                break;
+            }
+        }
+        if (next == ~0u)
+            break;
+
+        done[next] = 1;
+        frame.Order.push_back(next);
+        for (uint32_t dependent : dependents[next]) {
+            dependencies[dependent]--;
+        }
+    }
+
+    for (uint32_t p = 0; p < passCount; ++p) {
+        if (!done[p]) {
+            SE_LOG_ERROR("Render pass '{}' is part of a dependency cycle and is skipped",
+                         frame.Passes[p].Name);
+        }
+    }
+}
+
+void RenderGraph::ComputeLifetimes() {
+    FrameGraph& frame = *current_;
+    for (TextureNode& texture : frame.Textures) {
+        texture.FirstUse = ~0u;
+        texture.LastUse = 0;
+    }
+
+    for (uint32_t position = 0; position < frame.Order.size(); ++position) {
+        const Pass& pass = frame.Passes[frame.Order[position]];
+        auto touch = [&](const Access& access) {
+            TextureNode& texture = frame.Textures[frame.Versions[access.Resource].TextureNode];
+            texture.FirstUse = std::min(texture.FirstUse, position);
+            texture.LastUse = std::max(texture.LastUse, position);
+        };
+        std::for_each(pass.Reads.begin(), pass.Reads.end(), touch);
+        std::for_each(pass.Writes.begin(), pass.Writes.end(), touch);
+    }
+}
+
+void RenderGraph::Execute() {
+    SE_PROFILE_SCOPE("RenderGraph::Execute");
+    if (!compiled_)
+        Compile();
+
+    FrameGraph& frame = *current_;
+    stats_ = RenderGraphStats();
+    stats_.Passes = static_cast<uint32_t>(frame.Order.size());
+    stats_.CulledPasses = static_cast<uint32_t>(
+        std::ranges::count_if(frame.Passes, [](const Pass& p) { return p.Culled; }));
+
+    // Whatever is bound when the graph runs stands in for the backbuffer
+    GLint backbuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &backbuffer);
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    Context context(*this);
+    for (uint32_t position = 0; position < frame.Order.size(); ++position) {
+        for (TextureNode& texture : frame.Textures) {
+            if (!texture.Imported && texture.FirstUse == position) {
+                texture.Texture = AcquireTexture(texture.Desc);
+                stats_.TransientTextures++;
+            }
+        }
+
+        const Pass& pass = frame.Passes[frame.Order[position]];
+        IssueBarriers(pass);
+        BindRenderTargets(pass, static_cast<uint32_t>(backbuffer), viewport);
+        if (pass.Execute) {
+            GpuProfileScope scope(pass.Name, !pass.OcclusionQueries);
+            pass.Execute(pass.Callback, context);
+        }
+
+        for (TextureNode& texture : frame.Textures) {
+            if (!texture.Imported && texture.LastUse == position && texture.Texture)
+                ReleaseTexture(texture.Texture);
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(backbuffer));
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    PurgePool();
+    stats_.PooledTextures = static_cast<uint32_t>(pool_.size());
+    frame_++;
+}
+
+void RenderGraph::IssueBarriers(const Pass& pass) {
+    if (!GLAD_GL_VERSION_4_2 || glMemoryBarrier == nullptr)
+        return;
+
+    // Only storage writes are incoherent; render targets and copies are ordered by GL
+    GLbitfield barriers = 0;
+    for (const Access& read : pass.Reads) {
+        const ResourceVersion& version = current_->Versions[read.Resource];
+        if (version.Producer == ~0u || version.ProducerAccess != RenderGraphAccess::Storage)
+            continue;
+
+        switch (read.Type) {
+            case RenderGraphAccess::Sampled:
+                barriers |= GL_TEXTURE_FETCH_BARRIER_BIT;
+                break;
+            case RenderGraphAccess::Storage:
+                barriers |= GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+                break;
+            case RenderGraphAccess::RenderTarget:
+                barriers |= GL_FRAMEBUFFER_BARRIER_BIT;
+                break;
+            case RenderGraphAccess::Copy:
+                barriers |= GL_TEXTURE_UPDATE_BARRIER_BIT;
+                break;
+        }
+    }
+
+    if (barriers) {
+        glMemoryBarrier(barriers);
+        stats_.Barriers++;
+    }
+}
+
+void RenderGraph::BindRenderTargets(const Pass& pass, uint32_t backbuffer,
+                                    const int* backbufferViewport) {
+    FrameGraph& frame = *current_;
+    std::pmr::vector<uint32_t> attachments(&RenderThread::GetFrameArena());
+    bool writesBackbuffer = false;
+    for (const Access& write : pass.Writes) {
+        if (write.Type != RenderGraphAccess::RenderTarget)
+            continue;
+        const uint32_t node = frame.Versions[write.Resource].TextureNode;
+        if (frame.Textures[node].Backbuffer)
+            writesBackbuffer = true;
+        else
+            attachments.push_back(node);
+    }
+
+    if (writesBackbuffer) {
+        if (!attachments.empty())
+            SE_LOG_ERROR("Render pass '{}' mixes the backbuffer with textures", pass.Name);
+        glBindFramebuffer(GL_FRAMEBUFFER, backbuffer);
+        glViewport(backbufferViewport[0], backbufferViewport[1], backbufferViewport[2],
+                   backbufferViewport[3]);
+    } else if (!attachments.empty()) {
+        glBindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer(attachments));
+        const RenderGraphTextureDesc& desc = frame.Textures[attachments.front()].Desc;
+        glViewport(0, 0, static_cast<GLsizei>(desc.Width), static_cast<GLsizei>(desc.Height));
+    }
+}
+
+uint32_t RenderGraph::GetFramebuffer(std::span<const uint32_t> textureNodes) {
+    const FrameGraph& frame = *current_;
+    if (textureNodes.size() == 1 && frame.Textures[textureNodes.front()].Framebuffer)
+        return frame.Textures[textureNodes.front()].Framebuffer;
+
+    std::pmr::vector<uint32_t> attachments(&RenderThread::GetFrameArena());
+    bool frameOnly = false;
+    for (uint32_t node : textureNodes) {
+        attachments.push_back(frame.Textures[node].Texture);
+        frameOnly = frameOnly || frame.Textures[node].Imported;
+    }
+
+    for (const CachedFramebuffer& cached : framebuffers_) {
+        if (std::ranges::equal(cached.Attachments, attachments))
+            return cached.Framebuffer;
+    }
+
+    CachedFramebuffer cached;
+    cached.Attachments.assign(attachments.begin(), attachments.end());
+    cached.FrameOnly = frameOnly;
+    glGenFramebuffers(1, &cached.Framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, cached.Framebuffer);
+
+    std::vector<GLenum> drawBuffers;
+    for (uint32_t node : textureNodes) {
+        const TextureNode& texture = frame.Textures[node];
+        GLenum attachment;
+        if (HasStencil(texture.Desc.Format))
+            attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+        else if (IsDepthFormat(texture.Desc.Format))
+            attachment = GL_DEPTH_ATTACHMENT;
+        else
+            attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(drawBuffers.size());
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture.Texture, 0);
+        if (attachment >= GL_COLOR_ATTACHMENT0 && attachment < GL_DEPTH_ATTACHMENT)
+            drawBuffers.push_back(attachment);
+    }
+
+    if (drawBuffers.empty()) {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    } else {
+        glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        SE_LOG_ERROR("Render graph framebuffer is incomplete");
+
+    framebuffers_.push_back(cached);
+    return cached.Framebuffer;
+}
+
+uint32_t RenderGraph::AcquireTexture(const RenderGraphTextureDesc& desc) {
+    static MetricCounter& hits = Metrics::Counter("se_cache_requests_total",
+                                                  "Resource cache lookups",
+                                                  "cache=\"render_target\",result=\"hit\"");
+    static MetricCounter& misses = Metrics::Counter("se_cache_requests_total", "",
+                                                    "cache=\"render_target\",result=\"miss\"");
+
+    for (PooledTexture& pooled : pool_) {
+        if (!pooled.InUse && pooled.Desc == desc) {
+            hits.Add();
+            pooled.InUse = true;
+            pooled.LastUsedFrame = frame_;
+            return pooled.Texture;
+        }
+    }
+
+    misses.Add();
+    PooledTexture pooled;
+    pooled.Desc = desc;
+    pooled.InUse = true;
+    pooled.LastUsedFrame = frame_;
+    pooled.Memory = MemoryAllocation(desc.Tag, MemoryDomain::Gpu,
+                                     MemoryTracker::TextureBytes(desc.Format, desc.Width,
+                                                                 desc.Height));
+
+    GLenum format;
+    GLenum type;
+    UploadFormat(desc.Format, format, type);
+
+    glGenTextures(1, &pooled.Texture);
+    glBindTexture(GL_TEXTURE_2D, pooled.Texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(desc.Format),
+                 static_cast<GLsizei>(desc.Width), static_cast<GLsizei>(desc.Height), 0, format,
+                 type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (desc.DepthCompare) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        const float borderColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    } else {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    pool_.push_back(std::move(pooled));
+    return pool_.back().Texture;
+}
+
+void RenderGraph::ReleaseTexture(uint32_t texture) {
+    for (PooledTexture& pooled : pool_) {
+        if (pooled.Texture == texture) {
+            pooled.InUse = false;
+            return;
+        }
+    }
+}
+
+void RenderGraph::PurgePool() {
+    for (auto it = pool_.begin(); it != pool_.end();) {
+        if (!it->InUse && frame_ - it->LastUsedFrame > kPooledTextureLifetime) {
+            DeleteFramebuffersUsing(it->Texture);
+            glDeleteTextures(1, &it->Texture);
+            it = pool_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RenderGraph::DeleteFramebuffersUsing(uint32_t texture) {
+    for (auto it = framebuffers_.begin(); it != framebuffers_.end();) {
+        if (std::find(it->Attachments.begin(), it->Attachments.end(), texture) !=
+            it->Attachments.end()) {
+            glDeleteFramebuffers(1, &it->Framebuffer);
+            it = framebuffers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RenderGraph::ReleasePool() {
+    for (CachedFramebuffer& cached : framebuffers_) {
+        glDeleteFramebuffers(1, &cached.Framebuffer);
+    }
+    framebuffers_.clear();
+    for (PooledTexture& pooled : pool_) {
+        glDeleteTextures(1, &pooled.Texture);
+    }
+    pool_.clear();
+}
+
+} // namespace se
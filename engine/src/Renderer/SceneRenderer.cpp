@@ -1,19 +1,38 @@
 #include "engine/renderer/SceneRenderer.h"
+#include "engine/JobSystem.h"
+#include "engine/LinearArena.h"
+#include "engine/Log.h"
+#include "engine/Metrics.h"
+#include "engine/Profiler.h"
+#include "engine/RenderThread.h"
+#include "engine/renderer/GeometryArena.h"
+#include "engine/renderer/OcclusionCuller.h"
 #include "engine/renderer/RenderCommand.h"
+#include "engine/resources/MaterialManager.h"
+#include "engine/resources/MeshManager.h"
+#include <algorithm>
 #include <glad/glad.h>
 #include <gtc/matrix_transform.hpp>
 #include <gtc/type_ptr.hpp>
 
 namespace {
+// Shared by the shadow pass and the depth pre-pass. The position math must match basic.vert
+// exactly so the main pass can depth test with GL_EQUAL against the pre-pass depth.
 constexpr const char* kShadowVertexSource = R"(#version 330 core
 layout(location = 0) in vec3 a_Position;
+layout(location = 3) in int a_ObjectIndex;
 
-uniform mat4 uLightSpaceMatrix;
-uniform mat4 uModel;
+uniform mat4 uViewProjection;
+uniform samplerBuffer uObjectData;
+
+invariant gl_Position;
 
 void main() {
-    vec4 new_pos = uLightSpaceMatrix * uModel * vec4(a_Position, 1.0);
-    gl_Position = new_pos;
+    int base = a_ObjectIndex * 8;
+    mat4 model = mat4(texelFetch(uObjectData, base), texelFetch(uObjectData, base + 1),
+                      texelFetch(uObjectData, base + 2), texelFetch(uObjectData, base + 3));
+    vec4 world_position = model * vec4(a_Position, 1.0);
+    gl_Position = uViewProjection * world_position;
 }
 )";
 
@@ -22,29 +41,206 @@ void main() {
     // depth only
 }
 )";
+
+// Occlusion query proxy: a unit cube stretched over an object's world bounds
+constexpr const char* kBoundingBoxVertexSource = R"(#version 330 core
+layout(location = 0) in vec3 a_Position;
+
+uniform mat4 uViewProjection;
+uniform vec3 uBoxMin;
+uniform vec3 uBoxMax;
+
+void main() {
+    gl_Position = uViewProjection * vec4(mix(uBoxMin, uBoxMax, a_Position), 1.0);
+}
+)";
+
+GLenum ShadowDepthFormatToGL(se::ShadowDepthFormat format) {
+    switch (format) {
+        case se::ShadowDepthFormat::Depth16:
+            return GL_DEPTH_COMPONENT16;
+        case se::ShadowDepthFormat::Depth32F:
+            return GL_DEPTH_COMPONENT32F;
+        case se::ShadowDepthFormat::Depth24:
+        default:
+            return GL_DEPTH_COMPONENT24;
+    }
+}
+
+void CreateShadowTarget(const glm::ivec2& size, se::ShadowDepthFormat format,
+                        unsigned int& framebuffer, unsigned int& texture,
+                        se::MemoryAllocation& memory) {
+    glGenFramebuffers(1, &framebuffer);
+    glGenTextures(1, &texture);
+    memory = se::MemoryAllocation(
+        se::MemoryTag::Shadows, se::MemoryDomain::Gpu,
+        se::MemoryTracker::TextureBytes(ShadowDepthFormatToGL(format), size.x, size.y));
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, ShadowDepthFormatToGL(format), size.x, size.y, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // Linear filtering with compare mode gives 2x2 hardware PCF per sampler2DShadow fetch
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    const float borderColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DestroyShadowTarget(unsigned int& framebuffer, unsigned int& texture,
+                         se::MemoryAllocation& memory) {
+    memory.Reset();
+    if (texture) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+    if (framebuffer) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+}
+
+// Auto pre-pass hysteresis: {enable above, disable below} shaded fragments per visible pixel
+constexpr float kPrepassEnableOverdraw = 1.5f;
+constexpr float kPrepassDisableOverdraw = 1.2f;
+// Expensive fragments (many local lights, wide shadow kernels) pay off sooner
+constexpr float kPrepassEnableOverdrawHeavy = 1.25f;
+constexpr float kPrepassDisableOverdrawHeavy = 1.1f;
+// While the pre-pass is off, coverage is re-measured with a single pre-pass frame this often
+constexpr uint32_t kPrepassProbeInterval = 120;
+
+// Visible objects are re-queried every few frames (staggered by id) to notice when they hide
+constexpr uint32_t kVisibleQueryInterval = 4;
+// Query state of objects that stopped being submitted is released after this many frames
+constexpr uint64_t kOcclusionStateLifetime = 60;
+// Closer than this to its bounds, the camera may be inside the proxy box, which never passes
+constexpr float kOcclusionBoxMargin = 0.2f;
+
+// Submissions per frustum-test batch and queue entries per command buffer
+constexpr uint32_t kCullBatchSize = 256;
+constexpr uint32_t kCommandChunkSize = 128;
+
+// Render thread only, like RenderFrame
+void PublishRenderMetrics(const se::RenderStats& stats) {
+    using se::Metrics;
+    static se::MetricCounter& drawCallsTotal =
+        Metrics::Counter("se_draw_calls_total", "Draw calls issued");
+    static se::MetricGauge& drawCalls =
+        Metrics::Gauge("se_draw_calls", "Draw calls in the last frame");
+    static se::MetricGauge& triangles =
+        Metrics::Gauge("se_triangles", "Triangles drawn in the last frame");
+    static se::MetricGauge& commandPackets =
+        Metrics::Gauge("se_command_packets", "Command packets recorded in the last frame");
+    static se::MetricGauge& culledObjects =
+        Metrics::Gauge("se_culled_objects", "Objects frustum culled in the last frame");
+    static se::MetricGauge& localLights =
+        Metrics::Gauge("se_local_lights", "Local lights in the last frame");
+    // Keyed by the profiler's interned names
+    static std::unordered_map<const char*, se::MetricGauge*> gpuPasses;
+
+    drawCallsTotal.Add(stats.DrawCalls);
+    drawCalls.Set(stats.DrawCalls);
+    triangles.Set(stats.TriangleCount);
+    commandPackets.Set(stats.CommandPackets);
+    culledObjects.Set(stats.CulledObjects);
+    localLights.Set(stats.LocalLights);
+
+    for (const se::GpuPassStats& pass : stats.GpuPasses) {
+        se::MetricGauge*& gauge = gpuPasses[pass.Name];
+        if (!gauge)
+            gauge = &Metrics::Gauge("se_gpu_pass_milliseconds", "Average GPU time per pass",
+                                    "pass=\"" + std::string(pass.Name) + "\"");
+        gauge->Set(pass.AverageMs);
+    }
+}
 } // namespace
 
 namespace se {
 SceneRenderer::SceneData* SceneRenderer::sceneData_ = nullptr;
 RenderStats SceneRenderer::stats_;
+RenderStats SceneRenderer::publishedStats_;
+std::mutex SceneRenderer::statsMutex_;
 
 void SceneRenderer::Init() {
     sceneData_ = new SceneData();
+    sceneData_->LightClusters = std::make_unique<LightClusterer>();
+    sceneData_->Objects = std::make_unique<GpuScene>();
+    sceneData_->Graph = std::make_unique<RenderGraph>();
     InitializeShadowResources();
+
+    for (auto& query : sceneData_->OverdrawQueries) {
+        glGenQueries(1, &query.ShadedQuery);
+        glGenQueries(1, &query.VisibleQuery);
+    }
+    // Probe on the first frame so Auto starts from a measured coverage
+    sceneData_->FramesSincePrepassProbe = kPrepassProbeInterval;
+
+    sceneData_->MultiDrawIndirect = IndirectDrawList::IsSupported();
+    if (sceneData_->MultiDrawIndirect)
+        sceneData_->IndirectDraws = std::make_unique<IndirectDrawList>();
+    SE_LOG_INFO("SceneRenderer: multi-draw indirect {}",
+                sceneData_->MultiDrawIndirect ? "enabled" : "unavailable, using per-draw calls");
+
+    // GPU culling writes the commands multi-draw indirect reads, it needs both
+    if (sceneData_->MultiDrawIndirect && GpuCuller::IsSupported())
+        sceneData_->Culler = std::make_unique<GpuCuller>();
+    SE_LOG_INFO("SceneRenderer: GPU frustum culling {}",
+                sceneData_->Culler && sceneData_->Culler->IsValid() ? "enabled"
+                                                                    : "unavailable, using CPU");
+
+    // Conservative any-samples queries (GL 4.3) may report false positives, never negatives
+    sceneData_->OcclusionQueryTarget =
+        GLAD_GL_VERSION_4_3 ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+    sceneData_->BoundingBoxShader =
+        std::make_shared<Shader>(kBoundingBoxVertexSource, kShadowFragmentSource);
+
+    const OccluderMesh box = OccluderMesh::CreateBox(glm::vec3(0.0f), glm::vec3(1.0f));
+    auto boxVertices = std::make_shared<VertexBuffer>(
+        box.Positions.data(), static_cast<uint32_t>(box.Positions.size() * sizeof(glm::vec3)),
+        MemoryTag::Renderer);
+    boxVertices->SetLayout({{ShaderDataType::Float3, "a_Position"}});
+    sceneData_->BoundingBoxMesh = std::make_shared<VertexArray>();
+    sceneData_->BoundingBoxMesh->AddVertexBuffer(boxVertices);
+    sceneData_->BoundingBoxMesh->SetIndexBuffer(
+        std::make_shared<IndexBuffer>(box.Indices.data(), static_cast<uint32_t>(box.Indices.size()),
+                                      IndexType::UInt32, MemoryTag::Renderer));
 }
 
 void SceneRenderer::Shutdown() {
     DestroyShadowResources();
+    for (auto& query : sceneData_->OverdrawQueries) {
+        glDeleteQueries(1, &query.ShadedQuery);
+        glDeleteQueries(1, &query.VisibleQuery);
+    }
+    for (auto& [id, state] : sceneData_->OcclusionStates) {
+        glDeleteQueries(1, &state.Query);
+    }
     delete sceneData_;
     sceneData_ = nullptr;
 }
 
 void SceneRenderer::BeginScene(const Camera& camera, const glm::mat4& projection) {
-    sceneData_->ViewMatrix = camera.getViewMatrix();
-    sceneData_->ProjectionMatrix = projection;
-    sceneData_->ViewProjectionMatrix = projection * sceneData_->ViewMatrix;
-    sceneData_->Submissions.clear();
+    if (!sceneData_)
+        return;
 
+    FrameInputs& frame = sceneData_->Recording;
+    frame.ViewMatrix = camera.getViewMatrix();
+    frame.ProjectionMatrix = projection;
+    frame.CameraPosition = camera.GetPosition();
+    frame.Submissions.clear();
+    frame.LocalLights.clear();
+}
+
+void SceneRenderer::PrepareLighting() {
     // Prepare directional light data and shadow matrix
     if (!sceneData_->DirectionalLight.Active) {
         sceneData_->DirectionalLight.Direction = glm::vec3(0.0f, -1.0f, 0.0f);
@@ -81,124 +277,380 @@ void SceneRenderer::BeginScene(const Camera& camera, const glm::mat4& projection
         }
     }
 
-    ResetStats();
+    sceneData_->CameraFrustum = Frustum::FromMatrix(sceneData_->ViewProjectionMatrix);
+    sceneData_->LightFrustum = Frustum::FromMatrix(sceneData_->LightSpaceMatrix);
 }
 
 void SceneRenderer::EndScene() {
+    SE_PROFILE_FUNCTION();
     if (!sceneData_)
         return;
 
-    if (sceneData_->ShadowsEnabled) {
-        RenderShadowPass();
+    // The frame moves into the frame arena, recording keeps its capacity, light and settings
+    FrameInputs& recording = sceneData_->Recording;
+    LinearArena& arena = RenderThread::GetFrameArena();
+    FrameInputs* frame = arena.New<FrameInputs>(&arena);
+    frame->ViewMatrix = recording.ViewMatrix;
+    frame->ProjectionMatrix = recording.ProjectionMatrix;
+    frame->CameraPosition = recording.CameraPosition;
+    frame->DirectionalLight = recording.DirectionalLight;
+    frame->Settings = recording.Settings;
+    frame->Submissions.assign(std::make_move_iterator(recording.Submissions.begin()),
+                              std::make_move_iterator(recording.Submissions.end()));
+    frame->LocalLights.assign(recording.LocalLights.begin(), recording.LocalLights.end());
+    recording.Submissions.clear();
+    recording.LocalLights.clear();
+    recording.Settings.InvalidateStaticShadows = false;
+
+    RenderThread::Submit([frame] {
+        // The arena never runs destructors, the submissions' references are dropped here
+        struct Release {
+            FrameInputs* Frame;
+            ~Release() {
+                std::destroy_at(Frame);
+            }
+        } release{frame};
+        RenderFrame(*frame);
+    });
+}
+
+void SceneRenderer::RenderFrame(FrameInputs& frame) {
+    SE_PROFILE_FUNCTION();
+    ApplyFrameSettings(frame.Settings);
+
+    sceneData_->ViewMatrix = frame.ViewMatrix;
+    sceneData_->ProjectionMatrix = frame.ProjectionMatrix;
+    sceneData_->ViewProjectionMatrix = frame.ProjectionMatrix * frame.ViewMatrix;
+    sceneData_->CameraPosition = frame.CameraPosition;
+    sceneData_->DirectionalLight = frame.DirectionalLight;
+    sceneData_->Submissions = frame.Submissions;
+    sceneData_->LocalLights = frame.LocalLights;
+    sceneData_->FrameIndex++;
+    PrepareLighting();
+    stats_.Reset();
+
+    sceneData_->GpuCullingActive = sceneData_->Culling.FrustumCulling &&
+                                   sceneData_->Culling.GpuCulling && sceneData_->Culler &&
+                                   sceneData_->Culler->IsValid();
+    stats_.GpuCullingActive = sceneData_->GpuCullingActive;
+
+    UpdateGpuScene();
+    BuildRenderQueues();
+    BuildDrawBatches();
+    RecordDrawCommands();
+    if (sceneData_->GpuCullingActive) {
+        GpuProfileScope scope("GpuCulling");
+        CullDrawCommands();
     }
 
-    RenderScenePass();
+    RenderGraph& graph = *sceneData_->Graph;
+    graph.Reset();
+
+    const RenderGraphResource shadowMap =
+        sceneData_->ShadowsEnabled ? AddShadowPasses(graph) : kInvalidRenderGraphResource;
+    RenderGraphResource backbuffer = graph.ImportBackbuffer();
+    graph.AddPass(
+        "Scene",
+        [&](RenderGraph::Builder& builder) {
+            if (shadowMap != kInvalidRenderGraphResource)
+                builder.Read(shadowMap);
+            backbuffer = builder.Write(backbuffer);
+            builder.UsesOcclusionQueries();
+        },
+        [shadowMap](const RenderGraph::Context& context) {
+            sceneData_->ActiveShadowTexture =
+                shadowMap != kInvalidRenderGraphResource ? context.GetTexture(shadowMap) : 0;
+            RenderScenePass();
+        });
+
+    graph.Compile();
+    graph.Execute();
+    stats_.RenderGraph = graph.GetStats();
+    GpuProfiler::GetPassStats(stats_.GpuPasses);
+    PublishRenderMetrics(stats_);
+    sceneData_->Submissions = {};
+    sceneData_->LocalLights = {};
+
+    std::lock_guard lock(statsMutex_);
+    publishedStats_ = stats_;
+}
+
+RenderStats SceneRenderer::GetStats() {
+    std::lock_guard lock(statsMutex_);
+    return publishedStats_;
+}
+
+void SceneRenderer::ResetStats() {
+    std::lock_guard lock(statsMutex_);
+    publishedStats_.Reset();
+}
+
+void SceneRenderer::Submit(MeshHandle mesh, MaterialHandle material, const glm::mat4& transform,
+                           bool castsShadows, bool receiveShadows, bool isStatic,
+                           uint32_t objectId, uint32_t lod) {
+    if (!sceneData_)
+        return;
+
+    const VertexArray* vertexArray = MeshManager::Get(mesh);
+    const Material* resolvedMaterial = material ? MaterialManager::Get(material) : nullptr;
+    if (!vertexArray || (material && !resolvedMaterial))
+        return;
+
+    const auto& lods = vertexArray->GetLods();
+    if (lod > 0 && lod <= lods.size())
+        vertexArray = lods[lod - 1].Mesh.get();
+
+    Submit(*vertexArray, resolvedMaterial, transform, castsShadows, receiveShadows, isStatic,
+           objectId);
 }
 
-void SceneRenderer::Submit(const std::shared_ptr<VertexArray>& vertexArray,
-                           const std::shared_ptr<Material>& material, const glm::mat4& transform,
-                           bool castsShadows, bool receiveShadows) {
+void SceneRenderer::Submit(const VertexArray& vertexArray, const Material* material,
+                           const glm::mat4& transform, bool castsShadows, bool receiveShadows,
+                           bool isStatic, uint32_t objectId) {
     if (!sceneData_)
         return;
 
     Submission submission;
-    submission.VertexArray = vertexArray;
+    submission.VertexArray = &vertexArray;
     submission.Material = material;
     submission.Transform = transform;
     submission.CastsShadows = castsShadows;
     submission.ReceiveShadows = receiveShadows;
-    sceneData_->Submissions.emplace_back(std::move(submission));
+    submission.IsStatic = isStatic;
+    submission.ObjectId = objectId;
+    sceneData_->Recording.Submissions.emplace_back(std::move(submission));
+}
+
+void SceneRenderer::SubmitLocalLight(const LocalLightData& light) {
+    if (!sceneData_)
+        return;
+
+    if (light.Intensity <= 0.0f || light.Range <= 0.0f)
+        return;
+
+    sceneData_->Recording.LocalLights.push_back(light);
 }
 
 void SceneRenderer::SetDirectionalLight(const DirectionalLightData& light) {
     if (!sceneData_)
         return;
 
-    sceneData_->DirectionalLight = light;
-    sceneData_->DirectionalLight.Active = true;
+    DirectionalLightData& directional = sceneData_->Recording.DirectionalLight;
+    directional = light;
+    directional.Active = true;
 
-    if (glm::length(sceneData_->DirectionalLight.Direction) <= 0.0f) {
-        sceneData_->DirectionalLight.Direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    if (glm::length(directional.Direction) <= 0.0f) {
+        directional.Direction = glm::vec3(0.0f, -1.0f, 0.0f);
     } else {
-        sceneData_->DirectionalLight.Direction =
-            glm::normalize(sceneData_->DirectionalLight.Direction);
+        directional.Direction = glm::normalize(directional.Direction);
     }
 
-    sceneData_->DirectionalLight.Intensity = glm::max(light.Intensity, 0.0f);
+    directional.Intensity = glm::max(light.Intensity, 0.0f);
 }
 
 void SceneRenderer::ClearDirectionalLight() {
     if (!sceneData_)
         return;
 
-    sceneData_->DirectionalLight = DirectionalLightData{};
-    sceneData_->ShadowsEnabled = false;
-    sceneData_->LightSpaceMatrix = glm::mat4(1.0f);
+    sceneData_->Recording.DirectionalLight = DirectionalLightData{};
 }
 
 SceneRenderer::DirectionalLightData SceneRenderer::GetDirectionalLight() {
     if (!sceneData_)
         return DirectionalLightData{};
 
-    return sceneData_->DirectionalLight;
+    return sceneData_->Recording.DirectionalLight;
 }
 
-void SceneRenderer::InitializeShadowResources() {
+void SceneRenderer::SetShadowSettings(const ShadowSettings& settings) {
     if (!sceneData_)
         return;
 
-    sceneData_->ShadowShader = std::make_shared<Shader>(kShadowVertexSource, kShadowFragmentSource);
+    sceneData_->Recording.Settings.Shadows = settings;
+}
 
-    glGenFramebuffers(1, &sceneData_->ShadowFramebuffer);
-    glGenTextures(1, &sceneData_->ShadowDepthTexture);
+void SceneRenderer::ApplyFrameSettings(const FrameSettings& settings) {
+    sceneData_->PrepassMode = settings.PrepassMode;
+    sceneData_->Culling = settings.Culling;
+    if (settings.InvalidateStaticShadows)
+        sceneData_->StaticShadowValid = false;
 
-    glBindTexture(GL_TEXTURE_2D, sceneData_->ShadowDepthTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, sceneData_->ShadowMapSize.x,
-                 sceneData_->ShadowMapSize.y, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    const float borderColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    const ShadowSettings previous = sceneData_->Shadows;
+    sceneData_->Shadows = settings.Shadows;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, sceneData_->ShadowFramebuffer);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
-                           sceneData_->ShadowDepthTexture, 0);
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (previous.Resolution != settings.Shadows.Resolution ||
+        previous.DepthFormat != settings.Shadows.DepthFormat) {
+        DestroyShadowTarget(sceneData_->StaticShadowFramebuffer,
+                            sceneData_->StaticShadowDepthTexture, sceneData_->StaticShadowMemory);
+        sceneData_->ActiveShadowTexture = 0;
+        InitializeShadowResources();
+    }
+}
+
+SceneRenderer::ShadowSettings SceneRenderer::GetShadowSettings() {
+    if (!sceneData_)
+        return ShadowSettings{};
+
+    return sceneData_->Recording.Settings.Shadows;
+}
+
+void SceneRenderer::InvalidateStaticShadows() {
+    if (!sceneData_)
+        return;
+
+    sceneData_->Recording.Settings.InvalidateStaticShadows = true;
+}
+
+void SceneRenderer::SetDepthPrepassMode(DepthPrepassMode mode) {
+    if (!sceneData_)
+        return;
+
+    sceneData_->Recording.Settings.PrepassMode = mode;
+}
+
+void SceneRenderer::SetCullingSettings(const CullingSettings& settings) {
+    if (!sceneData_)
+        return;
+
+    sceneData_->Recording.Settings.Culling = settings;
+}
+
+SceneRenderer::CullingSettings SceneRenderer::GetCullingSettings() {
+    if (!sceneData_)
+        return CullingSettings();
+
+    return sceneData_->Recording.Settings.Culling;
+}
+
+DepthPrepassMode SceneRenderer::GetDepthPrepassMode() {
+    if (!sceneData_)
+        return DepthPrepassMode::Off;
+
+    return sceneData_->Recording.Settings.PrepassMode;
+}
+
+void SceneRenderer::InitializeShadowResources() {
+    if (!sceneData_)
+        return;
+
+    if (!sceneData_->ShadowShader)
+        sceneData_->ShadowShader =
+            std::make_shared<Shader>(kShadowVertexSource, kShadowFragmentSource);
+
+    const uint32_t resolution = glm::max(sceneData_->Shadows.Resolution, 1u);
+    sceneData_->ShadowMapSize = glm::ivec2(static_cast<int>(resolution));
+
+    CreateShadowTarget(sceneData_->ShadowMapSize, sceneData_->Shadows.DepthFormat,
+                       sceneData_->StaticShadowFramebuffer, sceneData_->StaticShadowDepthTexture,
+                       sceneData_->StaticShadowMemory);
+    sceneData_->StaticShadowValid = false;
 }
 
 void SceneRenderer::DestroyShadowResources() {
     if (!sceneData_)
         return;
 
-    if (sceneData_->ShadowDepthTexture) {
-        glDeleteTextures(1, &sceneData_->ShadowDepthTexture);
-        sceneData_->ShadowDepthTexture = 0;
-    }
-    if (sceneData_->ShadowFramebuffer) {
-        glDeleteFramebuffers(1, &sceneData_->ShadowFramebuffer);
-        sceneData_->ShadowFramebuffer = 0;
-    }
+    DestroyShadowTarget(sceneData_->StaticShadowFramebuffer, sceneData_->StaticShadowDepthTexture,
+                        sceneData_->StaticShadowMemory);
+    sceneData_->StaticShadowValid = false;
+    sceneData_->ActiveShadowTexture = 0;
     sceneData_->ShadowShader.reset();
 }
 
-void SceneRenderer::RenderShadowPass() {
-    if (!sceneData_ || sceneData_->Submissions.empty())
+void SceneRenderer::DrawShadowCasters(bool staticCasters) {
+    if (sceneData_->MultiDrawIndirect) {
+        DrawDepthBatches(staticCasters ? sceneData_->StaticShadowBatches
+                                       : sceneData_->DynamicShadowBatches,
+                         stats_.ShadowDrawCalls);
         return;
+    }
 
-    if (!sceneData_->ShadowShader || !sceneData_->ShadowFramebuffer)
-        return;
+    for (const auto& submission : sceneData_->Submissions) {
+        if (!submission.CastsShadows || submission.IsStatic != staticCasters)
+            continue;
+
+        if (!submission.VertexArray)
+            continue;
+
+        if (UseCpuCulling() && !IsVisible(submission, sceneData_->LightFrustum))
+            continue;
 
-    GLint previousViewport[4];
-    glGetIntegerv(GL_VIEWPORT, previousViewport);
+        GpuScene::SetObjectIndex(submission.ObjectIndex);
+        RenderCommand::DrawIndexed(submission.VertexArray);
+        stats_.ShadowDrawCalls++;
+    }
+}
+
+RenderGraphResource SceneRenderer::AddShadowPasses(RenderGraph& graph) {
+    if (sceneData_->Submissions.empty() || !sceneData_->ShadowShader ||
+        !sceneData_->StaticShadowFramebuffer)
+        return kInvalidRenderGraphResource;
+
+    RenderGraphTextureDesc desc;
+    desc.Width = static_cast<uint32_t>(sceneData_->ShadowMapSize.x);
+    desc.Height = static_cast<uint32_t>(sceneData_->ShadowMapSize.y);
+    desc.Format = ShadowDepthFormatToGL(sceneData_->Shadows.DepthFormat);
+    desc.DepthCompare = true;
+    desc.Tag = MemoryTag::Shadows;
+    RenderGraphResource staticShadows =
+        graph.ImportTexture("StaticShadowMap", sceneData_->StaticShadowDepthTexture, desc,
+                            sceneData_->StaticShadowFramebuffer);
+
+    // Caster changes arrive through InvalidateStaticShadows, only the light is compared here
+    const bool rebuildStatic = !sceneData_->StaticShadowValid ||
+                               sceneData_->LightSpaceMatrix != sceneData_->StaticShadowLightSpace;
+
+    bool hasDynamicCasters = false;
+    for (const auto& submission : sceneData_->Submissions) {
+        if (submission.CastsShadows && !submission.IsStatic && submission.VertexArray) {
+            hasDynamicCasters = true;
+            break;
+        }
+    }
+
+    if (rebuildStatic) {
+        graph.AddPass(
+            "StaticShadows",
+            [&](RenderGraph::Builder& builder) { staticShadows = builder.Write(staticShadows); },
+            [](const RenderGraph::Context&) {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                RenderShadowCasters(true);
+
+                sceneData_->StaticShadowLightSpace = sceneData_->LightSpaceMatrix;
+                sceneData_->StaticShadowValid = true;
+                stats_.StaticShadowRebuilds++;
+            });
+    }
+
+    // Nothing moves: sample the static map as-is
+    if (!hasDynamicCasters)
+        return staticShadows;
 
-    glViewport(0, 0, sceneData_->ShadowMapSize.x, sceneData_->ShadowMapSize.y);
-    glBindFramebuffer(GL_FRAMEBUFFER, sceneData_->ShadowFramebuffer);
-    glClear(GL_DEPTH_BUFFER_BIT);
+    // Start from the cached static depth and composite the dynamic casters on top
+    RenderGraphResource shadowMap = kInvalidRenderGraphResource;
+    const RenderGraphResource source = staticShadows;
+    graph.AddPass(
+        "ShadowCopy",
+        [&](RenderGraph::Builder& builder) {
+            builder.Read(source, RenderGraphAccess::Copy);
+            shadowMap = builder.Write(builder.Create("ShadowMap", desc));
+        },
+        [source](const RenderGraph::Context& context) {
+            // The copy is bound as the render target, blit into it
+            const glm::ivec2 size = sceneData_->ShadowMapSize;
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, context.GetFramebuffer(source));
+            glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_DEPTH_BUFFER_BIT,
+                              GL_NEAREST);
+        });
+    graph.AddPass(
+        "DynamicShadows",
+        [&](RenderGraph::Builder& builder) { shadowMap = builder.Write(shadowMap); },
+        [](const RenderGraph::Context&) { RenderShadowCasters(false); });
+    return shadowMap;
+}
 
+void SceneRenderer::RenderShadowCasters(bool staticCasters) {
+    SE_PROFILE_FUNCTION();
     GLboolean wasCullEnabled = glIsEnabled(GL_CULL_FACE);
     GLint previousCullFaceMode = GL_BACK;
     if (wasCullEnabled)
@@ -208,66 +660,784 @@ void SceneRenderer::RenderShadowPass() {
     glCullFace(GL_FRONT);
 
     sceneData_->ShadowShader->bind();
-    sceneData_->ShadowShader->setMat4("uLightSpaceMatrix", sceneData_->LightSpaceMatrix);
+    sceneData_->ShadowShader->setMat4("uViewProjection", sceneData_->LightSpaceMatrix);
+    sceneData_->Objects->SetUniforms(*sceneData_->ShadowShader);
+    DrawShadowCasters(staticCasters);
 
-    for (const auto& submission : sceneData_->Submissions) {
-        if (!submission.CastsShadows)
-            continue;
+    glCullFace(previousCullFaceMode);
+    if (!wasCullEnabled)
+        glDisable(GL_CULL_FACE);
+}
 
+void SceneRenderer::UpdateGpuScene() {
+    SE_PROFILE_FUNCTION();
+    GpuScene& objects = *sceneData_->Objects;
+    objects.BeginFrame();
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(sceneData_->Submissions.size()); ++i) {
+        auto& submission = sceneData_->Submissions[i];
         if (!submission.VertexArray)
             continue;
 
-        sceneData_->ShadowShader->setMat4("uModel", submission.Transform);
-        RenderCommand::DrawIndexed(submission.VertexArray.get());
+        // Submissions without an id get a per-frame key, they are re-checked every frame
+        const uint64_t key = submission.ObjectId != kTransientObjectId
+                                 ? submission.ObjectId
+                                 : (uint64_t(1) << 32) | i;
+        const uint32_t materialIndex = submission.Material ? submission.Material->GetId() : 0;
+        submission.ObjectIndex = objects.UpdateObject(key, submission.Transform, materialIndex,
+                                                      submission.VertexArray->GetBounds());
     }
 
-    glCullFace(previousCullFaceMode);
-    if (!wasCullEnabled)
-        glDisable(GL_CULL_FACE);
+    objects.Flush();
+    objects.BindTexture();
+    stats_.ObjectUploads = objects.GetUploadedObjectCount();
+}
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+void SceneRenderer::BuildRenderQueues() {
+    SE_PROFILE_FUNCTION();
+    sceneData_->OpaqueQueue.clear();
+    sceneData_->TransparentQueue.clear();
+    sceneData_->OccludedQueue.clear();
+
+    // Opaque multi-draw batches are culled on the GPU; transparent and occlusion-tested draws
+    // are never batched, so they are always culled on the CPU
+    const bool cullOpaque = UseCpuCulling();
+    const bool cullSeparate = sceneData_->Culling.FrustumCulling;
+
+    // Frustum tests and sort keys only read the submissions, so they run on the workers;
+    // occlusion state polling needs GL and stays on this thread
+    const uint32_t count = static_cast<uint32_t>(sceneData_->Submissions.size());
+    sceneData_->QueueClasses.resize(count);
+    sceneData_->QueueEntries.resize(count);
+    JobSystem::ParallelFor(count, kCullBatchSize, [=](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const auto& submission = sceneData_->Submissions[i];
+            QueueClass& queueClass = sceneData_->QueueClasses[i];
+            if (!submission.VertexArray || !submission.Material) {
+                queueClass = QueueClass::Skipped;
+                continue;
+            }
+
+            const bool transparent = submission.Material->IsTransparent();
+            const bool tracked = !transparent && TracksOcclusion(submission);
+            if ((transparent || tracked ? cullSeparate : cullOpaque) &&
+                !IsVisible(submission, sceneData_->CameraFrustum)) {
+                queueClass = QueueClass::Culled;
+                continue;
+            }
+
+            queueClass = transparent ? QueueClass::Transparent
+                                     : (tracked ? QueueClass::Tracked : QueueClass::Opaque);
+            const glm::vec3 offset =
+                glm::vec3(submission.Transform[3]) - sceneData_->CameraPosition;
+            sceneData_->QueueEntries[i] = {i, glm::dot(offset, offset)};
+        }
+    });
+
+    for (uint32_t i = 0; i < count; ++i) {
+        auto& submission = sceneData_->Submissions[i];
+        const QueueClass queueClass = sceneData_->QueueClasses[i];
+        const QueueEntry& entry = sceneData_->QueueEntries[i];
+        if (queueClass == QueueClass::Skipped)
+            continue;
+
+        if (queueClass == QueueClass::Culled) {
+            stats_.CulledObjects++;
+            continue;
+        }
+
+        if (queueClass == QueueClass::Transparent) {
+            sceneData_->TransparentQueue.push_back(entry);
+            continue;
+        }
+
+        if (queueClass == QueueClass::Tracked) {
+            OcclusionState& state = PollOcclusionState(submission.ObjectId);
+
+            AABB bounds = sceneData_->Objects->GetWorldBounds(submission.ObjectIndex);
+            bounds.Min -= kOcclusionBoxMargin;
+            bounds.Max += kOcclusionBoxMargin;
+            const glm::vec3& camera = sceneData_->CameraPosition;
+            if (glm::all(glm::greaterThanEqual(camera, bounds.Min)) &&
+                glm::all(glm::lessThanEqual(camera, bounds.Max)))
+                state.Visible = true;
+
+            if (!state.Visible) {
+                sceneData_->OccludedQueue.push_back(entry);
+                continue;
+            }
+
+            // The lit draw doubles as the query, no proxy geometry needed
+            if (!state.Pending &&
+                (sceneData_->FrameIndex + submission.ObjectId) % kVisibleQueryInterval == 0)
+                submission.OcclusionQuery = state.Query;
+        }
+
+        sceneData_->OpaqueQueue.push_back(entry);
+    }
+
+    for (auto it = sceneData_->OcclusionStates.begin();
+         it != sceneData_->OcclusionStates.end();) {
+        if (it->second.LastFrame + kOcclusionStateLifetime < sceneData_->FrameIndex) {
+            glDeleteQueries(1, &it->second.Query);
+            it = sceneData_->OcclusionStates.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Front-to-back maximizes early-z rejection, back-to-front keeps blending correct
+    std::sort(sceneData_->OpaqueQueue.begin(), sceneData_->OpaqueQueue.end(),
+              [](const QueueEntry& a, const QueueEntry& b) { return a.DistanceSq < b.DistanceSq; });
+    std::sort(sceneData_->TransparentQueue.begin(), sceneData_->TransparentQueue.end(),
+              [](const QueueEntry& a, const QueueEntry& b) { return a.DistanceSq > b.DistanceSq; });
+    std::sort(sceneData_->OccludedQueue.begin(), sceneData_->OccludedQueue.end(),
+              [](const QueueEntry& a, const QueueEntry& b) { return a.DistanceSq < b.DistanceSq; });
+}
+
+bool SceneRenderer::TracksOcclusion(const Submission& submission) {
+    if (!sceneData_->Culling.OcclusionQueries || submission.ObjectId == kTransientObjectId)
+        return false;
+
+    return submission.VertexArray->GetIndexCount() / 3 >=
+               sceneData_->Culling.OcclusionQueryMinTriangles &&
+           sceneData_->Objects->GetWorldBounds(submission.ObjectIndex).IsValid();
+}
+
+SceneRenderer::OcclusionState& SceneRenderer::PollOcclusionState(uint32_t objectId) {
+    OcclusionState& state = sceneData_->OcclusionStates[objectId];
+    if (!state.Query)
+        glGenQueries(1, &state.Query);
+    state.LastFrame = sceneData_->FrameIndex;
+
+    // Never wait: until the result arrives the object keeps its last known visibility
+    if (state.Pending) {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(state.Query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint anySamples = 0;
+            glGetQueryObjectuiv(state.Query, GL_QUERY_RESULT, &anySamples);
+            state.Visible = anySamples != 0;
+            state.Pending = false;
+        } else {
+            stats_.OcclusionResultsPending++;
+        }
+    }
+
+    return state;
+}
+
+void SceneRenderer::RenderOccludedQueue() {
+    SE_PROFILE_FUNCTION();
+    if (sceneData_->OccludedQueue.empty())
+        return;
+
+    // Proxy boxes first, against the depth of everything drawn so far
+    const Shader& boxShader = *sceneData_->BoundingBoxShader;
+    boxShader.bind();
+    boxShader.setMat4("uViewProjection", sceneData_->ViewProjectionMatrix);
+
+    const GLboolean wasCullEnabled = glIsEnabled(GL_CULL_FACE);
+    RenderCommand::SetCullFace(false);
+    RenderCommand::SetColorWrite(false);
+    RenderCommand::SetDepthWrite(false);
+
+    for (const auto& entry : sceneData_->OccludedQueue) {
+        const auto& submission = sceneData_->Submissions[entry.SubmissionIndex];
+        OcclusionState& state = sceneData_->OcclusionStates[submission.ObjectId];
+        // Still waiting on the previous box, draw against that result
+        if (state.Pending)
+            continue;
+
+        const AABB& bounds = sceneData_->Objects->GetWorldBounds(submission.ObjectIndex);
+        boxShader.setVec3("uBoxMin", bounds.Min);
+        boxShader.setVec3("uBoxMax", bounds.Max);
+
+        glBeginQuery(sceneData_->OcclusionQueryTarget, state.Query);
+        RenderCommand::DrawIndexed(sceneData_->BoundingBoxMesh.get());
+        glEndQuery(sceneData_->OcclusionQueryTarget);
+        state.Pending = true;
+        stats_.OcclusionQueries++;
+    }
+
+    RenderCommand::SetColorWrite(true);
+    RenderCommand::SetDepthWrite(true);
+    RenderCommand::SetCullFace(wasCullEnabled == GL_TRUE);
+
+    // The GPU resolves each draw against its box query without waiting for it: a result that
+    // isn't in yet draws the object anyway, which is always correct
+    for (const auto& entry : sceneData_->OccludedQueue) {
+        const auto& submission = sceneData_->Submissions[entry.SubmissionIndex];
+        const OcclusionState& state = sceneData_->OcclusionStates[submission.ObjectId];
+
+        glBeginConditionalRender(state.Query, GL_QUERY_NO_WAIT);
+        DrawSubmission(submission);
+        glEndConditionalRender();
+        stats_.ConditionalDraws++;
+    }
+}
+
+void SceneRenderer::BuildDrawBatches() {
+    SE_PROFILE_FUNCTION();
+    sceneData_->OpaqueBatches.clear();
+    sceneData_->PrepassBatches.clear();
+    sceneData_->StaticShadowBatches.clear();
+    sceneData_->DynamicShadowBatches.clear();
+    sceneData_->OpaqueCommandCount = 0;
+    sceneData_->CameraCommandCount = 0;
+
+    if (!sceneData_->MultiDrawIndirect)
+        return;
+
+    sceneData_->IndirectDraws->Clear();
+
+    std::pmr::vector<uint32_t> indices(&RenderThread::GetFrameArena());
+    indices.reserve(sceneData_->Submissions.size());
+
+    for (const auto& entry : sceneData_->OpaqueQueue) {
+        indices.push_back(entry.SubmissionIndex);
+    }
+    AppendDrawBatches(indices, true, sceneData_->CameraFrustum, sceneData_->OpaqueBatches);
+    sceneData_->OpaqueCommandCount = sceneData_->IndirectDraws->GetCommandCount();
+    AppendDrawBatches(indices, false, sceneData_->CameraFrustum, sceneData_->PrepassBatches);
+    sceneData_->CameraCommandCount = sceneData_->IndirectDraws->GetCommandCount();
+
+    if (sceneData_->ShadowsEnabled) {
+        const bool cullCasters = UseCpuCulling();
+        for (bool staticCasters : {true, false}) {
+            indices.clear();
+            for (uint32_t i = 0; i < static_cast<uint32_t>(sceneData_->Submissions.size()); ++i) {
+                const auto& submission = sceneData_->Submissions[i];
+                if (!submission.CastsShadows || !submission.VertexArray ||
+                    submission.IsStatic != staticCasters)
+                    continue;
+                if (cullCasters && !IsVisible(submission, sceneData_->LightFrustum))
+                    continue;
+                indices.push_back(i);
+            }
+            AppendDrawBatches(indices, false, sceneData_->LightFrustum,
+                              staticCasters ? sceneData_->StaticShadowBatches
+                                            : sceneData_->DynamicShadowBatches);
+        }
+    }
+
+    sceneData_->IndirectDraws->Upload();
+}
+
+void SceneRenderer::AppendDrawBatches(std::span<const uint32_t> submissionIndices,
+                                      bool splitByMaterial, const Frustum& frustum,
+                                      std::vector<DrawBatch>& batches) {
+    struct BatchKey {
+        GeometryArena* Arena;
+        const Material* MaterialKey;
+        bool ReceiveShadows;
+
+        bool operator==(const BatchKey&) const = default;
+    };
+    struct BatchKeyHash {
+        size_t operator()(const BatchKey& key) const {
+            size_t hash = std::hash<const void*>()(key.Arena);
+            hash ^= std::hash<const void*>()(key.MaterialKey) + 0x9e3779b97f4a7c15ull +
+                    (hash << 6) + (hash >> 2);
+            return hash ^ static_cast<size_t>(key.ReceiveShadows);
+        }
+    };
+
+    // Group ids follow first appearance, so batches keep the queue's rough sort order
+    LinearArena& frameArena = RenderThread::GetFrameArena();
+    std::pmr::vector<BatchKey> keys(&frameArena);
+    std::pmr::unordered_map<BatchKey, uint32_t, BatchKeyHash> groupIds(&frameArena);
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> grouped(&frameArena); // (group, submission)
+    grouped.reserve(submissionIndices.size());
+
+    for (uint32_t index : submissionIndices) {
+        const auto& submission = sceneData_->Submissions[index];
+        GeometryArena* arena = submission.VertexArray->GetArena();
+        // Queried draws need a draw call of their own
+        if (!arena || (splitByMaterial && submission.OcclusionQuery)) {
+            // Never reaches the GPU culler, test it here
+            if (sceneData_->Culling.FrustumCulling && !IsVisible(submission, frustum))
+                continue;
+
+            DrawBatch batch;
+            batch.SubmissionIndex = index;
+            batch.IndexCount = submission.VertexArray->GetIndexCount();
+            batches.push_back(batch);
+            continue;
+        }
+
+        const BatchKey key{arena, splitByMaterial ? submission.Material : nullptr,
+                           splitByMaterial && submission.ReceiveShadows};
+        const auto [it, added] = groupIds.try_emplace(key, static_cast<uint32_t>(keys.size()));
+        if (added)
+            keys.push_back(key);
+        const uint32_t group = it->second;
+
+        grouped.emplace_back(group, index);
+    }
+
+    // Counting sort by group, stable so each batch keeps the queue order
+    std::pmr::vector<uint32_t> groupStart(keys.size() + 1, 0, &frameArena);
+    for (const auto& [group, index] : grouped) {
+        groupStart[group + 1]++;
+    }
+    for (size_t group = 1; group < groupStart.size(); ++group) {
+        groupStart[group] += groupStart[group - 1];
+    }
+    std::pmr::vector<uint32_t> cursor(groupStart.begin(), groupStart.end() - 1, &frameArena);
+    std::pmr::vector<uint32_t> sorted(grouped.size(), &frameArena);
+    for (const auto& [group, index] : grouped) {
+        sorted[cursor[group]++] = index;
+    }
+
+    for (uint32_t group = 0; group < static_cast<uint32_t>(keys.size()); ++group) {
+        DrawBatch batch;
+        batch.Arena = keys[group].Arena;
+        batch.SubmissionIndex = sorted[groupStart[group]];
+        batch.ListBatch = sceneData_->IndirectDraws->BeginBatch();
+        batch.FirstCommand = sceneData_->IndirectDraws->GetCommandCount();
+
+        for (uint32_t i = groupStart[group]; i < groupStart[group + 1]; ++i) {
+            const auto& submission = sceneData_->Submissions[sorted[i]];
+            sceneData_->IndirectDraws->Add(*submission.VertexArray, submission.ObjectIndex);
+            batch.CommandCount++;
+            batch.IndexCount += submission.VertexArray->GetIndexCount();
+        }
+
+        batches.push_back(batch);
+    }
+}
+
+bool SceneRenderer::IsVisible(const Submission& submission, const Frustum& frustum) {
+    const AABB& bounds = sceneData_->Objects->GetWorldBounds(submission.ObjectIndex);
+    return !bounds.IsValid() || frustum.Intersects(bounds);
+}
+
+bool SceneRenderer::UseCpuCulling() {
+    return sceneData_->Culling.FrustumCulling && !sceneData_->GpuCullingActive;
+}
+
+void SceneRenderer::RecordDrawCommands() {
+    SE_PROFILE_FUNCTION();
+    // With multi-draw indirect the opaque queue is drawn through batches instead
+    const auto& opaqueQueue = sceneData_->OpaqueQueue;
+    const auto& transparentQueue = sceneData_->TransparentQueue;
+    const uint32_t opaqueCount =
+        sceneData_->MultiDrawIndirect ? 0 : static_cast<uint32_t>(opaqueQueue.size());
+    const uint32_t transparentCount = static_cast<uint32_t>(transparentQueue.size());
+    const uint32_t opaqueChunks = (opaqueCount + kCommandChunkSize - 1) / kCommandChunkSize;
+    const uint32_t transparentChunks =
+        (transparentCount + kCommandChunkSize - 1) / kCommandChunkSize;
+    sceneData_->OpaqueCommands.resize(opaqueChunks);
+    sceneData_->TransparentCommands.resize(transparentChunks);
+
+    // Chunks are disjoint, each one records into its own buffer
+    const uint32_t chunkCount = opaqueChunks + transparentChunks;
+    JobSystem::ParallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t chunk = begin; chunk < end; ++chunk) {
+            const bool opaque = chunk < opaqueChunks;
+            const uint32_t local = opaque ? chunk : chunk - opaqueChunks;
+            const auto& queue = opaque ? opaqueQueue : transparentQueue;
+            const uint32_t first = local * kCommandChunkSize;
+            const uint32_t last = std::min(first + kCommandChunkSize,
+                                           opaque ? opaqueCount : transparentCount);
+
+            CommandBuffer& buffer = opaque ? sceneData_->OpaqueCommands[local]
+                                           : sceneData_->TransparentCommands[local];
+            buffer.Clear();
+            for (uint32_t i = first; i < last; ++i) {
+                const auto& submission = sceneData_->Submissions[queue[i].SubmissionIndex];
+                buffer.BindPipeline(submission.Material,
+                                    submission.Material->GetBlendMode());
+                buffer.SetDrawData(submission.ObjectIndex, submission.ObjectId,
+                                   submission.OcclusionQuery, submission.ReceiveShadows);
+                buffer.Draw(submission.VertexArray);
+            }
+        }
+    });
+
+    for (const auto& buffers : {&sceneData_->OpaqueCommands, &sceneData_->TransparentCommands}) {
+        for (const CommandBuffer& buffer : *buffers) {
+            stats_.CommandPackets += static_cast<uint32_t>(buffer.GetPackets().size());
+        }
+    }
+}
+
+void SceneRenderer::ExecuteCommands(const std::vector<CommandBuffer>& buffers,
+                                    bool bindPipelines, uint32_t& drawCalls) {
+    // State carries across buffer boundaries, only changes reach GL
+    const Material* material = nullptr;
+    Shader* shader = nullptr;
+    BlendMode blend = BlendMode::Opaque;
+    float receiveShadows = -1.0f;
+    const CommandPacket::DrawData* draw = nullptr;
+
+    for (const CommandBuffer& buffer : buffers) {
+        for (const CommandPacket& packet : buffer.GetPackets()) {
+            switch (packet.Type) {
+            case CommandType::BindPipeline:
+                if (!bindPipelines)
+                    break;
+                if (packet.Pipeline.Material != material) {
+                    material = packet.Pipeline.Material;
+                    material->Bind();
+                    Shader* materialShader = material->GetShader().get();
+                    if (materialShader != shader) {
+                        shader = materialShader;
+                        receiveShadows = -1.0f;
+                        if (shader)
+                            ApplySceneUniforms(*shader);
+                    }
+                }
+                if (packet.Pipeline.Blend != blend) {
+                    blend = packet.Pipeline.Blend;
+                    RenderCommand::SetBlendMode(blend);
+                }
+                break;
+            case CommandType::BindVertexArray:
+                packet.Vertices.VertexArray->Bind();
+                break;
+            case CommandType::SetDrawData:
+                draw = &packet.Draw;
+                GpuScene::SetObjectIndex(draw->ObjectIndex);
+                if (bindPipelines && shader) {
+                    const float receive = draw->ReceiveShadows ? 1.0f : 0.0f;
+                    if (receive != receiveShadows) {
+                        shader->setFloat("uReceiveShadows", receive);
+                        receiveShadows = receive;
+                    }
+                }
+                break;
+            case CommandType::DrawIndexed: {
+                if (bindPipelines && !shader)
+                    break;
+
+                const auto& indexed = packet.Indexed;
+                const bool query = bindPipelines && draw && draw->OcclusionQuery;
+                if (query)
+                    glBeginQuery(sceneData_->OcclusionQueryTarget, draw->OcclusionQuery);
+                RenderCommand::DrawIndexed(indexed.IndexCount, indexed.Type, indexed.FirstIndex,
+                                           indexed.BaseVertex);
+                if (query) {
+                    glEndQuery(sceneData_->OcclusionQueryTarget);
+                    sceneData_->OcclusionStates[draw->ObjectId].Pending = true;
+                    stats_.OcclusionQueries++;
+                }
+
+                drawCalls++;
+                if (bindPipelines)
+                    stats_.TriangleCount += indexed.IndexCount / 3;
+                break;
+            }
+            }
+        }
+    }
+
+    if (blend != BlendMode::Opaque)
+        RenderCommand::SetBlendMode(BlendMode::Opaque);
+}
+
+void SceneRenderer::CullDrawCommands() {
+    const IndirectDrawList& list = *sceneData_->IndirectDraws;
+    const GpuCuller& culler = *sceneData_->Culler;
+    const uint32_t cameraCommands = sceneData_->CameraCommandCount;
+    const uint32_t shadowCommands = list.GetCommandCount() - cameraCommands;
+
+    // One dispatch per frustum, whatever the number of objects
+    culler.Cull(list, 0, cameraCommands, sceneData_->CameraFrustum);
+    culler.Cull(list, cameraCommands, shadowCommands, sceneData_->LightFrustum);
+    culler.Finish();
+
+    if (!sceneData_->Culling.ValidateGpuCulling)
+        return;
+
+    const uint32_t opaqueCommands = sceneData_->OpaqueCommandCount;
+    stats_.CulledObjects += culler.Validate(list, 0, opaqueCommands, sceneData_->CameraFrustum,
+                                            *sceneData_->Objects);
+    culler.Validate(list, opaqueCommands, cameraCommands - opaqueCommands,
+                    sceneData_->CameraFrustum, *sceneData_->Objects);
+    culler.Validate(list, cameraCommands, shadowCommands, sceneData_->LightFrustum,
+                    *sceneData_->Objects);
+}
+
+void SceneRenderer::DrawIndirectBatch(const DrawBatch& batch) {
+    if (sceneData_->GpuCullingActive)
+        sceneData_->IndirectDraws->DrawCulled(*batch.Arena, batch.ListBatch);
+    else
+        sceneData_->IndirectDraws->Draw(*batch.Arena, batch.FirstCommand, batch.CommandCount);
+}
+
+void SceneRenderer::DrawDepthBatches(const std::vector<DrawBatch>& batches,
+                                     uint32_t& drawCalls) {
+    for (const auto& batch : batches) {
+        if (batch.Arena) {
+            DrawIndirectBatch(batch);
+        } else {
+            const auto& submission = sceneData_->Submissions[batch.SubmissionIndex];
+            GpuScene::SetObjectIndex(submission.ObjectIndex);
+            RenderCommand::DrawIndexed(submission.VertexArray);
+        }
+        drawCalls++;
+    }
+}
+
+void SceneRenderer::ApplySceneUniforms(const Shader& shader) {
+    shader.setMat4("uView", sceneData_->ViewMatrix);
+    shader.setMat4("uProj", sceneData_->ProjectionMatrix);
+    shader.setMat4("uViewProjection", sceneData_->ViewProjectionMatrix);
+    shader.setVec3("uViewPos", sceneData_->CameraPosition);
+    sceneData_->Objects->SetUniforms(shader);
+    shader.setVec3("uLightDirection", -sceneData_->DirectionalLight.Direction);
+    shader.setVec3("uLightColor", sceneData_->DirectionalLight.Color);
+    shader.setFloat("uLightIntensity", sceneData_->DirectionalLight.Active
+                                           ? sceneData_->DirectionalLight.Intensity
+                                           : 0.0f);
+    shader.setFloat("uAmbientStrength", sceneData_->AmbientStrength);
+    shader.setMat4("uLightSpaceMatrix", sceneData_->LightSpaceMatrix);
+    shader.setInt("uShadowMap", 0);
+    shader.setInt("uShadowFilterMode", static_cast<int>(sceneData_->Shadows.FilterMode));
+    shader.setFloat("uShadowsEnabled",
+                    sceneData_->ShadowsEnabled && sceneData_->DirectionalLight.Active ? 1.0f
+                                                                                      : 0.0f);
+    sceneData_->LightClusters->SetUniforms(shader, sceneData_->ViewportSize);
+}
+
+void SceneRenderer::DrawSubmission(const Submission& submission) {
+    submission.Material->Bind();
+    Shader* shader = submission.Material->GetShader().get();
+    if (!shader)
+        return;
+
+    ApplySceneUniforms(*shader);
+    shader->setFloat("uReceiveShadows", submission.ReceiveShadows ? 1.0f : 0.0f);
+    GpuScene::SetObjectIndex(submission.ObjectIndex);
+
+    if (submission.OcclusionQuery) {
+        glBeginQuery(sceneData_->OcclusionQueryTarget, submission.OcclusionQuery);
+        RenderCommand::DrawIndexed(submission.VertexArray);
+        glEndQuery(sceneData_->OcclusionQueryTarget);
+        sceneData_->OcclusionStates[submission.ObjectId].Pending = true;
+        stats_.OcclusionQueries++;
+    } else {
+        RenderCommand::DrawIndexed(submission.VertexArray);
+    }
+
+    stats_.DrawCalls++;
+    stats_.TriangleCount += submission.VertexArray->GetIndexCount() / 3;
+}
+
+void SceneRenderer::DrawLitBatch(const DrawBatch& batch) {
+    const auto& submission = sceneData_->Submissions[batch.SubmissionIndex];
+    if (!batch.Arena) {
+        DrawSubmission(submission);
+        return;
+    }
+
+    submission.Material->Bind();
+    Shader* shader = submission.Material->GetShader().get();
+    if (!shader)
+        return;
+
+    ApplySceneUniforms(*shader);
+    shader->setFloat("uReceiveShadows", submission.ReceiveShadows ? 1.0f : 0.0f);
+
+    DrawIndirectBatch(batch);
+
+    stats_.DrawCalls++;
+    stats_.IndirectCommands += batch.CommandCount;
+    stats_.TriangleCount += batch.IndexCount / 3;
+}
+
+void SceneRenderer::ResolveOverdrawQueries() {
+    SE_PROFILE_FUNCTION();
+    for (auto& query : sceneData_->OverdrawQueries) {
+        if (!query.Pending)
+            continue;
+
+        // The visible query ends last, so once it is available both are
+        const unsigned int lastQuery = query.UsedPrepass ? query.VisibleQuery : query.ShadedQuery;
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        query.Pending = false;
+
+        GLuint64 shaded = 0;
+        glGetQueryObjectui64v(query.ShadedQuery, GL_QUERY_RESULT, &shaded);
+
+        double visible = 0.0;
+        if (query.UsedPrepass) {
+            GLuint64 visibleSamples = 0;
+            glGetQueryObjectui64v(query.VisibleQuery, GL_QUERY_RESULT, &visibleSamples);
+            visible = static_cast<double>(visibleSamples);
+            sceneData_->Coverage = static_cast<float>(
+                visible / static_cast<double>(glm::max<uint64_t>(query.ViewportSamples, 1)));
+        } else {
+            // Without a pre-pass the visible sample count is unknown, use the last coverage
+            visible = static_cast<double>(query.ViewportSamples) * sceneData_->Coverage;
+        }
+
+        if (visible < 1.0)
+            continue;
+
+        const float overdraw = static_cast<float>(static_cast<double>(shaded) / visible);
+        sceneData_->Overdraw = glm::mix(sceneData_->Overdraw, overdraw, 0.25f);
+    }
+}
+
+bool SceneRenderer::ShouldUseDepthPrepass() {
+    if (!sceneData_->ShadowShader || sceneData_->OpaqueQueue.empty())
+        return false;
+
+    switch (sceneData_->PrepassMode) {
+        case DepthPrepassMode::Off:
+            return false;
+        case DepthPrepassMode::On:
+            return true;
+        case DepthPrepassMode::Auto:
+            break;
+    }
+
+    const bool heavyShading = sceneData_->LightClusters->GetLightCount() > 0 ||
+                              (sceneData_->ShadowsEnabled &&
+                               sceneData_->Shadows.FilterMode >= ShadowFilterMode::Poisson8);
+    const float enableAbove = heavyShading ? kPrepassEnableOverdrawHeavy : kPrepassEnableOverdraw;
+    const float disableBelow =
+        heavyShading ? kPrepassDisableOverdrawHeavy : kPrepassDisableOverdraw;
+
+    if (!sceneData_->AutoPrepassEnabled && sceneData_->Overdraw > enableAbove)
+        sceneData_->AutoPrepassEnabled = true;
+    else if (sceneData_->AutoPrepassEnabled && sceneData_->Overdraw < disableBelow)
+        sceneData_->AutoPrepassEnabled = false;
+
+    if (sceneData_->AutoPrepassEnabled) {
+        sceneData_->FramesSincePrepassProbe = 0;
+        return true;
+    }
+
+    if (++sceneData_->FramesSincePrepassProbe >= kPrepassProbeInterval) {
+        sceneData_->FramesSincePrepassProbe = 0;
+        return true;
+    }
+
+    return false;
+}
+
+void SceneRenderer::RenderDepthPrepass() {
+    SE_PROFILE_FUNCTION();
+    sceneData_->ShadowShader->bind();
+    sceneData_->ShadowShader->setMat4("uViewProjection", sceneData_->ViewProjectionMatrix);
+    sceneData_->Objects->SetUniforms(*sceneData_->ShadowShader);
+
+    RenderCommand::SetColorWrite(false);
+    if (sceneData_->MultiDrawIndirect) {
+        DrawDepthBatches(sceneData_->PrepassBatches, stats_.DepthPrepassDrawCalls);
+    } else {
+        ExecuteCommands(sceneData_->OpaqueCommands, false, stats_.DepthPrepassDrawCalls);
+    }
+    RenderCommand::SetColorWrite(true);
 }
 
 void SceneRenderer::RenderScenePass() {
+    SE_PROFILE_FUNCTION();
     if (!sceneData_)
         return;
 
+#ifndef NDEBUG
+    // Errors from earlier passes are not ours to report
+    while (glGetError() != GL_NO_ERROR) {
+    }
+#endif
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    sceneData_->ViewportSize = glm::vec2(glm::max(viewport[2], 1), glm::max(viewport[3], 1));
+
+    // Assign local lights to clusters and upload them before any draw samples them
+    sceneData_->LightClusters->Build(sceneData_->LocalLights, sceneData_->ViewMatrix,
+                                     sceneData_->ProjectionMatrix);
+    sceneData_->LightClusters->Upload();
+    sceneData_->LightClusters->BindTextures();
+    stats_.LocalLights = sceneData_->LightClusters->GetLightCount();
+    stats_.LightClusterAssignments = sceneData_->LightClusters->GetAssignmentCount();
+
     glActiveTexture(GL_TEXTURE0);
-    if (sceneData_->ShadowsEnabled && sceneData_->ShadowDepthTexture)
-        glBindTexture(GL_TEXTURE_2D, sceneData_->ShadowDepthTexture);
+    if (sceneData_->ShadowsEnabled && sceneData_->ActiveShadowTexture)
+        glBindTexture(GL_TEXTURE_2D, sceneData_->ActiveShadowTexture);
     else
         glBindTexture(GL_TEXTURE_2D, 0);
 
-    for (const auto& submission : sceneData_->Submissions) {
-        if (!submission.VertexArray || !submission.Material)
-            continue;
+    ResolveOverdrawQueries();
+    const bool usePrepass = ShouldUseDepthPrepass();
 
-        submission.Material->Bind();
-        auto shader = submission.Material->GetShader();
-        if (!shader)
-            continue;
+    // Skip measuring when the slot's previous queries haven't come back yet. Per-object
+    // occlusion queries are issued inside the opaque draws, and GL allows only one active
+    // samples query, so overdraw keeps its last measurement while they are on.
+    auto& query = sceneData_->OverdrawQueries[sceneData_->OverdrawQueryIndex];
+    const bool measure = !query.Pending && !sceneData_->OpaqueQueue.empty() &&
+                         !sceneData_->Culling.OcclusionQueries;
+    if (measure) {
+        GLint samples = 0;
+        glGetIntegerv(GL_SAMPLES, &samples);
+        query.ViewportSamples = static_cast<uint64_t>(sceneData_->ViewportSize.x) *
+                                static_cast<uint64_t>(sceneData_->ViewportSize.y) *
+                                static_cast<uint64_t>(glm::max(samples, 1));
+        query.UsedPrepass = usePrepass;
+        query.Pending = true;
+        sceneData_->OverdrawQueryIndex =
+            (sceneData_->OverdrawQueryIndex + 1) % sceneData_->OverdrawQueries.size();
+    }
+
+    RenderCommand::SetBlendMode(BlendMode::Opaque);
+    RenderCommand::SetDepthWrite(true);
+
+    if (usePrepass) {
+        if (measure)
+            glBeginQuery(GL_SAMPLES_PASSED, query.ShadedQuery);
+        RenderDepthPrepass();
+        if (measure)
+            glEndQuery(GL_SAMPLES_PASSED);
+
+        // Depth is final, only the nearest surface of each pixel gets shaded
+        RenderCommand::SetDepthFunc(DepthFunc::Equal);
+        RenderCommand::SetDepthWrite(false);
+    }
+
+    if (measure)
+        glBeginQuery(GL_SAMPLES_PASSED, usePrepass ? query.VisibleQuery : query.ShadedQuery);
+    if (sceneData_->MultiDrawIndirect) {
+        for (const auto& batch : sceneData_->OpaqueBatches) {
+            DrawLitBatch(batch);
+        }
+    } else {
+        ExecuteCommands(sceneData_->OpaqueCommands, true, stats_.DrawCalls);
+    }
+    if (measure)
+        glEndQuery(GL_SAMPLES_PASSED);
+
+    if (usePrepass) {
+        RenderCommand::SetDepthFunc(DepthFunc::Less);
+        RenderCommand::SetDepthWrite(true);
+    }
+
+    // Hidden last frame: not in the pre-pass or the batches, tested against the final depth
+    RenderOccludedQueue();
+
+#ifndef NDEBUG
+    // Overlapping queries fail with GL_INVALID_OPERATION and silently lose their results
+    if (const GLenum error = glGetError(); error != GL_NO_ERROR)
+        SE_LOG_ERROR("GL error 0x{:x} in the opaque scene pass", error);
+#endif
+
+    stats_.DepthPrepassActive = usePrepass;
+    stats_.Overdraw = sceneData_->Overdraw;
 
-        shader->setMat4("uView", sceneData_->ViewMatrix);
-        shader->setMat4("uProj", sceneData_->ProjectionMatrix);
-        shader->setMat4("uModel", submission.Transform);
-        shader->setVec3("uLightDirection", -sceneData_->DirectionalLight.Direction);
-        shader->setVec3("uLightColor", sceneData_->DirectionalLight.Color);
-        shader->setFloat("uLightIntensity", sceneData_->DirectionalLight.Active
-                                                ? sceneData_->DirectionalLight.Intensity
-                                                : 0.0f);
-        shader->setFloat("uAmbientStrength", sceneData_->AmbientStrength);
-        shader->setMat4("uLightSpaceMatrix", sceneData_->LightSpaceMatrix);
-        shader->setInt("uShadowMap", 0);
-        shader->setFloat("uReceiveShadows", submission.ReceiveShadows ? 1.0f : 0.0f);
-        shader->setFloat("uShadowsEnabled",
-                         sceneData_->ShadowsEnabled && sceneData_->DirectionalLight.Active ? 1.0f
-                                                                                           : 0.0f);
-
-        RenderCommand::DrawIndexed(submission.VertexArray.get());
-
-        stats_.DrawCalls++;
-        stats_.TriangleCount += submission.VertexArray->GetIndexBuffer()->GetCount() / 3;
+    if (!sceneData_->TransparentQueue.empty()) {
+        // Transparent surfaces test against opaque depth but don't occlude each other
+        RenderCommand::SetDepthWrite(false);
+        ExecuteCommands(sceneData_->TransparentCommands, true, stats_.DrawCalls);
+        RenderCommand::SetDepthWrite(true);
     }
 
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -1,4 +1,5 @@
 #include "engine/renderer/VertexArray.h"
+#include "engine/renderer/GeometryArena.h"
 #include <glad/glad.h>
 
 namespace se {
@@ -19,6 +20,17 @@ static GLenum ShaderDataTypeToOpenGLBaseType(ShaderDataType type) {
             return GL_INT;
         case ShaderDataType::Bool:
             return GL_BOOL;
+        case ShaderDataType::Half2:
+        case ShaderDataType::Half4:
+            return GL_HALF_FLOAT;
+        case ShaderDataType::Byte4:
+            return GL_BYTE;
+        case ShaderDataType::UByte4:
+            return GL_UNSIGNED_BYTE;
+        case ShaderDataType::Short2:
+            return GL_SHORT;
+        case ShaderDataType::Int2_10_10_10_Rev:
+            return GL_INT_2_10_10_10_REV;
         default:
             return 0;
     }
@@ -28,11 +40,22 @@ VertexArray::VertexArray() {
     glGenVertexArrays(1, &rendererId_);
 }
 
+VertexArray::VertexArray(const std::shared_ptr<GeometryArena>& arena, uint32_t allocation)
+    : arena_(arena), allocation_(allocation) {}
+
 VertexArray::~VertexArray() {
+    if (arena_) {
+        arena_->Free(allocation_);
+        return;
+    }
     glDeleteVertexArrays(1, &rendererId_);
 }
 
 void VertexArray::Bind() const {
+    if (arena_) {
+        arena_->Bind();
+        return;
+    }
     glBindVertexArray(rendererId_);
 }
 
@@ -41,6 +64,9 @@ void VertexArray::Unbind() const {
 }
 
 void VertexArray::AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer) {
+    if (arena_) {
+        throw std::runtime_error("Cannot add vertex buffers to an arena vertex array!");
+    }
     if (vertexBuffer->GetLayout().GetElements().size() == 0) {
         throw std::runtime_error("Vertex Buffer has no layout!");
     }
@@ -51,10 +77,16 @@ void VertexArray::AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuf
     const auto& layout = vertexBuffer->GetLayout();
     for (const auto& element : layout) {
         glEnableVertexAttribArray(vertexBufferIndex_);
-        glVertexAttribPointer(vertexBufferIndex_, element.GetComponentCount(),
-                              ShaderDataTypeToOpenGLBaseType(element.Type),
-                              element.Normalized ? GL_TRUE : GL_FALSE, layout.GetStride(),
-                              (const void*)(intptr_t)element.Offset);
+        const GLenum baseType = ShaderDataTypeToOpenGLBaseType(element.Type);
+        if (baseType == GL_INT) {
+            // Integer attributes must not go through float conversion
+            glVertexAttribIPointer(vertexBufferIndex_, element.GetComponentCount(), baseType,
+                                   layout.GetStride(), (const void*)(intptr_t)element.Offset);
+        } else {
+            glVertexAttribPointer(vertexBufferIndex_, element.GetComponentCount(), baseType,
+                                  element.Normalized ? GL_TRUE : GL_FALSE, layout.GetStride(),
+                                  (const void*)(intptr_t)element.Offset);
+        }
         vertexBufferIndex_++;
     }
 
@@ -62,9 +94,51 @@ void VertexArray::AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuf
 }
 
 void VertexArray::SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer) {
+    if (arena_) {
+        throw std::runtime_error("Cannot set the index buffer of an arena vertex array!");
+    }
     glBindVertexArray(rendererId_);
     indexBuffer->Bind();
     indexBuffer_ = indexBuffer;
 }
 
+uint32_t VertexArray::GetIndexCount() const {
+    if (arena_)
+        return arena_->GetRange(allocation_).IndexCount;
+    return indexBuffer_ ? indexBuffer_->GetCount() : 0;
+}
+
+IndexType VertexArray::GetIndexType() const {
+    if (arena_)
+        return arena_->GetIndexType();
+    return indexBuffer_ ? indexBuffer_->GetIndexType() : IndexType::UInt32;
+}
+
+int32_t VertexArray::GetBaseVertex() const {
+    return arena_ ? arena_->GetRange(allocation_).BaseVertex : 0;
+}
+
+uint32_t VertexArray::GetFirstIndex() const {
+    return arena_ ? arena_->GetRange(allocation_).FirstIndex : 0;
+}
+
+uint32_t VertexArray::SelectLod(float screenSize, uint32_t current, float hysteresis) const {
+    // Levels finer than finest are clearly too detailed for this size and levels past coarsest
+    // clearly too coarse, so the current level is clamped into [finest, coarsest]
+    uint32_t finest = 0;
+    uint32_t coarsest = 0;
+    for (const Lod& lod : lods_) {
+        if (screenSize < lod.ScreenSize * (1.0f - hysteresis))
+            finest++;
+        if (screenSize < lod.ScreenSize * (1.0f + hysteresis))
+            coarsest++;
+    }
+
+    if (current < finest)
+        return finest;
+    if (current > coarsest)
+        return coarsest;
+    return current;
+}
+
 } // namespace se
\ No newline at end of file
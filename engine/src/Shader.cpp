@@ -87,6 +87,13 @@ Shader::Shader(const std::string& vertSrc, const std::string& fragSrc) {
     glDetachShader(program_, fs);
     glDeleteShader(vs);
     glDeleteShader(fs);
+
+    // The driver's binary is the closest thing to the program's footprint GL exposes
+    if (GLAD_GL_VERSION_4_1) {
+        GLint binaryLength = 0;
+        glGetProgramiv(program_, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+        memory_.Resize(static_cast<uint64_t>(binaryLength));
+    }
 }
 
 Shader::~Shader() {
@@ -115,6 +122,18 @@ void Shader::setInt(const char* name, int value) const {
         glUniform1i(loc, value);
 }
 
+void Shader::setIVec3(const char* name, const glm::ivec3& value) const {
+    int loc = uniformLocation(name);
+    if (loc >= 0)
+        glUniform3iv(loc, 1, glm::value_ptr(value));
+}
+
+void Shader::setVec2(const char* name, const glm::vec2& value) const {
+    int loc = uniformLocation(name);
+    if (loc >= 0)
+        glUniform2fv(loc, 1, glm::value_ptr(value));
+}
+
 void Shader::setVec3(const char* name, const glm::vec3& value) const {
     int loc = uniformLocation(name);
     if (loc >= 0)
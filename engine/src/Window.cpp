@@ -1,6 +1,7 @@
 #include "engine/Window.h"
 #include "engine/Input.h"
 #include "engine/Log.h"
+#include "engine/RenderThread.h"
 #include "engine/renderer/GraphicsContext.h"
 #include <GLFW/glfw3.h>
 #include <stdexcept>
@@ -114,6 +115,7 @@ void Window::FramebufferSizeCallback(GLFWwindow* window, int width, int height)
 
     SE_LOG_WARN("Window size callback: ({},{})", w, h);
 
-    glViewport(0, 0, w, h);
+    // Events are polled on the main thread, the viewport belongs to the render thread
+    RenderThread::Submit([w, h] { glViewport(0, 0, w, h); });
 }
 } // namespace se
\ No newline at end of file
@@ -1,11 +1,44 @@
 #include "engine/ecs/RenderSystem.h"
 #include "engine/Log.h"
+#include "engine/Profiler.h"
 #include "engine/ecs/Components.h"
 #include "engine/ecs/Scene.h"
+#include "engine/renderer/OcclusionCuller.h"
 #include "engine/renderer/SceneRenderer.h"
+#include "engine/resources/MaterialManager.h"
+#include "engine/resources/MeshManager.h"
+#include <cmath>
+#include <limits>
 
 namespace se {
 bool RenderSystem::initialized_ = false;
+bool RenderSystem::occlusionCulling_ = true;
+std::unique_ptr<OcclusionCuller> RenderSystem::occlusionCuller_;
+OcclusionStats RenderSystem::occlusionStats_;
+float RenderSystem::lodBias_ = 0.0f;
+float RenderSystem::lodHysteresis_ = 0.1f;
+LodStats RenderSystem::lodStats_;
+uint64_t RenderSystem::staticGeneration_ = 0;
+uint32_t RenderSystem::missingResources_ = 0;
+
+namespace {
+// Projected diameter of the bounding sphere as a fraction of the screen height
+float ProjectedSize(const AABB& bounds, const glm::vec3& cameraPosition,
+                    const glm::mat4& projection) {
+    if (!bounds.IsValid())
+        return std::numeric_limits<float>::infinity();
+
+    const float radius = glm::length(bounds.Max - bounds.Min) * 0.5f;
+    // Orthographic: size doesn't depend on distance
+    if (projection[3][3] == 1.0f)
+        return radius * projection[1][1];
+
+    const float distance = glm::length(bounds.GetCenter() - cameraPosition);
+    if (distance <= radius)
+        return std::numeric_limits<float>::infinity();
+    return radius * projection[1][1] / distance;
+}
+} // namespace
 
 void RenderSystem::Init() {
     if (initialized_) {
@@ -14,6 +47,7 @@ void RenderSystem::Init() {
     }
 
     SE_LOG_INFO("Initializing RenderSystem");
+    occlusionCuller_ = std::make_unique<OcclusionCuller>();
     initialized_ = true;
 }
 
@@ -22,10 +56,44 @@ void RenderSystem::Shutdown() {
         return;
 
     SE_LOG_INFO("Shutting down RenderSystem");
+    occlusionCuller_.reset();
     initialized_ = false;
 }
 
+void RenderSystem::SetOcclusionCulling(bool enabled) {
+    occlusionCulling_ = enabled;
+}
+
+bool RenderSystem::IsOcclusionCullingEnabled() {
+    return occlusionCulling_;
+}
+
+OcclusionStats RenderSystem::GetOcclusionStats() {
+    return occlusionStats_;
+}
+
+void RenderSystem::SetLodBias(float bias) {
+    lodBias_ = bias;
+}
+
+float RenderSystem::GetLodBias() {
+    return lodBias_;
+}
+
+void RenderSystem::SetLodHysteresis(float hysteresis) {
+    lodHysteresis_ = glm::clamp(hysteresis, 0.0f, 0.5f);
+}
+
+float RenderSystem::GetLodHysteresis() {
+    return lodHysteresis_;
+}
+
+LodStats RenderSystem::GetLodStats() {
+    return lodStats_;
+}
+
 void RenderSystem::Render(Scene& scene, const Camera& camera, float aspectRatio) {
+    SE_PROFILE_SCOPE("RenderSystem::Render");
     if (!initialized_) {
         SE_LOG_ERROR("RenderSystem not initialized!");
         return;
@@ -61,11 +129,72 @@ void RenderSystem::Render(Scene& scene, const Camera& camera, float aspectRatio)
     glm::mat4 projection = camera.getProjectionMatrix(aspectRatio);
     SceneRenderer::BeginScene(camera, projection);
 
+    // Local lights
+    auto pointLightView = scene.GetAllEntitiesWith<TransformComponent, PointLightComponent>();
+    for (auto entity : pointLightView) {
+        auto& transform = pointLightView.get<TransformComponent>(entity);
+        auto& light = pointLightView.get<PointLightComponent>(entity);
+
+        if (!light.Enabled)
+            continue;
+
+        LocalLightData lightData;
+        lightData.Type = LocalLightType::Point;
+        lightData.Position = transform.Position;
+        lightData.Color = light.Color;
+        lightData.Intensity = light.Intensity;
+        lightData.Range = light.Range;
+        SceneRenderer::SubmitLocalLight(lightData);
+    }
+
+    auto spotLightView = scene.GetAllEntitiesWith<TransformComponent, SpotLightComponent>();
+    for (auto entity : spotLightView) {
+        auto& transform = spotLightView.get<TransformComponent>(entity);
+        auto& light = spotLightView.get<SpotLightComponent>(entity);
+
+        if (!light.Enabled)
+            continue;
+
+        const float outerAngle = glm::max(light.OuterConeAngle, light.InnerConeAngle);
+
+        LocalLightData lightData;
+        lightData.Type = LocalLightType::Spot;
+        lightData.Position = transform.Position;
+        lightData.Direction = transform.GetForward();
+        lightData.Color = light.Color;
+        lightData.Intensity = light.Intensity;
+        lightData.Range = light.Range;
+        lightData.InnerConeCos = glm::cos(glm::radians(light.InnerConeAngle));
+        lightData.OuterConeCos = glm::cos(glm::radians(outerAngle));
+        SceneRenderer::SubmitLocalLight(lightData);
+    }
+
+    // Occluders are rasterized first, every other mesh is tested against their depth
+    occlusionStats_ = OcclusionStats();
+    auto occluderView = scene.GetAllEntitiesWith<TransformComponent, OccluderComponent>();
+    bool occlusion = occlusionCulling_ && occlusionCuller_;
+    if (occlusion) {
+        occlusionCuller_->BeginFrame(projection * camera.getViewMatrix());
+        for (auto entity : occluderView) {
+            auto& occluder = occluderView.get<OccluderComponent>(entity);
+            if (!occluder.Enabled || !occluder.Mesh)
+                continue;
+
+            auto& transform = occluderView.get<TransformComponent>(entity);
+            occlusionCuller_->AddOccluder(*occluder.Mesh, transform.GetTransform());
+            occlusionStats_.Occluders++;
+        }
+        occlusionCuller_->RasterizeOccluders();
+        occlusionStats_.OccluderTriangles = occlusionCuller_->GetOccluderTriangleCount();
+        occlusion = occlusionStats_.Occluders > 0;
+    }
+
     // Get all entities with TransformComponent and MeshRenderComponent
     auto view = scene.GetAllEntitiesWith<TransformComponent, MeshRenderComponent>();
 
-    int renderedCount = 0;
-    int skippedCount = 0;
+    uint32_t missingResources = 0;
+    lodStats_ = LodStats();
+    const float lodScale = std::exp2(-lodBias_);
 
     // Render each entity
     for (auto entity : view) {
@@ -73,41 +202,65 @@ void RenderSystem::Render(Scene& scene, const Camera& camera, float aspectRatio)
         auto& meshRender = view.get<MeshRenderComponent>(entity);
 
         // Skip if not visible
-        if (!meshRender.IsVisible) {
-            skippedCount++;
+        if (!meshRender.IsVisible)
             continue;
-        }
 
-        // Skip if missing vertex array or material
-        if (!meshRender.VertexArray || !meshRender.Material) {
-            SE_LOG_WARN("Entity missing VertexArray or Material!");
-            skippedCount++;
+        // Skip if missing (or released) mesh or material
+        const VertexArray* mesh = MeshManager::Get(meshRender.Mesh);
+        const Material* material = MaterialManager::Get(meshRender.Material);
+        if (!mesh || !material) {
+            missingResources++;
             continue;
         }
 
-        // Debug: Log the first entity's transform
-        static int debugCount = 0;
-        if (debugCount < 1) {
-            auto pos = transform.Position;
-            SE_LOG_INFO("First Entity Transform - Pos: ({}, {}, {})", pos.x, pos.y, pos.z);
-            SE_LOG_INFO("Camera Position: ({}, {}, {})", camera.GetPosition().x,
-                        camera.GetPosition().y, camera.GetPosition().z);
-            SE_LOG_INFO("Projection Matrix: aspectRatio = {}", aspectRatio);
-            debugCount++;
+        const glm::mat4 worldTransform = transform.GetTransform();
+        const AABB bounds = mesh->GetBounds().Transformed(worldTransform);
+
+        uint32_t lod = 0;
+        const auto& lods = mesh->GetLods();
+        if (!lods.empty()) {
+            const float screenSize =
+                ProjectedSize(bounds, camera.GetPosition(), projection) * lodScale;
+            lod = mesh->SelectLod(screenSize, meshRender.CurrentLod, lodHysteresis_);
+            if (lod != meshRender.CurrentLod) {
+                meshRender.CurrentLod = lod;
+                lodStats_.Switches++;
+                // The cached shadow was drawn with the previous level
+                if (meshRender.IsStatic && meshRender.CastShadows)
+                    scene.MarkStaticChanged();
+            }
         }
+        const VertexArray* drawn = lod > 0 ? lods[lod - 1].Mesh.get() : mesh;
+        lodStats_.Triangles += drawn->GetIndexCount() / 3;
+        lodStats_.FullDetailTriangles += mesh->GetIndexCount() / 3;
 
-        // Submit to renderer
-        SceneRenderer::Submit(meshRender.VertexArray, meshRender.Material, transform.GetTransform(),
-                              meshRender.CastShadows, meshRender.ReceiveShadows);
-        renderedCount++;
+        // Occluders aren't tested against themselves
+        if (occlusion && !occluderView.contains(entity)) {
+            occlusionStats_.TestedObjects++;
+            if (!occlusionCuller_->IsVisible(bounds)) {
+                occlusionStats_.OccludedObjects++;
+                // Hidden from the camera, but its shadow may not be
+                if (!meshRender.CastShadows)
+                    continue;
+                material = nullptr;
+            }
+        }
+
+        // Submit to renderer, with the handles resolved above
+        SceneRenderer::Submit(*drawn, material, worldTransform, meshRender.CastShadows,
+                              meshRender.ReceiveShadows, meshRender.IsStatic,
+                              static_cast<uint32_t>(entity));
     }
 
-    // Always log on first 10 frames
-    static int frameCount = 0;
-    if (frameCount < 10) {
-        SE_LOG_INFO("RenderSystem Frame {}: Rendered {} entities, Skipped {}", frameCount,
-                    renderedCount, skippedCount);
-        frameCount++;
+    // Logging allocates, so only when the number of broken entities grows
+    if (missingResources > missingResources_)
+        SE_LOG_WARN("{} entities are missing a mesh or material", missingResources);
+    missingResources_ = missingResources;
+
+    // Static shadows stay cached until a static caster changes
+    if (scene.GetStaticGeneration() != staticGeneration_) {
+        staticGeneration_ = scene.GetStaticGeneration();
+        SceneRenderer::InvalidateStaticShadows();
     }
 
     // End scene rendering
@@ -1,16 +1,27 @@
 #include "engine/ecs/Scene.h"
 #include "engine/Log.h"
+#include "engine/Metrics.h"
 #include "engine/ecs/Components.h"
 #include "engine/ecs/RenderSystem.h"
 
 namespace se {
 
-Scene::Scene(const std::string& name) : name_(name) {
+namespace {
+// Shared by every scene, so switching scenes also reads as a change
+uint64_t s_StaticGenerations = 0;
+} // namespace
+
+Scene::Scene(const std::string& name)
+    : name_(name), entityGauge_(Metrics::Gauge("se_entities", "Live entities per scene",
+                                               "scene=\"" + name + "\"")) {
+    registry_.on_construct<MeshRenderComponent>().connect<&Scene::MarkStaticChanged>(*this);
+    registry_.on_destroy<MeshRenderComponent>().connect<&Scene::MarkStaticChanged>(*this);
     SE_LOG_INFO("Scene '{}' created", name_);
 }
 
 Scene::~Scene() {
     Clear();
+    entityGauge_.Set(0.0);
     SE_LOG_INFO("Scene '{}' destroyed", name_);
 }
 
@@ -58,12 +69,17 @@ void Scene::OnUpdate(float deltaTime) {
 
     // For now, just a placeholder
     (void)deltaTime;
+    entityGauge_.Set(static_cast<double>(GetEntityCount()));
 }
 
 void Scene::OnRender(const Camera& camera, float aspectRatio) {
     RenderSystem::Render(*this, camera, aspectRatio);
 }
 
+void Scene::MarkStaticChanged() {
+    staticGeneration_ = ++s_StaticGenerations;
+}
+
 void Scene::Clear() {
     SE_LOG_INFO("Clearing scene '{}'", name_);
     registry_.clear();
@@ -1,10 +1,15 @@
 #include "engine/resources/MaterialManager.h"
 #include "engine/Log.h"
+#include "engine/Metrics.h"
+#include "engine/Profiler.h"
+#include "engine/RenderThread.h"
 
 namespace se {
-std::shared_ptr<Material> MaterialManager::defaultMaterial_;
-std::shared_ptr<Shader> MaterialManager::defaultShader_;
-std::unordered_map<std::string, std::shared_ptr<Shader>> MaterialManager::shaderCache_;
+ResourcePool<Material> MaterialManager::materials_;
+ResourcePool<Shader> MaterialManager::shaders_;
+MaterialHandle MaterialManager::defaultMaterial_;
+ShaderHandle MaterialManager::defaultShader_;
+std::unordered_map<std::string, ShaderHandle> MaterialManager::shaderCache_;
 bool MaterialManager::initialized_ = false;
 
 void MaterialManager::Init() {
@@ -22,7 +27,8 @@ void MaterialManager::Init() {
         throw std::runtime_error("Failed to create default shader");
     }
 
-    defaultMaterial_ = std::make_shared<Material>(defaultShader_);
+    defaultMaterial_ =
+        materials_.Add(std::make_shared<Material>(shaders_.GetShared(defaultShader_)));
 
     SE_LOG_INFO("MaterialManager initialized successfully");
     initialized_ = true;
@@ -34,54 +40,87 @@ void MaterialManager::Shutdown() {
 
     SE_LOG_INFO("Shutting down MaterialManager");
 
+    // Nothing is in flight anymore, resources are destroyed right away
+    materials_.Clear();
+    shaders_.Clear();
     ClearCache();
-    defaultMaterial_.reset();
-    defaultShader_.reset();
+    defaultMaterial_ = {};
+    defaultShader_ = {};
 
     initialized_ = false;
 }
 
-std::shared_ptr<Material> MaterialManager::GetDefaultMaterial() {
+MaterialHandle MaterialManager::GetDefaultMaterial() {
     if (!initialized_) {
         SE_LOG_ERROR("MaterialManager not initialized!");
-        return nullptr;
+        return {};
     }
 
     if (!defaultMaterial_) {
         SE_LOG_ERROR("Default material is null!");
-        return nullptr;
+        return {};
     }
 
     return defaultMaterial_;
 }
 
-std::shared_ptr<Material> MaterialManager::CreateMaterial(std::shared_ptr<Shader> shader) {
-    if (!shader) {
+MaterialHandle MaterialManager::CreateMaterial(ShaderHandle shader) {
+    std::shared_ptr<Shader> program = shaders_.GetShared(shader);
+    if (!program) {
         SE_LOG_WARN("Creating material with null shader, using default");
         return GetDefaultMaterial();
     }
 
-    return std::make_shared<Material>(shader);
+    return materials_.Add(std::make_shared<Material>(program));
 }
 
-std::shared_ptr<Shader> MaterialManager::GetShader(const std::string& name,
-                                                   const std::filesystem::path& vertPath,
-                                                   const std::filesystem::path& fragPath) {
+MaterialHandle MaterialManager::AddMaterial(std::shared_ptr<Material> material) {
+    return materials_.Add(std::move(material));
+}
+
+ShaderHandle MaterialManager::AddShader(std::shared_ptr<Shader> shader) {
+    return shaders_.Add(std::move(shader));
+}
+
+void MaterialManager::Release(MaterialHandle material) {
+    if (material == defaultMaterial_)
+        return;
+    materials_.Release(material);
+}
+
+void MaterialManager::Release(ShaderHandle shader) {
+    if (shader == defaultShader_)
+        return;
+    shaders_.Release(shader);
+}
+
+ShaderHandle MaterialManager::GetShader(const std::string& name,
+                                        const std::filesystem::path& vertPath,
+                                        const std::filesystem::path& fragPath) {
     if (!initialized_) {
         SE_LOG_ERROR("MaterialManager not initialized!");
-        return nullptr;
+        return {};
     }
 
+    static MetricCounter& hits = Metrics::Counter("se_cache_requests_total",
+                                                  "Resource cache lookups",
+                                                  "cache=\"shader\",result=\"hit\"");
+    static MetricCounter& misses = Metrics::Counter("se_cache_requests_total", "",
+                                                    "cache=\"shader\",result=\"miss\"");
+
     // Check cache
     auto it = shaderCache_.find(name);
     if (it != shaderCache_.end()) {
-        SE_LOG_INFO("Shader '{}' found in cache", name);
+        hits.Add();
         return it->second;
     }
+    misses.Add();
 
     // Load and cache shader
+    SE_PROFILE_SCOPE("MaterialManager::LoadShader");
+    RenderThread::RequireContext("MaterialManager::GetShader");
     try {
-        auto shader = Shader::CreateFromFiles(vertPath, fragPath);
+        const ShaderHandle shader = shaders_.Add(Shader::CreateFromFiles(vertPath, fragPath));
         shaderCache_[name] = shader;
         SE_LOG_INFO("Loaded and cached shader: {}", name);
         return shader;
@@ -94,22 +133,28 @@ std::shared_ptr<Shader> MaterialManager::GetShader(const std::string& name,
 void MaterialManager::CreateDefaultShader() {
     SE_LOG_INFO("Creating default shader...");
 
-    // Simple default vertex shader
+    // Simple default vertex shader; the model matrix comes from the GPU scene like basic.vert
     const std::string vertexSrc = R"(
     #version 330 core
     layout(location = 0) in vec3 a_Position;
     layout(location = 1) in vec3 a_Color;
-    layout(location = 2) in vec3 a_Normal;  // ← ADICIONE
+    layout(location = 2) in vec3 a_Normal;
+    layout(location = 3) in int a_ObjectIndex;
 
-    uniform mat4 uView;
-    uniform mat4 uProj;
-    uniform mat4 uModel;
+    uniform mat4 uViewProjection;
+    uniform samplerBuffer uObjectData;
 
     out vec3 v_Color;
 
+    // Must match the depth pre-pass shader bit for bit (GL_EQUAL depth test)
+    invariant gl_Position;
+
     void main() {
+        int base = a_ObjectIndex * 8;
+        mat4 model = mat4(texelFetch(uObjectData, base), texelFetch(uObjectData, base + 1),
+                          texelFetch(uObjectData, base + 2), texelFetch(uObjectData, base + 3));
         v_Color = a_Color;
-        gl_Position = uProj * uView * uModel * vec4(a_Position, 1.0);
+        gl_Position = uViewProjection * (model * vec4(a_Position, 1.0));
     }
 )";
 
@@ -126,8 +171,9 @@ void MaterialManager::CreateDefaultShader() {
     )";
 
     try {
-        defaultShader_ = std::make_shared<Shader>(vertexSrc, fragmentSrc);
-        SE_LOG_INFO("Default shader created successfully (ID: {})", defaultShader_->getID());
+        defaultShader_ = shaders_.Add(std::make_shared<Shader>(vertexSrc, fragmentSrc));
+        SE_LOG_INFO("Default shader created successfully (ID: {})",
+                    shaders_.Get(defaultShader_)->getID());
     } catch (const std::exception& e) {
         SE_LOG_ERROR("Failed to create default shader: {}", e.what());
         throw;
@@ -135,6 +181,9 @@ void MaterialManager::CreateDefaultShader() {
 }
 
 void MaterialManager::ClearCache() {
+    for (const auto& [name, shader] : shaderCache_) {
+        Release(shader);
+    }
     shaderCache_.clear();
     SE_LOG_INFO("MaterialManager cache cleared");
 }
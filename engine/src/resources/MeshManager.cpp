@@ -1,11 +1,107 @@
 #include "engine/resources/MeshManager.h"
 #include "engine/Log.h"
 #include "engine/MeshFactory.h"
+#include "engine/Metrics.h"
+#include "engine/Profiler.h"
+#include "engine/RenderThread.h"
 #include "engine/renderer/Buffer.h"
+#include "engine/renderer/VertexPacking.h"
+#include "engine/resources/MeshOptimizer.h"
+#include "engine/resources/MeshSimplifier.h"
+#include <array>
+#include <cstring>
+
+namespace {
+constexpr uint32_t kArenaVertexCapacity = 64 * 1024;
+constexpr uint32_t kArenaIndexCapacity = 192 * 1024;
+
+// Interleaved position (3) + color (3) + normal (3)
+constexpr uint32_t kFloatsPerVertex = 9;
+constexpr int kNormalOffset = 6;
+
+struct LodLevel {
+    float IndexRatio; // of the full-detail mesh
+    float MaxError;   // relative to the mesh extent
+    float ScreenSize; // used below this fraction of the screen height
+};
+constexpr std::array<LodLevel, 3> kLodLevels = {{
+    {0.5f, 0.02f, 0.3f},
+    {0.25f, 0.05f, 0.15f},
+    {0.125f, 0.1f, 0.07f},
+}};
+// Segments of the primitive LODs; full detail is 32 for the sphere, 16 for the others
+constexpr std::array<int, 3> kSphereLodSegments = {16, 12, 8};
+constexpr std::array<int, 3> kRoundLodSegments = {12, 8, 6};
+// Smaller meshes aren't simplified, and a level must shed at least 20% of the previous one
+constexpr size_t kMinLodIndexCount = 64 * 3;
+constexpr float kMinLodReduction = 0.8f;
+
+// Half positions keep about 11 bits of mantissa; they are used when that stays within this
+// fraction of the mesh size (meshes far from their origin keep full floats)
+constexpr float kMaxHalfPositionError = 1e-3f;
+constexpr float kHalfEpsilon = 1.0f / 2048.0f;
+constexpr float kMaxHalf = 65504.0f;
+
+// Position Half4 (or Float3), color UByte4, normal Int2_10_10_10_Rev: 16 (20) bytes instead of 36
+se::BufferLayout PackVertices(const std::vector<float>& vertices, const se::AABB& bounds,
+                              std::vector<uint8_t>& packed) {
+    const glm::vec3 farthest = glm::max(glm::abs(bounds.Min), glm::abs(bounds.Max));
+    const float maxCoordinate = glm::max(farthest.x, glm::max(farthest.y, farthest.z));
+    const float extent = glm::length(bounds.Max - bounds.Min);
+    const bool halfPositions = maxCoordinate < kMaxHalf &&
+                               maxCoordinate * kHalfEpsilon <= kMaxHalfPositionError * extent;
+
+    se::BufferLayout layout(
+        {{halfPositions ? se::ShaderDataType::Half4 : se::ShaderDataType::Float3, "a_Position"},
+         {se::ShaderDataType::UByte4, "a_Color", true},
+         {se::ShaderDataType::Int2_10_10_10_Rev, "a_Normal", true}});
+    const uint32_t stride = layout.GetStride();
+    const size_t vertexCount = vertices.size() / kFloatsPerVertex;
+    packed.assign(vertexCount * stride, 0);
+
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float* source = &vertices[v * kFloatsPerVertex];
+        uint8_t* target = &packed[v * stride];
+        const glm::vec3 position(source[0], source[1], source[2]);
+
+        uint32_t offset = 0;
+        if (halfPositions) {
+            uint16_t half[4];
+            se::PackHalf4(position, half);
+            std::memcpy(target, half, sizeof(half));
+            offset = sizeof(half);
+        } else {
+            std::memcpy(target, &position, sizeof(position));
+            offset = sizeof(position);
+        }
+
+        const uint32_t color = se::PackColor(glm::vec3(source[3], source[4], source[5]));
+        const uint32_t normal = se::PackNormal(glm::vec3(source[6], source[7], source[8]));
+        std::memcpy(target + offset, &color, sizeof(color));
+        std::memcpy(target + offset + sizeof(color), &normal, sizeof(normal));
+    }
+    return layout;
+}
+
+std::string LayoutKey(const se::BufferLayout& layout) {
+    std::string key;
+    for (const auto& element : layout) {
+        key += element.Name;
+        key += ':';
+        key += std::to_string(static_cast<int>(element.Type));
+        key += element.Normalized ? "n;" : ";";
+    }
+    return key;
+}
+} // namespace
 
 namespace se {
-std::unordered_map<PrimitiveMeshType, std::shared_ptr<VertexArray>> MeshManager::primitiveCache_;
+ResourcePool<VertexArray> MeshManager::meshes_;
+std::unordered_map<PrimitiveMeshType, MeshHandle> MeshManager::primitiveCache_;
+std::unordered_map<std::string, std::shared_ptr<GeometryArena>> MeshManager::arenas_;
 bool MeshManager::initialized_ = false;
+bool MeshManager::optimizeMeshes_ = true;
+bool MeshManager::compressVertices_ = true;
 
 void MeshManager::Init() {
     if (initialized_) {
@@ -23,60 +119,165 @@ void MeshManager::Shutdown() {
         return;
 
     SE_LOG_INFO("Shutting down MeshManager");
+    // Nothing is in flight anymore, meshes are destroyed right away
+    meshes_.Clear();
     ClearCache();
+    // Meshes still referenced elsewhere keep their arena alive
+    arenas_.clear();
     initialized_ = false;
 }
 
-std::shared_ptr<VertexArray> MeshManager::CreateVertexArrayFromMesh(const Mesh& mesh) {
-    // COPIE os dados para garantir que eles persistem
-    std::vector<float> vertices = mesh.getVertices();
-    std::vector<unsigned int> indices = mesh.getIndices();
+std::shared_ptr<VertexArray> MeshManager::CreateVertexArrayFromMesh(const Mesh& mesh,
+                                                                    bool generateLods) {
+    SE_LOG_INFO("Creating VertexArray from mesh: {} vertices, {} indices",
+                mesh.getVertices().size() / kFloatsPerVertex, mesh.getIndices().size());
+
+    auto vertexArray = CreateVertexArray(mesh.getVertices(), mesh.getIndices());
+    if (generateLods)
+        vertexArray->SetLods(GenerateLods(mesh.getVertices(), mesh.getIndices()));
+
+    SE_LOG_INFO("VertexArray created successfully");
+    return vertexArray;
+}
+
+MeshHandle MeshManager::CreateMesh(const Mesh& mesh, bool generateLods) {
+    return meshes_.Add(CreateVertexArrayFromMesh(mesh, generateLods));
+}
+
+MeshHandle MeshManager::AddMesh(std::shared_ptr<VertexArray> vertexArray) {
+    return meshes_.Add(std::move(vertexArray));
+}
+
+void MeshManager::Release(MeshHandle mesh) {
+    meshes_.Release(mesh);
+}
+
+std::shared_ptr<VertexArray> MeshManager::CreateVertexArray(std::vector<float> vertices,
+                                                            std::vector<uint32_t> indices) {
+    SE_PROFILE_SCOPE("MeshManager::CreateVertexArray");
+    RenderThread::RequireContext("MeshManager::CreateVertexArray");
+    if (optimizeMeshes_) {
+        const uint32_t inputVertices = static_cast<uint32_t>(vertices.size() / kFloatsPerVertex);
+        const auto before = MeshOptimizer::AnalyzeVertexCache(indices, inputVertices);
+        MeshOptimizer::Optimize(vertices, kFloatsPerVertex, indices);
+        const auto after = MeshOptimizer::AnalyzeVertexCache(
+            indices, static_cast<uint32_t>(vertices.size() / kFloatsPerVertex));
+        SE_LOG_INFO("Optimized mesh: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", before.Acmr,
+                    after.Acmr, before.Atvr, after.Atvr);
+    }
 
-    SE_LOG_INFO("Creating VertexArray from mesh: {} vertices, {} indices", vertices.size() / 9,
-                indices.size());
+    AABB bounds;
+    for (size_t i = 0; i + 2 < vertices.size(); i += kFloatsPerVertex) {
+        bounds.Expand(glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]));
+    }
 
-    // Create vertex buffer - os dados agora estão em variáveis locais
-    auto vertexBuffer = std::make_shared<VertexBuffer>(
-        vertices.data(), static_cast<uint32_t>(vertices.size() * sizeof(float)));
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / kFloatsPerVertex);
+    const IndexType indexType = vertexCount <= 0x10000 ? IndexType::UInt16 : IndexType::UInt32;
 
     // Layout: position (3) + color (3) + normal (3)
-    vertexBuffer->SetLayout(BufferLayout({{ShaderDataType::Float3, "a_Position"},
-                                          {ShaderDataType::Float3, "a_Color"},
-                                          {ShaderDataType::Float3, "a_Normal"}}));
+    BufferLayout layout({{ShaderDataType::Float3, "a_Position"},
+                         {ShaderDataType::Float3, "a_Color"},
+                         {ShaderDataType::Float3, "a_Normal"}});
+    const void* vertexData = vertices.data();
+    std::vector<uint8_t> packed;
+    if (compressVertices_) {
+        layout = PackVertices(vertices, bounds, packed);
+        vertexData = packed.data();
+        SE_LOG_INFO("Compressed mesh: {} -> {} bytes per vertex, {}-bit indices",
+                    kFloatsPerVertex * sizeof(float), layout.GetStride(),
+                    IndexTypeSize(indexType) * 8);
+    }
 
-    // Create index buffer
-    auto indexBuffer =
-        std::make_shared<IndexBuffer>(indices.data(), static_cast<uint32_t>(indices.size()));
+    std::shared_ptr<VertexArray> vertexArray;
+    auto arena = GetArena(layout, indexType);
+    const GeometryArena::AllocationId allocation =
+        arena->Allocate(vertexData, vertexCount, indices.data(),
+                        static_cast<uint32_t>(indices.size()));
 
-    // Create and setup vertex array
-    auto vertexArray = std::make_shared<VertexArray>();
-    vertexArray->AddVertexBuffer(vertexBuffer);
-    vertexArray->SetIndexBuffer(indexBuffer);
+    if (allocation != GeometryArena::kInvalidAllocation) {
+        vertexArray = std::make_shared<VertexArray>(arena, allocation);
+    } else {
+        auto vertexBuffer =
+            std::make_shared<VertexBuffer>(vertexData, vertexCount * layout.GetStride());
+        vertexBuffer->SetLayout(layout);
 
-    SE_LOG_INFO("VertexArray created successfully");
+        std::shared_ptr<IndexBuffer> indexBuffer;
+        const auto indexCount = static_cast<uint32_t>(indices.size());
+        if (indexType == IndexType::UInt16) {
+            const std::vector<uint16_t> narrowed(indices.begin(), indices.end());
+            indexBuffer = std::make_shared<IndexBuffer>(narrowed.data(), indexCount);
+        } else {
+            indexBuffer = std::make_shared<IndexBuffer>(indices.data(), indexCount);
+        }
+
+        vertexArray = std::make_shared<VertexArray>();
+        vertexArray->AddVertexBuffer(vertexBuffer);
+        vertexArray->SetIndexBuffer(indexBuffer);
+    }
+
+    vertexArray->SetBounds(bounds);
     return vertexArray;
 }
 
-std::shared_ptr<VertexArray> MeshManager::GetPrimitive(PrimitiveMeshType type) {
+std::vector<VertexArray::Lod> MeshManager::GenerateLods(const std::vector<float>& vertices,
+                                                        const std::vector<uint32_t>& indices) {
+    SE_PROFILE_SCOPE("MeshManager::GenerateLods");
+    std::vector<VertexArray::Lod> lods;
+    if (indices.size() < kMinLodIndexCount)
+        return lods;
+
+    std::vector<uint32_t> previous = indices;
+    for (const LodLevel& level : kLodLevels) {
+        const auto target = static_cast<uint32_t>(indices.size() * level.IndexRatio) / 3 * 3;
+        MeshSimplifier::Result simplified = MeshSimplifier::Simplify(
+            vertices, kFloatsPerVertex, previous, target, level.MaxError, kNormalOffset);
+
+        // Not worth a level of its own (the error limit stopped it early)
+        if (simplified.Indices.empty() ||
+            simplified.Indices.size() > previous.size() * kMinLodReduction)
+            break;
+
+        std::vector<float> lodVertices = vertices;
+        std::vector<uint32_t> lodIndices = simplified.Indices;
+        MeshSimplifier::CompactVertices(lodVertices, kFloatsPerVertex, lodIndices);
+
+        SE_LOG_INFO("Generated LOD {}: {} -> {} indices, error {:.4f}", lods.size() + 1,
+                    indices.size(), lodIndices.size(), simplified.Error);
+        lods.push_back(
+            {CreateVertexArray(std::move(lodVertices), std::move(lodIndices)), level.ScreenSize});
+        previous = std::move(simplified.Indices);
+    }
+    return lods;
+}
+
+MeshHandle MeshManager::GetPrimitive(PrimitiveMeshType type) {
     if (!initialized_) {
         SE_LOG_ERROR("MeshManager not initialized!");
-        return nullptr;
+        return {};
     }
 
+    static MetricCounter& hits = Metrics::Counter("se_cache_requests_total",
+                                                  "Resource cache lookups",
+                                                  "cache=\"primitive_mesh\",result=\"hit\"");
+    static MetricCounter& misses = Metrics::Counter("se_cache_requests_total", "",
+                                                    "cache=\"primitive_mesh\",result=\"miss\"");
+
     // Check cache
     auto it = primitiveCache_.find(type);
     if (it != primitiveCache_.end()) {
-        SE_LOG_INFO("Primitive mesh found in cache");
+        hits.Add();
         return it->second;
     }
+    misses.Add();
 
     // Create and cache
+    RenderThread::RequireContext("MeshManager::GetPrimitive");
     SE_LOG_INFO("Creating new primitive mesh");
-    auto primitive = CreatePrimitive(type);
+    const MeshHandle primitive = meshes_.Add(CreatePrimitive(type));
 
     if (!primitive) {
         SE_LOG_ERROR("Failed to create primitive mesh!");
-        return nullptr;
+        return {};
     }
 
     primitiveCache_[type] = primitive;
@@ -119,10 +320,76 @@ std::shared_ptr<VertexArray> MeshManager::CreatePrimitive(PrimitiveMeshType type
             break;
     }
 
-    return CreateVertexArrayFromMesh(mesh);
+    auto vertexArray = CreateVertexArrayFromMesh(mesh, false);
+
+    // Parametric shapes get coarser tessellations instead of simplified ones
+    std::vector<VertexArray::Lod> lods;
+    for (size_t i = 0; i < kLodLevels.size(); ++i) {
+        Mesh lodMesh;
+        switch (type) {
+            case PrimitiveMeshType::Sphere:
+                lodMesh = MeshFactory::CreateSphere(kSphereLodSegments[i],
+                                                    kSphereLodSegments[i] / 2);
+                break;
+            case PrimitiveMeshType::Capsule:
+                lodMesh = MeshFactory::CreateCapsule(0.5f, 1.0f, kRoundLodSegments[i]);
+                break;
+            case PrimitiveMeshType::Cylinder:
+                lodMesh = MeshFactory::CreateCylinder(0.5f, 1.0f, kRoundLodSegments[i]);
+                break;
+            default:
+                break;
+        }
+        if (lodMesh.getIndices().empty())
+            break;
+        lods.push_back({CreateVertexArrayFromMesh(lodMesh, false), kLodLevels[i].ScreenSize});
+    }
+    vertexArray->SetLods(std::move(lods));
+
+    return vertexArray;
+}
+
+std::shared_ptr<GeometryArena> MeshManager::GetArena(const BufferLayout& layout,
+                                                     IndexType indexType) {
+    const std::string key = LayoutKey(layout) + (indexType == IndexType::UInt16 ? "i16" : "i32");
+    auto it = arenas_.find(key);
+    if (it != arenas_.end())
+        return it->second;
+
+    auto arena = std::make_shared<GeometryArena>(layout, kArenaVertexCapacity,
+                                                 kArenaIndexCapacity, indexType);
+    arenas_[key] = arena;
+    return arena;
+}
+
+void MeshManager::DefragmentArenas(float fragmentationThreshold) {
+    RenderThread::RequireContext("MeshManager::DefragmentArenas");
+    for (auto& [key, arena] : arenas_) {
+        if (arena->GetFragmentation() > fragmentationThreshold)
+            arena->Defragment();
+    }
+}
+
+void MeshManager::SetMeshOptimization(bool enabled) {
+    optimizeMeshes_ = enabled;
+}
+
+bool MeshManager::IsMeshOptimizationEnabled() {
+    return optimizeMeshes_;
+}
+
+void MeshManager::SetVertexCompression(bool enabled) {
+    compressVertices_ = enabled;
+}
+
+bool MeshManager::IsVertexCompressionEnabled() {
+    return compressVertices_;
 }
 
 void MeshManager::ClearCache() {
+    for (const auto& [type, primitive] : primitiveCache_) {
+        meshes_.Release(primitive);
+    }
     primitiveCache_.clear();
     SE_LOG_INFO("MeshManager cache cleared");
 }
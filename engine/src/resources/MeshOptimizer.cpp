@@ -0,0 +1,234 @@
+#include "engine/resources/MeshOptimizer.h"
+#include <algorithm>
+#include <glm.hpp>
+#include <numeric>
+
+namespace se {
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices,
+                                                            uint32_t vertexCount,
+                                                            uint32_t cacheSize) {
+    CacheStats stats;
+    if (indices.size() < 3 || vertexCount == 0)
+        return stats;
+
+    // FIFO: a vertex is in the cache if it was pushed less than cacheSize misses ago
+    std::vector<uint32_t> pushedAt(vertexCount, 0);
+    uint32_t misses = 0;
+    for (uint32_t index : indices) {
+        if (pushedAt[index] == 0 || misses + 1 - pushedAt[index] > cacheSize) {
+            misses++;
+            pushedAt[index] = misses;
+        }
+    }
+
+    stats.Acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    stats.Atvr = static_cast<float>(misses) / static_cast<float>(vertexCount);
+    return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount,
+                                        std::vector<uint32_t>* clusters, uint32_t cacheSize) {
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (clusters)
+        clusters->clear();
+    if (triangleCount == 0 || vertexCount == 0)
+        return;
+
+    // Vertex -> triangles, and the number of triangles still to emit per vertex
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices) {
+        liveTriangles[index]++;
+    }
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (uint32_t t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                adjacency[fill[indices[t * 3 + k]]++] = t;
+            }
+        }
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t time = cacheSize + 1;
+    uint32_t cursor = 0;
+
+    // Recently used vertices first, then the next unfinished vertex in input order
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEnds.empty()) {
+            const uint32_t v = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[v] > 0)
+                return v;
+        }
+        while (cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0)
+                return cursor;
+            cursor++;
+        }
+        return -1;
+    };
+
+    int64_t fan = skipDeadEnd();
+    while (fan >= 0) {
+        candidates.clear();
+        for (uint32_t i = adjacencyOffsets[fan]; i < adjacencyOffsets[fan + 1]; ++i) {
+            const uint32_t t = adjacency[i];
+            if (emitted[t])
+                continue;
+
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t v = indices[t * 3 + k];
+                result.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = time;
+                    time++;
+                }
+            }
+            emitted[t] = 1;
+        }
+
+        // The candidate that will still be cached after its remaining triangles are emitted
+        // and that entered the cache earliest
+        int64_t next = -1;
+        int64_t best = -1;
+        for (uint32_t v : candidates) {
+            if (liveTriangles[v] == 0)
+                continue;
+            int64_t priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                priority = time - cacheTime[v];
+            if (priority > best) {
+                best = priority;
+                next = v;
+            }
+        }
+
+        if (next < 0) {
+            next = skipDeadEnd();
+            if (clusters && next >= 0 && result.size() < indices.size())
+                clusters->push_back(static_cast<uint32_t>(result.size() / 3));
+        }
+        fan = next;
+    }
+
+    if (clusters)
+        clusters->insert(clusters->begin(), 0u);
+    indices = std::move(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices,
+                                     const std::vector<uint32_t>& clusters,
+                                     const std::vector<float>& vertices, uint32_t floatsPerVertex,
+                                     float threshold) {
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / floatsPerVertex);
+    if (clusters.size() < 2 || triangleCount == 0)
+        return;
+
+    auto position = [&](uint32_t v) {
+        const float* p = &vertices[static_cast<size_t>(v) * floatsPerVertex];
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    struct Cluster {
+        uint32_t First;
+        uint32_t Count;
+        glm::vec3 Centroid{0.0f}; // area weighted
+        glm::vec3 Normal{0.0f};   // area weighted
+        float Area = 0.0f;
+        float Sort = 0.0f;
+    };
+
+    std::vector<Cluster> sorted(clusters.size());
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        Cluster& cluster = sorted[c];
+        cluster.First = clusters[c];
+        cluster.Count = (c + 1 < clusters.size() ? clusters[c + 1] : triangleCount) - cluster.First;
+
+        for (uint32_t t = cluster.First; t < cluster.First + cluster.Count; ++t) {
+            const glm::vec3 p0 = position(indices[t * 3]);
+            const glm::vec3 p1 = position(indices[t * 3 + 1]);
+            const glm::vec3 p2 = position(indices[t * 3 + 2]);
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            const float area = glm::length(n);
+            cluster.Centroid += (p0 + p1 + p2) * (area / 3.0f);
+            cluster.Normal += n;
+            cluster.Area += area;
+        }
+        meshCentroid += cluster.Centroid;
+        meshArea += cluster.Area;
+    }
+    if (meshArea <= 0.0f)
+        return;
+    meshCentroid /= meshArea;
+
+    for (Cluster& cluster : sorted) {
+        if (cluster.Area <= 0.0f)
+            continue;
+        const float length = glm::length(cluster.Normal);
+        const glm::vec3 normal = length > 0.0f ? cluster.Normal / length : glm::vec3(0.0f);
+        cluster.Sort = glm::dot(cluster.Centroid / cluster.Area - meshCentroid, normal);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Cluster& a, const Cluster& b) { return a.Sort > b.Sort; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : sorted) {
+        result.insert(result.end(), indices.begin() + cluster.First * 3,
+                      indices.begin() + (cluster.First + cluster.Count) * 3);
+    }
+
+    const float before = AnalyzeVertexCache(indices, vertexCount).Acmr;
+    const float after = AnalyzeVertexCache(result, vertexCount).Acmr;
+    if (after <= before * threshold)
+        indices = std::move(result);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<float>& vertices, uint32_t floatsPerVertex,
+                                        std::vector<uint32_t>& indices) {
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / floatsPerVertex);
+    constexpr uint32_t kUnused = ~0u;
+    std::vector<uint32_t> remap(vertexCount, kUnused);
+
+    std::vector<float> reordered;
+    reordered.reserve(vertices.size());
+    for (uint32_t& index : indices) {
+        if (remap[index] == kUnused) {
+            remap[index] = static_cast<uint32_t>(reordered.size() / floatsPerVertex);
+            const auto first = vertices.begin() + static_cast<size_t>(index) * floatsPerVertex;
+            reordered.insert(reordered.end(), first, first + floatsPerVertex);
+        }
+        index = remap[index];
+    }
+
+    vertices = std::move(reordered);
+}
+
+void MeshOptimizer::Optimize(std::vector<float>& vertices, uint32_t floatsPerVertex,
+                             std::vector<uint32_t>& indices) {
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / floatsPerVertex);
+    std::vector<uint32_t> clusters;
+    OptimizeVertexCache(indices, vertexCount, &clusters);
+    OptimizeOverdraw(indices, clusters, vertices, floatsPerVertex);
+    OptimizeVertexFetch(vertices, floatsPerVertex, indices);
+}
+
+} // namespace se
@@ -0,0 +1,358 @@
+#include "engine/resources/MeshSimplifier.h"
+#include "engine/resources/MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm.hpp>
+#include <unordered_map>
+
+namespace se {
+
+namespace {
+// Boundary edges get a perpendicular plane this much heavier than surface planes, so open
+// borders keep their outline
+constexpr double kBoundaryWeight = 10.0;
+// Collapses may rotate a neighbouring triangle by at most ~80 degrees
+constexpr double kMinNormalCos = 0.2;
+
+// Symmetric 4x4 error matrix, upper triangle
+struct Quadric {
+    double A00 = 0, A01 = 0, A02 = 0, A03 = 0;
+    double A11 = 0, A12 = 0, A13 = 0;
+    double A22 = 0, A23 = 0;
+    double A33 = 0;
+
+    static Quadric FromPlane(const glm::dvec3& n, double d, double weight) {
+        Quadric q;
+        q.A00 = n.x * n.x * weight;
+        q.A01 = n.x * n.y * weight;
+        q.A02 = n.x * n.z * weight;
+        q.A03 = n.x * d * weight;
+        q.A11 = n.y * n.y * weight;
+        q.A12 = n.y * n.z * weight;
+        q.A13 = n.y * d * weight;
+        q.A22 = n.z * n.z * weight;
+        q.A23 = n.z * d * weight;
+        q.A33 = d * d * weight;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& o) {
+        A00 += o.A00;
+        A01 += o.A01;
+        A02 += o.A02;
+        A03 += o.A03;
+        A11 += o.A11;
+        A12 += o.A12;
+        A13 += o.A13;
+        A22 += o.A22;
+        A23 += o.A23;
+        A33 += o.A33;
+        return *this;
+    }
+
+    // Weighted squared distance of p to the accumulated planes
+    double Evaluate(const glm::dvec3& p) const {
+        const double x = p.x, y = p.y, z = p.z;
+        return A00 * x * x + 2 * A01 * x * y + 2 * A02 * x * z + 2 * A03 * x + A11 * y * y +
+               2 * A12 * y * z + 2 * A13 * y + A22 * z * z + 2 * A23 * z + A33;
+    }
+};
+
+struct PositionKey {
+    float X, Y, Z;
+
+    bool operator==(const PositionKey& o) const {
+        return X == o.X && Y == o.Y && Z == o.Z;
+    }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const {
+        uint32_t bits[3];
+        std::memcpy(bits, &key, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+struct Collapse {
+    uint32_t From;
+    uint32_t To;
+    double Cost;
+};
+} // namespace
+
+MeshSimplifier::Result MeshSimplifier::Simplify(const std::vector<float>& vertices,
+                                                uint32_t floatsPerVertex,
+                                                const std::vector<uint32_t>& indices,
+                                                uint32_t targetIndexCount, float maxError,
+                                                int normalOffset) {
+    Result result;
+    result.Indices = indices;
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / floatsPerVertex);
+    if (indices.size() <= targetIndexCount || vertexCount == 0)
+        return result;
+
+    auto position = [&](uint32_t v) {
+        const float* p = &vertices[static_cast<size_t>(v) * floatsPerVertex];
+        return glm::dvec3(p[0], p[1], p[2]);
+    };
+    auto normal = [&](uint32_t v) {
+        const float* n = &vertices[static_cast<size_t>(v) * floatsPerVertex + normalOffset];
+        return glm::vec3(n[0], n[1], n[2]);
+    };
+
+    // Weld by position: collapses work on "corners", every vertex copy follows its corner
+    std::vector<uint32_t> corner(vertexCount);
+    std::vector<glm::dvec3> cornerPositions;
+    std::vector<std::vector<uint32_t>> cornerVertices;
+    {
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> lookup;
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            const float* p = &vertices[static_cast<size_t>(v) * floatsPerVertex];
+            auto [it, inserted] = lookup.emplace(PositionKey{p[0], p[1], p[2]},
+                                                 static_cast<uint32_t>(cornerPositions.size()));
+            if (inserted) {
+                cornerPositions.push_back(position(v));
+                cornerVertices.emplace_back();
+            }
+            corner[v] = it->second;
+            cornerVertices[it->second].push_back(v);
+        }
+    }
+    const uint32_t cornerCount = static_cast<uint32_t>(cornerPositions.size());
+
+    glm::dvec3 lo(1e300), hi(-1e300);
+    for (const glm::dvec3& p : cornerPositions) {
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    const double extent = std::max(glm::length(hi - lo), 1e-12);
+    const double errorLimit = static_cast<double>(maxError) * extent;
+    const double costLimit = errorLimit * errorLimit;
+
+    std::vector<Quadric> quadrics(cornerCount);
+    std::vector<uint32_t>& tris = result.Indices;
+
+    // Surface planes weighted by area
+    for (size_t i = 0; i + 2 < tris.size(); i += 3) {
+        const glm::dvec3 p0 = cornerPositions[corner[tris[i]]];
+        const glm::dvec3 p1 = cornerPositions[corner[tris[i + 1]]];
+        const glm::dvec3 p2 = cornerPositions[corner[tris[i + 2]]];
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        const double length = glm::length(n);
+        if (length <= 0.0)
+            continue;
+        n /= length;
+        const Quadric q = Quadric::FromPlane(n, -glm::dot(n, p0), length * 0.5);
+        for (int k = 0; k < 3; ++k) {
+            quadrics[corner[tris[i + k]]] += q;
+        }
+    }
+
+    // Border edges (used by one triangle) get a plane through the edge, perpendicular to it
+    {
+        std::unordered_map<uint64_t, int> edgeUse;
+        auto edgeKey = [](uint32_t a, uint32_t b) {
+            return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+        };
+        for (size_t i = 0; i + 2 < tris.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                edgeUse[edgeKey(corner[tris[i + k]], corner[tris[i + (k + 1) % 3]])]++;
+            }
+        }
+        for (size_t i = 0; i + 2 < tris.size(); i += 3) {
+            const glm::dvec3 p0 = cornerPositions[corner[tris[i]]];
+            const glm::dvec3 p1 = cornerPositions[corner[tris[i + 1]]];
+            const glm::dvec3 p2 = cornerPositions[corner[tris[i + 2]]];
+            const glm::dvec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+            if (glm::length(faceNormal) <= 0.0)
+                continue;
+
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t a = corner[tris[i + k]];
+                const uint32_t b = corner[tris[i + (k + 1) % 3]];
+                if (edgeUse[edgeKey(a, b)] != 1)
+                    continue;
+
+                const glm::dvec3 edge = cornerPositions[b] - cornerPositions[a];
+                glm::dvec3 n = glm::cross(edge, faceNormal);
+                const double length = glm::length(n);
+                if (length <= 0.0)
+                    continue;
+                n /= length;
+                const Quadric q = Quadric::FromPlane(n, -glm::dot(n, cornerPositions[a]),
+                                                     kBoundaryWeight * glm::dot(edge, edge));
+                quadrics[a] += q;
+                quadrics[b] += q;
+            }
+        }
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(cornerCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint64_t> edges;
+    std::vector<Collapse> collapses;
+    std::vector<uint8_t> locked(cornerCount);
+    std::vector<uint32_t> cornerRemap(cornerCount);
+
+    while (tris.size() > targetIndexCount) {
+        const uint32_t triangleCount = static_cast<uint32_t>(tris.size() / 3);
+
+        // Corner -> triangles
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+        for (uint32_t index : tris) {
+            adjacencyOffsets[corner[index] + 1]++;
+        }
+        for (uint32_t c = 0; c < cornerCount; ++c) {
+            adjacencyOffsets[c + 1] += adjacencyOffsets[c];
+        }
+        adjacency.resize(tris.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (uint32_t t = 0; t < triangleCount; ++t) {
+                for (int k = 0; k < 3; ++k) {
+                    adjacency[fill[corner[tris[t * 3 + k]]]++] = t;
+                }
+            }
+        }
+
+        edges.clear();
+        for (uint32_t t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t a = corner[tris[t * 3 + k]];
+                const uint32_t b = corner[tris[t * 3 + (k + 1) % 3]];
+                edges.push_back((static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        // Each edge collapses toward its cheaper end
+        collapses.clear();
+        for (uint64_t edge : edges) {
+            const uint32_t a = static_cast<uint32_t>(edge >> 32);
+            const uint32_t b = static_cast<uint32_t>(edge & 0xffffffffu);
+
+            Quadric q = quadrics[a];
+            q += quadrics[b];
+            const double toB = q.Evaluate(cornerPositions[b]);
+            const double toA = q.Evaluate(cornerPositions[a]);
+            if (toB <= toA)
+                collapses.push_back({a, b, toB});
+            else
+                collapses.push_back({b, a, toA});
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& x, const Collapse& y) { return x.Cost < y.Cost; });
+
+        std::fill(locked.begin(), locked.end(), uint8_t(0));
+        for (uint32_t c = 0; c < cornerCount; ++c) {
+            cornerRemap[c] = c;
+        }
+
+        const uint32_t removeBudget =
+            triangleCount - static_cast<uint32_t>(targetIndexCount / 3);
+        uint32_t removed = 0;
+        uint32_t applied = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.Cost > costLimit || removed >= removeBudget)
+                break;
+            if (locked[collapse.From] || locked[collapse.To])
+                continue;
+
+            // Reject collapses that flip a surviving triangle around the removed corner
+            bool flips = false;
+            uint32_t collapsedTriangles = 0;
+            const glm::dvec3 target = cornerPositions[collapse.To];
+            for (uint32_t i = adjacencyOffsets[collapse.From];
+                 i < adjacencyOffsets[collapse.From + 1] && !flips; ++i) {
+                const uint32_t t = adjacency[i];
+                uint32_t c[3];
+                for (int k = 0; k < 3; ++k) {
+                    c[k] = corner[tris[t * 3 + k]];
+                }
+                if (c[0] == collapse.To || c[1] == collapse.To || c[2] == collapse.To) {
+                    collapsedTriangles++;
+                    continue;
+                }
+
+                glm::dvec3 before[3], after[3];
+                for (int k = 0; k < 3; ++k) {
+                    before[k] = cornerPositions[c[k]];
+                    after[k] = c[k] == collapse.From ? target : before[k];
+                }
+                const glm::dvec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+                const glm::dvec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+                // Also rejects near-flips, which turn into real ones after the next collapse
+                flips = glm::dot(n0, n1) <= kMinNormalCos * glm::length(n0) * glm::length(n1);
+            }
+            if (flips)
+                continue;
+
+            cornerRemap[collapse.From] = collapse.To;
+            quadrics[collapse.To] += quadrics[collapse.From];
+            result.Error = std::max(result.Error,
+                                    static_cast<float>(std::sqrt(std::max(collapse.Cost, 0.0)) /
+                                                       extent));
+            removed += collapsedTriangles;
+            applied++;
+
+            // Lock the one-ring, its triangles changed and the flip test above is now stale
+            for (uint32_t i = adjacencyOffsets[collapse.From];
+                 i < adjacencyOffsets[collapse.From + 1]; ++i) {
+                for (int k = 0; k < 3; ++k) {
+                    locked[corner[tris[adjacency[i] * 3 + k]]] = 1;
+                }
+            }
+        }
+
+        if (applied == 0)
+            break;
+
+        // Move every copy of a removed corner to the target copy with the closest normal
+        std::vector<uint32_t> vertexRemap(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            vertexRemap[v] = v;
+            const uint32_t to = cornerRemap[corner[v]];
+            if (to == corner[v])
+                continue;
+
+            const std::vector<uint32_t>& candidates = cornerVertices[to];
+            uint32_t best = candidates.front();
+            if (normalOffset >= 0) {
+                float bestDot = -2.0f;
+                for (uint32_t candidate : candidates) {
+                    const float d = glm::dot(normal(v), normal(candidate));
+                    if (d > bestDot) {
+                        bestDot = d;
+                        best = candidate;
+                    }
+                }
+            }
+            vertexRemap[v] = best;
+        }
+
+        size_t write = 0;
+        for (size_t i = 0; i + 2 < tris.size(); i += 3) {
+            const uint32_t a = vertexRemap[tris[i]];
+            const uint32_t b = vertexRemap[tris[i + 1]];
+            const uint32_t c = vertexRemap[tris[i + 2]];
+            if (corner[a] == corner[b] || corner[b] == corner[c] || corner[a] == corner[c])
+                continue;
+            tris[write++] = a;
+            tris[write++] = b;
+            tris[write++] = c;
+        }
+        tris.resize(write);
+    }
+
+    return result;
+}
+
+void MeshSimplifier::CompactVertices(std::vector<float>& vertices, uint32_t floatsPerVertex,
+                                     std::vector<uint32_t>& indices) {
+    MeshOptimizer::OptimizeVertexFetch(vertices, floatsPerVertex, indices);
+}
+
+} // namespace se